@@ -1,8 +1,15 @@
 #include "array.h"
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+
+// Defined by linux/mman.h : huge pages of 2^21 bytes (ARRAY_HUGE_PAGE_SIZE)
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
 
 bool is_valid_array(const p_array arr)
 {
@@ -11,51 +18,310 @@ bool is_valid_array(const p_array arr)
         return false;
     }
     if (arr->data == NULL) {
-        fprintf(stderr, "The data member of the array %s is null! (NULL pointer)\n", arr->label);
+        fprintf(stderr, "The data member of the array %s is null! (NULL pointer)\n", get_array_label(arr));
         return false;
     }
     if (arr->size == 0) {
-        fprintf(stderr, "The size of the array %s is nill!\n", arr->label);
+        fprintf(stderr, "The size of the array %s is nill!\n", get_array_label(arr));
         return false;
     }
     return true;
 }
 
-p_array build_array(const unsigned int size, const char *label)
+/**
+ * @brief Header in front of the memory given by allocate_array_memory. It takes ARRAY_ALIGNMENT bytes,
+ *        so that the memory following it stays aligned.
+ *
+ */
+typedef struct ArrayMemoryHeader
 {
-    // Checks correctness of arguments
-    if (strlen(label) >= MAX_LABEL_SIZE)
+    size_t mapped_size;  /**< Size of the mapping of reserved huge pages holding the memory, 0 if it comes from the heap */
+} ArrayMemoryHeader_s;
+
+static const char *const ARRAY_HUGE_PAGES_NAMES[] = {"off", "transparent", "reserved"};
+
+/**
+ * @brief Value of chosen_huge_pages until the pages are chosen
+ *
+ */
+#define ARRAY_HUGE_PAGES_NOT_CHOSEN -1
+
+/**
+ * @brief Pages backing the large arrays, read from the environment at the first allocation unless set before.
+ *        Atomic as the first allocations may be made by several threads at once
+ *
+ */
+static atomic_int chosen_huge_pages = ARRAY_HUGE_PAGES_NOT_CHOSEN;
+
+ArrayHugePages_e get_array_huge_pages(void)
+{
+    const int chosen = atomic_load_explicit(&chosen_huge_pages, memory_order_relaxed);
+    if (chosen != ARRAY_HUGE_PAGES_NOT_CHOSEN)
+        return (ArrayHugePages_e)chosen;
+
+    int requested_pages = ARRAY_NO_HUGE_PAGES;
+    const char *requested = getenv(ARRAY_HUGE_PAGES_ENV_VAR);
+    if (requested != NULL)
     {
-        fprintf(stderr, "An error has occured when building the array %s\n", label);
-        fprintf(stderr, "The label size is above the limit : %d!\n", MAX_LABEL_SIZE);
-        return NULL;
+        bool known = false;
+        for (int i = ARRAY_NO_HUGE_PAGES; i <= ARRAY_RESERVED_HUGE_PAGES; ++i)
+        {
+            if (strcmp(requested, ARRAY_HUGE_PAGES_NAMES[i]) == 0)
+            {
+                known = true;
+                requested_pages = i;
+            }
+        }
+        if (!known)
+        {
+            fprintf(stderr, "Unknown value for %s : %s (ignored)!\n", ARRAY_HUGE_PAGES_ENV_VAR, requested);
+        }
     }
-    if (size > MAX_ARRAY_SIZE)
+    // The first thread to choose wins, and the pages set meanwhile by set_array_huge_pages are kept
+    int expected = ARRAY_HUGE_PAGES_NOT_CHOSEN;
+    if (!atomic_compare_exchange_strong_explicit(&chosen_huge_pages, &expected, requested_pages, memory_order_relaxed,
+                                                 memory_order_relaxed))
+        return (ArrayHugePages_e)expected;
+    return (ArrayHugePages_e)requested_pages;
+}
+
+void set_array_huge_pages(const ArrayHugePages_e huge_pages)
+{
+    atomic_store_explicit(&chosen_huge_pages, (int)huge_pages, memory_order_relaxed);
+}
+
+const char *get_array_huge_pages_name(const ArrayHugePages_e huge_pages)
+{
+    return ARRAY_HUGE_PAGES_NAMES[huge_pages];
+}
+
+/**
+ * @brief Round the number of bytes up to a multiple of ARRAY_HUGE_PAGE_SIZE
+ *
+ * @param[in] nb_bytes : number of bytes
+ * @return size_t : the rounded number of bytes
+ */
+static size_t round_to_huge_pages(const size_t nb_bytes)
+{
+    return (nb_bytes + ARRAY_HUGE_PAGE_SIZE - 1) / ARRAY_HUGE_PAGE_SIZE * ARRAY_HUGE_PAGE_SIZE;
+}
+
+void *allocate_array_memory(const size_t nb_bytes)
+{
+    const size_t total_size = ARRAY_ALIGNMENT + nb_bytes;
+    // A smaller allocation would waste most of its huge page
+    const ArrayHugePages_e huge_pages = total_size >= ARRAY_HUGE_PAGE_SIZE ? get_array_huge_pages() :
+                                        ARRAY_NO_HUGE_PAGES;
+    char *memory = NULL;
+    size_t mapped_size = 0;
+    if (huge_pages == ARRAY_RESERVED_HUGE_PAGES)
     {
-        fprintf(stderr, "An error has occured when building the array %s\n", label);
-        fprintf(stderr, "The size of array (%u) is above the limit : %d!\n", size, MAX_ARRAY_SIZE);
-        return NULL;
+        mapped_size = round_to_huge_pages(total_size);
+        // The size of the pages is given : the default one of the system may be 1 GiB
+        memory = (char *)mmap(NULL, mapped_size, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+        // No reserved huge page left : the transparent ones are used
+        if (memory == MAP_FAILED)
+        {
+            memory = NULL;
+            mapped_size = 0;
+        }
+    }
+    if (memory == NULL)
+    {
+        // The whole huge pages, so that none of them is shared with another allocation
+        const size_t size = huge_pages == ARRAY_NO_HUGE_PAGES ? total_size : round_to_huge_pages(total_size);
+        const size_t alignment = huge_pages == ARRAY_NO_HUGE_PAGES ? ARRAY_ALIGNMENT : ARRAY_HUGE_PAGE_SIZE;
+        if (posix_memalign((void **)&memory, alignment, size) != 0)
+            return NULL;
+        // Only a hint : a kernel without transparent huge pages rejects it
+        if (huge_pages != ARRAY_NO_HUGE_PAGES)
+            madvise(memory, size, MADV_HUGEPAGE);
     }
+    ((ArrayMemoryHeader_s *)memory)->mapped_size = mapped_size;
+    return memory + ARRAY_ALIGNMENT;
+}
+
+void free_array_data(void *data)
+{
+    if (data == NULL)
+        return;
+    char *memory = (char *)data - ARRAY_ALIGNMENT;
+    const size_t mapped_size = ((const ArrayMemoryHeader_s *)memory)->mapped_size;
+    if (mapped_size > 0)
+        munmap(memory, mapped_size);
+    else
+        free(memory);
+}
+
+/**
+ * @brief Allocate an aligned and padded buffer, which values are zeroed or not
+ *
+ * @param[in] size : number of values
+ * @param[in] zeroed : every value is zeroed if true, only the padding otherwise
+ * @return double* : the buffer in case of success, NULL otherwise
+ */
+static double *allocate_aligned_data(const size_t size, const bool zeroed)
+{
+    // At least one vector, so that an empty array still has a valid pointer
+    const size_t padded_size = size == 0 ? ARRAY_PADDING_SIZE :
+                               (size + ARRAY_PADDING_SIZE - 1) / ARRAY_PADDING_SIZE * ARRAY_PADDING_SIZE;
+    double *data = (double *)allocate_array_memory(padded_size * sizeof(double));
+    if (data == NULL)
+        return NULL;
+    const size_t first_zeroed = zeroed ? 0 : size;
+    memset(data + first_zeroed, 0, (padded_size - first_zeroed) * sizeof(double));
+    return data;
+}
 
-    // Allocate memory for the array structure
-    p_array arr_ptr = (p_array)malloc(sizeof(s_array));
+double *allocate_array_data(const size_t size)
+{
+    return allocate_aligned_data(size, true);
+}
+
+/**
+ * @brief Build an array, which data is zeroed or not
+ *
+ * @param[in] size : size of the array
+ * @param[in] label : label of the array
+ * @param[in] zeroed : every value of the data is zeroed if true, only its padding otherwise
+ * @return p_array : pointer on the newly created array in case of success, NULL otherwise
+ */
+static p_array allocate_array(const size_t size, const char *label, const bool zeroed)
+{
+    if (!are_valid_array_arguments(size, label))
+        return NULL;
+
+    // Allocate memory for the array structure, followed by its label
+    const size_t label_size = label ? strlen(label) + 1 : 0;
+    p_array arr_ptr = (p_array)malloc(sizeof(s_array) + label_size);
+    if (arr_ptr == NULL)
+    {
+        fprintf(stderr, "An error has occured when building the array %s\n", label ? label : "unnamed");
+        fprintf(stderr, "The allocation has failed!\n");
+        return NULL;
+    }
 
     // Fill the array structure
-    arr_ptr->data = (double *)calloc(size, sizeof(double));
+    arr_ptr->data = allocate_aligned_data(size, zeroed);
 
     if (arr_ptr->data == NULL)
     {
-        fprintf(stderr, "An error has occured when building the array %s\n", label);
+        fprintf(stderr, "An error has occured when building the array %s\n", label ? label : "unnamed");
         fprintf(stderr, "The allocation has failed!\n");
         free(arr_ptr);
         return NULL;
     }
 
-    strcpy(arr_ptr->label, label);
+    arr_ptr->label = label ? memcpy(arr_ptr + 1, label, label_size) : NULL;
     arr_ptr->size = size;
     return arr_ptr;
 };
 
+bool are_valid_array_arguments(const size_t size, const char *label)
+{
+    if (label && strlen(label) >= MAX_LABEL_SIZE)
+    {
+        fprintf(stderr, "An error has occured when building the array %s\n", label);
+        fprintf(stderr, "The label size is above the limit : %d!\n", MAX_LABEL_SIZE);
+        return false;
+    }
+    if (size > MAX_ARRAY_SIZE)
+    {
+        fprintf(stderr, "An error has occured when building the array %s\n", label ? label : "unnamed");
+        fprintf(stderr, "The size of array (%zu) is above the limit : %zu!\n", size, MAX_ARRAY_SIZE);
+        return false;
+    }
+    return true;
+}
+
+p_array build_array(const size_t size, const char *label)
+{
+    return allocate_array(size, label, true);
+}
+
+p_array build_array_untouched(const size_t size, const char *label)
+{
+    return allocate_array(size, label, false);
+}
+
+s_array get_sub_array(const s_array *arr, const size_t first, const size_t size)
+{
+    if (first > arr->size || size > arr->size - first)
+    {
+        fprintf(stderr, "The range [%zu, %zu[ is not inside the array %s of size %zu!\n", first, first + size,
+                get_array_label(arr), arr->size);
+        return wrap_array(NULL, 0, arr->label);
+    }
+    return wrap_array(arr->data + first, size, arr->label);
+}
+
+s_array_view get_array_view(const s_array *arr)
+{
+    const s_array_view view = {arr->size, 1, arr->label, arr->data};
+    return view;
+}
+
+s_array_view get_strided_view(const s_array *arr, const size_t first, const size_t size, const ptrdiff_t stride)
+{
+    s_array_view view = {0, stride, arr->label, NULL};
+    // The last value of the view, first + (size - 1) * stride, should be inside the array as the first one
+    const size_t span = size == 0 ? 0 : (size - 1) * (size_t)(stride < 0 ? -stride : stride);
+    const bool is_inside = stride != 0 && first < arr->size &&
+                           (stride > 0 ? span < arr->size - first : span <= first);
+    if (!is_inside)
+    {
+        fprintf(stderr, "The view of %zu values of stride %td from %zu is not inside the array %s of size %zu!\n",
+                size, stride, first, get_array_label(arr), arr->size);
+        return view;
+    }
+    view.size = size;
+    view.data = arr->data + first;
+    return view;
+}
+
+/**
+ * @brief Check that the view and the array hold values and have the same size
+ *
+ * @param[in] view : the view
+ * @param[in] arr : the array
+ * @return int EXIT_SUCCESS (0) : in case of success
+               EXIT_FAILURE (1) : otherwise
+ */
+static int check_view_and_array(const s_array_view *view, const s_array *arr)
+{
+    if (view->data == NULL || !is_valid_array((const p_array)arr))
+    {
+        fprintf(stderr, "The view or the array is not valid!\n");
+        return EXIT_FAILURE;
+    }
+    if (view->size != arr->size)
+    {
+        fprintf(stderr, "The size of the view %s (%zu) and of the array %s (%zu) mismatch!\n",
+                view->label ? view->label : "unnamed", view->size, get_array_label(arr), arr->size);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int gather_array_view(const s_array_view *view, p_array dest)
+{
+    if (check_view_and_array(view, dest) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    for (size_t i = 0; i < view->size; ++i)
+        dest->data[i] = view->data[(ptrdiff_t)i * view->stride];
+    return EXIT_SUCCESS;
+}
+
+int scatter_array_view(const s_array *origin, const s_array_view *view)
+{
+    if (check_view_and_array(view, origin) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    for (size_t i = 0; i < origin->size; ++i)
+        view->data[(ptrdiff_t)i * view->stride] = origin->data[i];
+    return EXIT_SUCCESS;
+}
+
 int print_array(const p_array arr)
 {
     if (!arr)
@@ -66,18 +332,18 @@ int print_array(const p_array arr)
 
     if (arr->size == 0)
     {
-        printf("%s[] = empty\n", arr->label);
+        printf("%s[] = empty\n", get_array_label(arr));
     }
 
-    unsigned int chunk_size = PRINT_ARRAY_CHUNK_SIZE;
-    for (unsigned int i = 0; i < arr->size; ++i)
+    size_t chunk_size = PRINT_ARRAY_CHUNK_SIZE;
+    for (size_t i = 0; i < arr->size; ++i)
     {
         if ((i == chunk_size) && (arr->size > chunk_size * 2))
         {
             i = arr->size - chunk_size;
             printf("...\n");
         }
-        int ret = printf("%s[%d] = %15.9g\n", arr->label, i, *(arr->data + i));
+        int ret = printf("%s[%zu] = %15.9g\n", get_array_label(arr), i, *(arr->data + i));
         if (ret < 0)
         {
             perror("An error occured during the print of the array!");
@@ -93,7 +359,7 @@ int fill_array(const p_array arr, const double value)
         fprintf(stderr, "The array is not valid!\n");
         return EXIT_FAILURE;
     }
-    for (unsigned int i = 0; i < arr->size; ++i)
+    for (size_t i = 0; i < arr->size; ++i)
         arr->data[i] = value;
     return EXIT_SUCCESS;
 }
@@ -102,10 +368,10 @@ void clear_array(const p_array arr)
 {
     if (arr)
     {
-        free(arr->data);
+        free_array_data(arr->data);
         arr->data = NULL;
         arr->size = 0;
-        strcpy(arr->label, "");
+        arr->label = "";
     }
 }
 
@@ -123,8 +389,8 @@ int copy_array(const p_array origin, p_array dest)
     }
     if (origin->size != dest->size) {
         fprintf(stderr, "The sizes of the arrays mismatch!\n");
-        fprintf(stderr, "Size of origin array (%s) is (%u)\n", origin->label, origin->size);
-        fprintf(stderr, "Size of destination array (%s) is (%u)\n", dest->label, dest->size);
+        fprintf(stderr, "Size of origin array (%s) is (%zu)\n", get_array_label(origin), origin->size);
+        fprintf(stderr, "Size of destination array (%s) is (%zu)\n", get_array_label(dest), dest->size);
         return EXIT_FAILURE;
     }
     memcpy(dest->data, origin->data, origin->size * sizeof(double));
@@ -11,6 +11,8 @@
 #ifndef ARRAY_H
 #define ARRAY_H
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief Maximum size of the string describing the array
@@ -18,16 +20,54 @@
  */
 #define MAX_LABEL_SIZE 128
 /**
- * @brief Maximum size of the array
+ * @brief Maximum size of the array (sizes are 64 bits wide : the arrays may hold more than 4G values)
  * 
  */
-#define MAX_ARRAY_SIZE 1000000000
+#define MAX_ARRAY_SIZE ((size_t)1000000000000)
 /**
  * @brief Any array with a size above 2 times this size will not be
  *        printed entirely. Only the beginning and the end will be printed.
  * 
  */
 #define PRINT_ARRAY_CHUNK_SIZE 10
+/**
+ * @brief Alignment, in bytes, of the data of the arrays built by build_array (a cache line,
+ *        and the width of the widest vectors)
+ * 
+ */
+#define ARRAY_ALIGNMENT 64
+/**
+ * @brief The data of the arrays built by build_array is padded to a multiple of this number of values
+ *        (a full vector of the widest width), the padding being zeroed
+ * 
+ */
+#define ARRAY_PADDING_SIZE (ARRAY_ALIGNMENT / sizeof(double))
+
+/**
+ * @brief Size of the huge pages. Only the allocations of at least this size are backed by huge pages.
+ * 
+ */
+#define ARRAY_HUGE_PAGE_SIZE ((size_t)2 << 20)
+/**
+ * @brief Name of the environment variable that may be used to back the large arrays by huge pages
+ *        (values : off, transparent, reserved)
+ * 
+ */
+#define ARRAY_HUGE_PAGES_ENV_VAR "NONLINEAR_SOLVER_HUGE_PAGES"
+
+/**
+ * @brief Tells the compiler that the pointer is aligned on ARRAY_ALIGNMENT bytes.
+ *        Only use it on a pointer for which is_aligned_data is true.
+ * 
+ */
+#define ARRAY_ASSUME_ALIGNED(ptr) ((double *)__builtin_assume_aligned((ptr), ARRAY_ALIGNMENT))
+
+/**
+ * @brief Data of the array, seen as aligned on ARRAY_ALIGNMENT bytes.
+ *        Only use it on an array for which is_aligned_array is true.
+ * 
+ */
+#define ARRAY_ALIGNED_DATA(arr) ARRAY_ASSUME_ALIGNED((arr)->data)
 
 /**
  * @brief This MACRO creates an array which name is the same as the pointer pointing to it.
@@ -45,27 +85,240 @@
     free(arr_ptr);
 
 /**
- * @brief Defines an array object
+ * @brief Pages backing the memory of the large arrays (at least ARRAY_HUGE_PAGE_SIZE bytes). With huge pages,
+ *        a page table entry (and a TLB entry) covers ARRAY_HUGE_PAGE_SIZE bytes instead of 4 KiB.
+ * 
+ */
+typedef enum ArrayHugePages
+{
+    ARRAY_NO_HUGE_PAGES,  /**< Pages of the system (default) */
+    ARRAY_TRANSPARENT_HUGE_PAGES,  /**< The memory is advised to be backed by huge pages (madvise(MADV_HUGEPAGE)) :
+                                        the kernel uses them if it has free ones and its transparent huge pages
+                                        are enabled (madvise or always) */
+    ARRAY_RESERVED_HUGE_PAGES  /**< The memory is taken from the huge pages reserved by the administrator
+                                    (mmap(MAP_HUGETLB), see /proc/sys/vm/nr_hugepages), the transparent ones
+                                    being used if none is left */
+} ArrayHugePages_e;
+
+/**
+ * @brief Defines an array object.
+ *        It is also a view on contiguous values it does not own : a slice of another array
+ *        (see get_sub_array) or a buffer allocated elsewhere (see wrap_array), that is never deleted.
  * 
  */
 typedef struct array
 {
-    unsigned int size;  /**< Number of cells in the array */
-    char label[128];  /**< A small string naming of describing the array */
+    size_t size;  /**< Number of cells in the array */
+    const char *label;  /**< A small string naming of describing the array (may be NULL) */
     double *data;  /**< The underlying array */
 } s_array, *p_array;
 
+/**
+ * @brief Defines a view on values spaced by a constant stride, e.g. one component of an array of structures
+ *        or every other cell of an array. The modules take arrays : the values of a view are gathered into
+ *        an array (gather_array_view) and the results scattered back (scatter_array_view).
+ * 
+ */
+typedef struct array_view
+{
+    size_t size;  /**< Number of values of the view */
+    ptrdiff_t stride;  /**< Distance, in values, between two consecutive values of the view */
+    const char *label;  /**< A small string naming of describing the view (may be NULL) */
+    double *data;  /**< The first value of the view */
+} s_array_view;
+
+/**
+ * @brief Return the label of the array, or "unnamed" if it has none
+ * 
+ * @param[in] arr : the array (not NULL)
+ * @return const char* : the label
+ */
+static inline const char *get_array_label(const s_array *arr)
+{
+    return arr->label ? arr->label : "unnamed";
+}
+
+/**
+ * @brief Wrap values allocated elsewhere in an array, that does not own them
+ * 
+ * @param[in] data : the values
+ * @param[in] size : number of values
+ * @param[in] label : label of the array (may be NULL), not copied
+ * @return s_array : the array
+ */
+static inline s_array wrap_array(double *data, const size_t size, const char *label)
+{
+    const s_array arr = {size, label, data};
+    return arr;
+}
+
+/**
+ * @brief Return the array of the values [first, first + size[ of arr, that does not own them.
+ *        It costs no allocation : the threads may cut their chunk of an array this way.
+ * 
+ * @param[in] arr : the array
+ * @param[in] first : index of the first value
+ * @param[in] size : number of values
+ * @return s_array : the sub array, or an array without data (see is_valid_array) if the range
+ *                   is not inside arr
+ */
+s_array get_sub_array(const s_array *arr, const size_t first, const size_t size);
+
+/**
+ * @brief Return the view on every value of the array
+ * 
+ * @param[in] arr : the array
+ * @return s_array_view : the view, of stride 1
+ */
+s_array_view get_array_view(const s_array *arr);
+
+/**
+ * @brief Return the view on size values of arr, starting at first and spaced by stride values
+ * 
+ * @param[in] arr : the array
+ * @param[in] first : index of the first value
+ * @param[in] size : number of values
+ * @param[in] stride : distance, in values, between two values (not null, may be negative)
+ * @return s_array_view : the view, or a view without data if its values are not inside arr
+ */
+s_array_view get_strided_view(const s_array *arr, const size_t first, const size_t size, const ptrdiff_t stride);
+
+/**
+ * @brief Copy the values of the view into the array
+ * 
+ * @param[in] view : the view
+ * @param[out] dest : array of the same size as the view
+ * @return int EXIT_SUCCESS (0) : in case of success
+               EXIT_FAILURE (1) : otherwise
+ */
+int gather_array_view(const s_array_view *view, p_array dest);
+
+/**
+ * @brief Copy the values of the array into the view
+ * 
+ * @param[in] origin : array of the same size as the view
+ * @param[out] view : the view
+ * @return int EXIT_SUCCESS (0) : in case of success
+               EXIT_FAILURE (1) : otherwise
+ */
+int scatter_array_view(const s_array *origin, const s_array_view *view);
+
+/**
+ * @brief Check if the pointer is aligned on ARRAY_ALIGNMENT bytes.
+ *        The data of the arrays built by build_array is, but not the one of an array wrapping
+ *        a slice of another one or a buffer allocated elsewhere : the kernels check it before
+ *        taking their aligned path.
+ * 
+ * @param[in] ptr : the pointer
+ * @return true : if the pointer is aligned
+ * @return false : otherwise
+ */
+static inline bool is_aligned_data(const void *ptr)
+{
+    return (uintptr_t)ptr % ARRAY_ALIGNMENT == 0;
+}
+
+/**
+ * @brief Check if the data of the array is aligned on ARRAY_ALIGNMENT bytes
+ * 
+ * @param[in] arr : the array (not NULL)
+ * @return true : if its data is aligned
+ * @return false : otherwise
+ */
+static inline bool is_aligned_array(const s_array *arr)
+{
+    return is_aligned_data(arr->data);
+}
+
+/**
+ * @brief Allocate a buffer of size values aligned on ARRAY_ALIGNMENT bytes and padded to a multiple
+ *        of ARRAY_PADDING_SIZE values, every value (padding included) being zeroed.
+ *        It is backed by huge pages as the memory of allocate_array_memory.
+ *        The buffer should be released by free_array_data.
+ * 
+ * @param[in] size : number of values
+ * @return double* : the buffer in case of success, NULL otherwise
+ */
+double *allocate_array_data(const size_t size);
+
+/**
+ * @brief Allocate nb_bytes of memory aligned on ARRAY_ALIGNMENT bytes, not initialized,
+ *        backed by huge pages if it is large enough and they are enabled (see get_array_huge_pages).
+ *        The memory should be released by free_array_data.
+ * 
+ * @param[in] nb_bytes : number of bytes
+ * @return void* : the memory in case of success, NULL otherwise
+ */
+void *allocate_array_memory(const size_t nb_bytes);
+
+/**
+ * @brief Release the memory given by allocate_array_memory or allocate_array_data
+ * 
+ * @param[in] data : the memory (may be NULL)
+ */
+void free_array_data(void *data);
+
+/**
+ * @brief Return the pages backing the memory of the large arrays : the ones given to set_array_huge_pages
+ *        or, if it has not been called, the ones given by the ARRAY_HUGE_PAGES_ENV_VAR environment variable
+ *        if it is set (ARRAY_NO_HUGE_PAGES otherwise). It may be called by several threads at once.
+ * 
+ * @return ArrayHugePages_e : the pages
+ */
+ArrayHugePages_e get_array_huge_pages(void);
+
+/**
+ * @brief Choose the pages backing the memory of the large arrays allocated from now on.
+ *        The arrays allocated by other threads meanwhile may be backed by the previous pages.
+ * 
+ * @param[in] huge_pages : the pages
+ */
+void set_array_huge_pages(const ArrayHugePages_e huge_pages);
+
+/**
+ * @brief Return the name of the pages, as given to the ARRAY_HUGE_PAGES_ENV_VAR environment variable
+ * 
+ * @param[in] huge_pages : the pages
+ * @return const char* : its name
+ */
+const char *get_array_huge_pages_name(const ArrayHugePages_e huge_pages);
+
+/**
+ * @brief Check the arguments of the functions building an array : the label (if any) should be shorter
+ *        than MAX_LABEL_SIZE and the size at most MAX_ARRAY_SIZE
+ * 
+ * @param[in] size : size of the array
+ * @param[in] label : label of the array (may be NULL)
+ * @return true : if the arguments are valid
+ * @return false : otherwise (the reason is printed)
+ */
+bool are_valid_array_arguments(const size_t size, const char *label);
+
 /**
  * @brief Build an array and returns a pointer to it.
+ *        Its data is aligned on ARRAY_ALIGNMENT bytes and padded to a multiple of ARRAY_PADDING_SIZE
+ *        values, the padding being zeroed. Its label is copied after its header, in the same allocation.
  *        Once used, the array should be cleared thanks to the function
  *        clear_array and the memory released by freeing the pointer.
  *        For an easy way of deleting an array please use the macro DELETE_ARRAY.
  * 
  * @param[in] size : size of the array
- * @param[in] label : label of the array
+ * @param[in] label : label of the array (may be NULL)
+ * @return p_array : pointer on the newly created array in case of success, NULL otherwise
+ */
+p_array build_array(const size_t size, const char *label);
+
+/**
+ * @brief Same as build_array but the values are not initialized (only the padding is) : the memory pages of a large array
+ *        are only mapped when they are first written, on the NUMA node of the thread writing them.
+ *        The caller should write every value (e.g in parallel, with the partition of the threads
+ *        that will use the array) before reading them.
+ * 
+ * @param[in] size : size of the array
+ * @param[in] label : label of the array (may be NULL)
  * @return p_array : pointer on the newly created array in case of success, NULL otherwise
  */
-p_array build_array(const unsigned int size, const char *label);
+p_array build_array_untouched(const size_t size, const char *label);
 
 /**
  * @brief Clear the array by freeing the data memory, setting the size to zero 
@@ -0,0 +1,123 @@
+#include "array_arena.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ArrayArena
+{
+    char *region;  /**< The memory of the arrays, aligned on ARRAY_ALIGNMENT bytes */
+    size_t capacity;  /**< Size of the region in bytes */
+    atomic_size_t used;  /**< Offset of the first free byte of the region */
+};
+
+/**
+ * @brief Round the number of bytes up to a multiple of ARRAY_ALIGNMENT
+ *
+ * @param[in] nb_bytes : number of bytes
+ * @return size_t : the rounded number of bytes
+ */
+static size_t round_to_alignment(const size_t nb_bytes)
+{
+    return (nb_bytes + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+}
+
+ArrayArena_s *build_array_arena(const size_t capacity)
+{
+    if (capacity == 0)
+    {
+        fprintf(stderr, "Unable to build an arena of 0 bytes!\n");
+        return NULL;
+    }
+    ArrayArena_s *arena = (ArrayArena_s *)malloc(sizeof(ArrayArena_s));
+    if (arena == NULL)
+    {
+        fprintf(stderr, "The allocation of the arena has failed!\n");
+        return NULL;
+    }
+    arena->capacity = round_to_alignment(capacity);
+    // Not zeroed here : each array zeroes its own part of the region when it is built
+    arena->region = (char *)allocate_array_memory(arena->capacity);
+    if (arena->region == NULL)
+    {
+        fprintf(stderr, "The allocation of the region of the arena has failed (size requested : %zu bytes)!\n",
+                arena->capacity);
+        free(arena);
+        return NULL;
+    }
+    atomic_init(&arena->used, 0);
+    return arena;
+}
+
+/**
+ * @brief Number of bytes of the header of an array built in an arena : the array structure and room for its label
+ *
+ * @return size_t : the number of bytes, a multiple of ARRAY_ALIGNMENT
+ */
+static size_t get_header_footprint(void)
+{
+    return round_to_alignment(sizeof(s_array) + MAX_LABEL_SIZE);
+}
+
+size_t get_array_arena_footprint(const size_t size)
+{
+    const size_t padded_size = size == 0 ? ARRAY_PADDING_SIZE :
+                               (size + ARRAY_PADDING_SIZE - 1) / ARRAY_PADDING_SIZE * ARRAY_PADDING_SIZE;
+    return get_header_footprint() + padded_size * sizeof(double);
+}
+
+void *allocate_in_array_arena(ArrayArena_s *arena, const size_t nb_bytes)
+{
+    const size_t taken = round_to_alignment(nb_bytes);
+    size_t first = atomic_load_explicit(&arena->used, memory_order_relaxed);
+    do
+    {
+        if (taken > arena->capacity - first)
+        {
+            fprintf(stderr, "The arena is full : %zu bytes requested, %zu bytes left!\n", taken,
+                    arena->capacity - first);
+            return NULL;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&arena->used, &first, first + taken, memory_order_relaxed,
+                                                    memory_order_relaxed));
+    memset(arena->region + first, 0, taken);
+    return arena->region + first;
+}
+
+p_array build_array_in_arena(ArrayArena_s *arena, const size_t size, const char *label)
+{
+    if (!are_valid_array_arguments(size, label))
+        return NULL;
+
+    // The header, its label then the data, in one piece of the region
+    char *memory = (char *)allocate_in_array_arena(arena, get_array_arena_footprint(size));
+    if (memory == NULL)
+    {
+        fprintf(stderr, "An error has occured when building the array %s in the arena\n", label ? label : "unnamed");
+        return NULL;
+    }
+    p_array arr_ptr = (p_array)memory;
+    arr_ptr->data = (double *)(memory + get_header_footprint());
+    arr_ptr->label = label ? strcpy((char *)(arr_ptr + 1), label) : NULL;
+    arr_ptr->size = size;
+    return arr_ptr;
+}
+
+void reset_array_arena(ArrayArena_s *arena)
+{
+    atomic_store_explicit(&arena->used, 0, memory_order_relaxed);
+}
+
+size_t get_array_arena_used(const ArrayArena_s *arena)
+{
+    return atomic_load_explicit(&arena->used, memory_order_relaxed);
+}
+
+void delete_array_arena(ArrayArena_s *arena)
+{
+    if (arena)
+    {
+        free_array_data(arena->region);
+        free(arena);
+    }
+}
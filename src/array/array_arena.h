@@ -0,0 +1,98 @@
+/**
+ * @file array_arena.h
+ * @author guillaume.peillex@gmail.com
+ * @brief Arena holding the header and the data of arrays in a single region, released at once
+ * @version 1.0.0
+ * @date 2020-04-30
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Building an array in an arena only moves the offset of the first free byte of its region : there
+ * is no call to the allocator, thus no lock shared by the threads and no fragmentation.
+ * The arrays of an arena are not deleted one by one but all together, when the arena is reset
+ * (its region being reused by the next arrays) or deleted.
+ */
+#ifndef ARRAY_ARENA_H
+#define ARRAY_ARENA_H
+#include <stddef.h>
+#include "array.h"
+
+/**
+ * @brief This MACRO creates an array in the arena which name is the same as the pointer pointing to it.
+ *
+ */
+#define BUILD_ARRAY_IN_ARENA(arena, name, size) p_array name = build_array_in_arena(arena, size, #name);
+
+/**
+ * @brief An arena of arrays
+ *
+ */
+typedef struct ArrayArena ArrayArena_s;
+
+/**
+ * @brief Build an arena which region holds capacity bytes (rounded up to a multiple of ARRAY_ALIGNMENT).
+ *        The pages of the region are only mapped when the arrays built in it are.
+ *        Once used, the arena should be deleted thanks to delete_array_arena.
+ *
+ * @param[in] capacity : size of the region in bytes (see get_array_arena_footprint)
+ * @return ArrayArena_s* : pointer on the newly created arena in case of success, NULL otherwise
+ */
+ArrayArena_s *build_array_arena(const size_t capacity);
+
+/**
+ * @brief Return the number of bytes of the region of an arena taken by an array of size values
+ *        (its header, its label and its aligned and padded data)
+ *
+ * @param[in] size : size of the array
+ * @return size_t : the number of bytes
+ */
+size_t get_array_arena_footprint(const size_t size);
+
+/**
+ * @brief Take nb_bytes (rounded up to a multiple of ARRAY_ALIGNMENT) from the region of the arena.
+ *        The memory is aligned on ARRAY_ALIGNMENT bytes and zeroed.
+ *        Several threads may take memory from the same arena at the same time.
+ *
+ * @param[in] arena : the arena
+ * @param[in] nb_bytes : number of bytes
+ * @return void* : the memory in case of success, NULL if the region has not enough free bytes left
+ */
+void *allocate_in_array_arena(ArrayArena_s *arena, const size_t nb_bytes);
+
+/**
+ * @brief Build an array, which header and data are taken from the region of the arena.
+ *        Its data is aligned, padded and zeroed as the one of build_array.
+ *        The array should not be deleted by DELETE_ARRAY : it lives until the arena is reset or deleted.
+ *        Several threads may build arrays in the same arena at the same time.
+ *
+ * @param[in] arena : the arena
+ * @param[in] size : size of the array
+ * @param[in] label : label of the array (may be NULL), copied in the region
+ * @return p_array : pointer on the newly created array in case of success, NULL otherwise
+ */
+p_array build_array_in_arena(ArrayArena_s *arena, const size_t size, const char *label);
+
+/**
+ * @brief Give the whole region of the arena back to the next arrays built in it.
+ *        The arrays built before should not be used anymore. No array should be being built at the same time.
+ *
+ * @param[in] arena : the arena
+ */
+void reset_array_arena(ArrayArena_s *arena);
+
+/**
+ * @brief Return the number of bytes of the region of the arena taken since it was built or reset
+ *
+ * @param[in] arena : the arena
+ * @return size_t : the number of bytes
+ */
+size_t get_array_arena_used(const ArrayArena_s *arena);
+
+/**
+ * @brief Release the region of the arena, with every array built in it, and the arena itself
+ *
+ * @param[in] arena : arena to delete (may be NULL)
+ */
+void delete_array_arena(ArrayArena_s *arena);
+
+#endif
@@ -0,0 +1,117 @@
+#include "array_float.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Check that the two arrays of a copy or a conversion have the same size
+ *
+ * @param[in] origin_size : size of the origin array
+ * @param[in] dest_size : size of the destination array
+ * @return int EXIT_SUCCESS (0) : if the sizes match
+               EXIT_FAILURE (1) : otherwise
+ */
+static int check_sizes(const size_t origin_size, const size_t dest_size)
+{
+    if (origin_size != dest_size)
+    {
+        fprintf(stderr, "The sizes of the arrays mismatch (%zu and %zu)!\n", origin_size, dest_size);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+bool is_valid_array_f(const p_array_f arr)
+{
+    if (arr == NULL) {
+        fprintf(stderr, "The array has not been created! (NULL pointer)\n");
+        return false;
+    }
+    if (arr->data == NULL) {
+        fprintf(stderr, "The data member of the array %s is null! (NULL pointer)\n",
+                arr->label ? arr->label : "unnamed");
+        return false;
+    }
+    if (arr->size == 0) {
+        fprintf(stderr, "The size of the array %s is nill!\n", arr->label ? arr->label : "unnamed");
+        return false;
+    }
+    return true;
+}
+
+p_array_f build_array_f(const size_t size, const char *label)
+{
+    if (!are_valid_array_arguments(size, label))
+        return NULL;
+
+    // The label is copied after the array structure
+    const size_t label_size = label ? strlen(label) + 1 : 0;
+    p_array_f arr_ptr = (p_array_f)malloc(sizeof(s_array_f) + label_size);
+    if (arr_ptr == NULL)
+    {
+        fprintf(stderr, "An error has occured when building the array %s\n", label ? label : "unnamed");
+        fprintf(stderr, "The allocation has failed!\n");
+        return NULL;
+    }
+    arr_ptr->data = (float *)calloc(size, sizeof(float));
+    if (arr_ptr->data == NULL)
+    {
+        fprintf(stderr, "An error has occured when building the array %s\n", label ? label : "unnamed");
+        fprintf(stderr, "The allocation has failed!\n");
+        free(arr_ptr);
+        return NULL;
+    }
+
+    arr_ptr->label = label ? memcpy(arr_ptr + 1, label, label_size) : NULL;
+    arr_ptr->size = size;
+    return arr_ptr;
+}
+
+void clear_array_f(const p_array_f arr)
+{
+    if (arr)
+    {
+        free(arr->data);
+        arr->data = NULL;
+        arr->size = 0;
+        arr->label = "";
+    }
+}
+
+int fill_array_f(const p_array_f arr, const float value)
+{
+    if (!is_valid_array_f(arr)) {
+        fprintf(stderr, "The array is not valid!\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < arr->size; ++i)
+        arr->data[i] = value;
+    return EXIT_SUCCESS;
+}
+
+int copy_array_f(const p_array_f origin, p_array_f dest)
+{
+    if (!is_valid_array_f(origin) || !is_valid_array_f(dest) || check_sizes(origin->size, dest->size) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    memcpy(dest->data, origin->data, origin->size * sizeof(float));
+    return EXIT_SUCCESS;
+}
+
+int convert_array_to_float(const p_array origin, p_array_f dest)
+{
+    if (!is_valid_array(origin) || !is_valid_array_f(dest) || check_sizes(origin->size, dest->size) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    for (size_t i = 0; i < origin->size; ++i)
+        dest->data[i] = (float)origin->data[i];
+    return EXIT_SUCCESS;
+}
+
+int convert_array_to_double(const p_array_f origin, p_array dest)
+{
+    if (!is_valid_array_f(origin) || !is_valid_array(dest) || check_sizes(origin->size, dest->size) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    for (size_t i = 0; i < origin->size; ++i)
+        dest->data[i] = (double)origin->data[i];
+    return EXIT_SUCCESS;
+}
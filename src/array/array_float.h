@@ -0,0 +1,109 @@
+/**
+ * @file array_float.h
+ * @author guillaume.peillex@gmail.com
+ * @brief Single precision counterpart of the array structure, used by the float and mixed precision solve modes
+ * @version 1.0.0
+ * @date 2020-04-30
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ */
+#ifndef ARRAY_FLOAT_H
+#define ARRAY_FLOAT_H
+#include <stdbool.h>
+#include "array.h"
+
+/**
+ * @brief This MACRO creates a float array which name is the same as the pointer pointing to it.
+ *
+ */
+#define BUILD_ARRAY_F(name, size) p_array_f name = build_array_f(size, #name);
+
+/**
+ * @brief Clears the float array in argument and frees the memory allocated.
+ *
+ */
+#define DELETE_ARRAY_F(arr_ptr) \
+    clear_array_f(arr_ptr);     \
+    free(arr_ptr);
+
+/**
+ * @brief Defines a float array object. It holds half the bytes of an array of the same size,
+ *        thus twice as many values fit in a SIMD vector.
+ *
+ */
+typedef struct array_f
+{
+    size_t size;  /**< Number of cells in the array */
+    const char *label;  /**< A small string naming of describing the array (may be NULL) */
+    float *data;  /**< The underlying array */
+} s_array_f, *p_array_f;
+
+/**
+ * @brief Build a float array and returns a pointer to it (see build_array).
+ *        For an easy way of deleting an array please use the macro DELETE_ARRAY_F.
+ *
+ * @param[in] size : size of the array
+ * @param[in] label : label of the array (may be NULL)
+ * @return p_array_f : pointer on the newly created array in case of success, NULL otherwise
+ */
+p_array_f build_array_f(const size_t size, const char *label);
+
+/**
+ * @brief Clear the float array by freeing the data memory, setting the size to zero
+ *        and the label to empty string (see clear_array).
+ *
+ * @param arr : array to clear
+ */
+void clear_array_f(const p_array_f arr);
+
+/**
+ * @brief Fill the float array with the value
+ *
+ * @param[in] arr : array to fill
+ * @param[in] value : value to fill the array with
+ * @return int EXIT_SUCCESS (0) : in case of success
+               EXIT_FAILURE (1) : otherwise
+ */
+int fill_array_f(const p_array_f arr, const float value);
+
+/**
+ * @brief Copies origin's data into destination's one
+ *
+ * @param origin : array to be copied
+ * @param dest : modified array
+ * @return int EXIT_SUCCESS (0) : in case of success
+               EXIT_FAILURE (1) : otherwise (invalid arrays or sizes mismatch)
+ */
+int copy_array_f(const p_array_f origin, p_array_f dest);
+
+/**
+ * @brief Check if the float array is valid (see is_valid_array).
+ *
+ * @param arr : array to check
+ * @return true : if the array is valid
+ * @return false : otherwise
+ */
+bool is_valid_array_f(const p_array_f arr);
+
+/**
+ * @brief Round the values of a double precision array to single precision
+ *
+ * @param[in] origin : double precision array
+ * @param[out] dest : float array of the same size
+ * @return int EXIT_SUCCESS (0) : in case of success
+               EXIT_FAILURE (1) : otherwise (invalid arrays or sizes mismatch)
+ */
+int convert_array_to_float(const p_array origin, p_array_f dest);
+
+/**
+ * @brief Widen the values of a float array to double precision (exact)
+ *
+ * @param[in] origin : float array
+ * @param[out] dest : double precision array of the same size
+ * @return int EXIT_SUCCESS (0) : in case of success
+               EXIT_FAILURE (1) : otherwise (invalid arrays or sizes mismatch)
+ */
+int convert_array_to_double(const p_array_f origin, p_array dest);
+
+#endif
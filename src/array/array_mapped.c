@@ -0,0 +1,152 @@
+#include "array_mapped.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Map the file on the data of a newly built array, then close the file (the mapping stays)
+ *
+ * @param[in] fd : descriptor of the file
+ * @param[in] path : path of the file (for the messages)
+ * @param[in] size : size of the array (not null)
+ * @param[in] protection : PROT_READ or PROT_READ | PROT_WRITE
+ * @param[in] label : label of the array (may be NULL)
+ * @return p_array : pointer on the newly created array in case of success, NULL otherwise
+ */
+static p_array map_file(const int fd, const char *path, const size_t size, const int protection, const char *label)
+{
+    // The structure followed by its label, as for build_array
+    const size_t label_size = label ? strlen(label) + 1 : 0;
+    p_array arr_ptr = (p_array)malloc(sizeof(s_array) + label_size);
+    void *data = arr_ptr ? mmap(NULL, size * sizeof(double), protection, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "An error has occured when building the array %s\n", label ? label : "unnamed");
+        fprintf(stderr, "The mapping of the file %s has failed (%s)!\n", path, strerror(errno));
+        free(arr_ptr);
+        return NULL;
+    }
+    arr_ptr->data = (double *)data;
+    arr_ptr->label = label ? memcpy(arr_ptr + 1, label, label_size) : NULL;
+    arr_ptr->size = size;
+    advise_array(arr_ptr, 0, size, ARRAY_SEQUENTIAL_ACCESS);
+    return arr_ptr;
+}
+
+p_array build_array_from_file(const char *path, const char *label)
+{
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Unable to open the file %s of the array %s (%s)!\n", path, label ? label : "unnamed",
+                strerror(errno));
+        return NULL;
+    }
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0 || file_status.st_size <= 0 || file_status.st_size % sizeof(double) != 0)
+    {
+        fprintf(stderr, "The size of the file %s of the array %s is not a non null multiple of %zu bytes!\n", path,
+                label ? label : "unnamed", sizeof(double));
+        close(fd);
+        return NULL;
+    }
+    const size_t size = (size_t)file_status.st_size / sizeof(double);
+    if (!are_valid_array_arguments(size, label))
+    {
+        close(fd);
+        return NULL;
+    }
+    return map_file(fd, path, size, PROT_READ, label);
+}
+
+p_array build_array_in_file(const char *path, const size_t size, const char *label)
+{
+    if (size == 0 || !are_valid_array_arguments(size, label))
+    {
+        fprintf(stderr, "Unable to build the array %s of size %zu in the file %s!\n", label ? label : "unnamed", size,
+                path);
+        return NULL;
+    }
+    const int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0 || ftruncate(fd, (off_t)(size * sizeof(double))) != 0)
+    {
+        fprintf(stderr, "Unable to create the file %s of the array %s with %zu values (%s)!\n", path,
+                label ? label : "unnamed", size, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return NULL;
+    }
+    return map_file(fd, path, size, PROT_READ | PROT_WRITE, label);
+}
+
+/**
+ * @brief Give the flag of madvise matching the advice
+ *
+ * @param[in] advice : the advice
+ * @return int : the flag, -1 if the system has none
+ */
+static int get_madvise_flag(const ArrayAdvice_e advice)
+{
+    switch (advice)
+    {
+    case ARRAY_SEQUENTIAL_ACCESS:
+        return MADV_SEQUENTIAL;
+    case ARRAY_RANDOM_ACCESS:
+        return MADV_RANDOM;
+    case ARRAY_WILL_NEED:
+        return MADV_WILLNEED;
+    case ARRAY_COLD:
+#ifdef MADV_COLD
+        return MADV_COLD;
+#else
+        return -1;
+#endif
+    default:
+        return MADV_NORMAL;
+    }
+}
+
+int advise_array(const s_array *arr, const size_t first, const size_t size, const ArrayAdvice_e advice)
+{
+    if (first > arr->size || size > arr->size - first)
+    {
+        fprintf(stderr, "The range [%zu, %zu[ is not inside the array %s of size %zu!\n", first, first + size,
+                get_array_label(arr), arr->size);
+        return EXIT_FAILURE;
+    }
+    const int flag = get_madvise_flag(advice);
+    if (size == 0 || flag < 0)
+        return EXIT_SUCCESS;
+
+    // madvise works on whole pages : the range is extended to the start of its first page
+    const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    const uintptr_t start = (uintptr_t)(arr->data + first) / page_size * page_size;
+    const uintptr_t end = (uintptr_t)(arr->data + first + size);
+    if (madvise((void *)start, end - start, flag) != 0)
+    {
+        // A kernel not knowing the flag rejects it : the hint is only lost
+        if (errno == EINVAL && advice == ARRAY_COLD)
+            return EXIT_SUCCESS;
+        fprintf(stderr, "The hint on the values [%zu, %zu[ of the array %s has been rejected (%s)!\n", first,
+                first + size, get_array_label(arr), strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+void delete_mapped_array(p_array arr)
+{
+    if (arr)
+    {
+        if (arr->data)
+            munmap(arr->data, arr->size * sizeof(double));
+        free(arr);
+    }
+}
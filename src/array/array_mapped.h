@@ -0,0 +1,82 @@
+/**
+ * @file array_mapped.h
+ * @author guillaume.peillex@gmail.com
+ * @brief Arrays which data is a file mapped in memory, and hints on the use of the pages of an array
+ * @version 1.0.0
+ * @date 2020-04-30
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * The values of an array mapped on a file are not loaded when it is built : the pages of the file are read
+ * by the OS when they are first accessed, kept in its page cache while the memory allows it and dropped
+ * (after being written back for an array in a file) otherwise. An array may thus be larger than the memory.
+ * The file holds the raw values (native doubles), without any header.
+ */
+#ifndef ARRAY_MAPPED_H
+#define ARRAY_MAPPED_H
+#include <stddef.h>
+#include "array.h"
+
+/**
+ * @brief Hints on the next accesses to the pages of an array
+ *
+ */
+typedef enum ArrayAdvice
+{
+    ARRAY_NORMAL_ACCESS,  /**< No particular order (default of the arrays not mapped) */
+    ARRAY_SEQUENTIAL_ACCESS,  /**< Read in the order of the values : the pages are read ahead and dropped once read
+                                   (default of the arrays mapped) */
+    ARRAY_RANDOM_ACCESS,  /**< No order : the pages are not read ahead */
+    ARRAY_WILL_NEED,  /**< The values will be accessed soon : their pages are read ahead in the background */
+    ARRAY_COLD  /**< The values will not be accessed soon : their pages are the first given back to the OS if the memory
+                     is short, their values being kept (ignored by the kernels older than 5.4) */
+} ArrayAdvice_e;
+
+/**
+ * @brief Build an array which values are the ones of a file, mapped read only.
+ *        Its size is the size of the file divided by the size of a double. Its values should not be written
+ *        (the process would receive a SIGSEGV). The pages are advised ARRAY_SEQUENTIAL_ACCESS.
+ *        Once used, the array should be deleted thanks to delete_mapped_array, not DELETE_ARRAY.
+ *
+ * @param[in] path : path of the file, which size should be a non null multiple of the size of a double
+ * @param[in] label : label of the array (may be NULL)
+ * @return p_array : pointer on the newly created array in case of success, NULL otherwise
+ */
+p_array build_array_from_file(const char *path, const char *label);
+
+/**
+ * @brief Build an array which values are the ones of a file, mapped read and write : the values written
+ *        in the array are written in the file. The file is created if it does not exist and resized
+ *        to size values, the values it already holds being kept and the others zeroed.
+ *        The pages are advised ARRAY_SEQUENTIAL_ACCESS.
+ *        Once used, the array should be deleted thanks to delete_mapped_array, not DELETE_ARRAY.
+ *
+ * @param[in] path : path of the file
+ * @param[in] size : size of the array
+ * @param[in] label : label of the array (may be NULL)
+ * @return p_array : pointer on the newly created array in case of success, NULL otherwise
+ */
+p_array build_array_in_file(const char *path, const size_t size, const char *label);
+
+/**
+ * @brief Give a hint to the OS on the next accesses to the values [first, first + size[ of the array.
+ *        It may be given on any array, mapped on a file or not : the hints never modify the values.
+ *
+ * @param[in] arr : the array
+ * @param[in] first : index of the first value
+ * @param[in] size : number of values
+ * @param[in] advice : the hint
+ * @return int EXIT_SUCCESS (0) : in case of success
+               EXIT_FAILURE (1) : if the range is not inside the array or the OS has rejected the hint
+ */
+int advise_array(const s_array *arr, const size_t first, const size_t size, const ArrayAdvice_e advice);
+
+/**
+ * @brief Unmap the values of an array built by build_array_from_file or build_array_in_file
+ *        (the values of the latter staying in its file) and release the array
+ *
+ * @param[in] arr : array to delete (may be NULL)
+ */
+void delete_mapped_array(p_array arr);
+
+#endif
@@ -1,4 +1,7 @@
 #include "array.h"
+#include "array_arena.h"
+#include "array_float.h"
+#include "array_mapped.h"
 #include "test_utils.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -23,7 +26,7 @@ int test_build_array()
 
     if (test_array->size != expected_size)
     {
-        fprintf(stderr, "Wrong value for the array's size : %u instead of %u\n", test_array->size, expected_size);
+        fprintf(stderr, "Wrong value for the array's size : %zu instead of %u\n", test_array->size, expected_size);
         return EXIT_FAILURE;
     }
     if (strcmp(test_array->label, expected_str) != 0)
@@ -157,7 +160,7 @@ int test_fill_array_null_size()
 int test_fill_array_data_null_ptr()
 {
     BUILD_ARRAY(null_data_arr, 10)
-    free(null_data_arr->data);
+    free_array_data(null_data_arr->data);
     null_data_arr->data = NULL;
 
     if (fill_array(null_data_arr, 123.456) == EXIT_SUCCESS)
@@ -276,7 +279,7 @@ int test_copy_array_size_mismatch()
     if (copy_array(origin, dest) == EXIT_SUCCESS)
     {
         fprintf(stderr, "The copy_array function has succeeded when it should not!\n");
-        fprintf(stderr, "The size of array %s is %u whereas the size of array %s is %u!\n",
+        fprintf(stderr, "The size of array %s is %zu whereas the size of array %s is %zu!\n",
                 origin->label, origin->size, dest->label, dest->size);
         DELETE_ARRAY(origin)
         DELETE_ARRAY(dest)
@@ -288,6 +291,444 @@ int test_copy_array_size_mismatch()
     return EXIT_SUCCESS;
 }
 
+/**
+ * @brief Test the float array : building, copy and conversions from and to double precision
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_float_array()
+{
+    BUILD_ARRAY(origin, 3)
+    BUILD_ARRAY(dest, 3)
+    BUILD_ARRAY_F(single, 3)
+    BUILD_ARRAY_F(single_copy, 3)
+    BUILD_ARRAY_F(too_small, 2)
+    int status = EXIT_SUCCESS;
+
+    // Pi is rounded to the nearest float, which is exactly widened back
+    fill_array(origin, 3.141596);
+    if (convert_array_to_float(origin, single) == EXIT_FAILURE || copy_array_f(single, single_copy) == EXIT_FAILURE ||
+        convert_array_to_double(single_copy, dest) == EXIT_FAILURE || !check_uniform_value(dest, (double)3.141596f))
+    {
+        fprintf(stderr, "The conversions of the float array have failed!\n");
+        status = EXIT_FAILURE;
+    }
+    if (convert_array_to_float(origin, too_small) == EXIT_SUCCESS || copy_array_f(single, too_small) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The copies between arrays of different sizes should have failed!\n");
+        status = EXIT_FAILURE;
+    }
+
+    DELETE_ARRAY(origin)
+    DELETE_ARRAY(dest)
+    DELETE_ARRAY_F(single)
+    DELETE_ARRAY_F(single_copy)
+    DELETE_ARRAY_F(too_small)
+    return status;
+}
+
+/**
+ * @brief Test the build_array_untouched function : the array is built as by build_array
+ *        but its values are the ones written by the caller
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_build_array_untouched()
+{
+    const unsigned int expected_size = 1000000;
+    p_array untouched = build_array_untouched(expected_size, "An untouched array");
+    if (!is_valid_array(untouched) || untouched->size != expected_size ||
+        strcmp(untouched->label, "An untouched array") != 0)
+    {
+        fprintf(stderr, "The untouched array has not been built as expected!\n");
+        if (untouched)
+        {
+            DELETE_ARRAY(untouched)
+        }
+        return EXIT_FAILURE;
+    }
+
+    fill_array(untouched, 2.5);
+    const int status = check_uniform_value(untouched, 2.5) ? EXIT_SUCCESS : EXIT_FAILURE;
+    DELETE_ARRAY(untouched)
+    return status;
+}
+
+/**
+ * @brief Test that the data of the arrays built is aligned and that its padding is zeroed
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_build_array_aligned()
+{
+    const unsigned int sizes[] = {1, 7, 8, 13, 1001};
+    const unsigned int nb_sizes = sizeof(sizes) / sizeof(unsigned int);
+    int status = EXIT_SUCCESS;
+    for (unsigned int s = 0; s < nb_sizes && status == EXIT_SUCCESS; ++s)
+    {
+        p_array zeroed = build_array(sizes[s], "A zeroed array");
+        p_array untouched = build_array_untouched(sizes[s], "An untouched array");
+        double *buffer = allocate_array_data(sizes[s]);
+        if (!is_valid_array(zeroed) || !is_valid_array(untouched) || buffer == NULL)
+        {
+            fprintf(stderr, "The arrays of size %u have not been built!\n", sizes[s]);
+            status = EXIT_FAILURE;
+        }
+        else if (!is_aligned_array(zeroed) || !is_aligned_array(untouched) || !is_aligned_data(buffer))
+        {
+            fprintf(stderr, "The data of the arrays of size %u is not aligned on %d bytes!\n", sizes[s],
+                    ARRAY_ALIGNMENT);
+            status = EXIT_FAILURE;
+        }
+        else
+        {
+            const unsigned int padded_size = (sizes[s] + ARRAY_PADDING_SIZE - 1) / ARRAY_PADDING_SIZE *
+                                             ARRAY_PADDING_SIZE;
+            for (unsigned int i = 0; i < padded_size; ++i)
+            {
+                const bool is_padding = i >= sizes[s];
+                if (zeroed->data[i] != 0. || buffer[i] != 0. || (is_padding && untouched->data[i] != 0.))
+                {
+                    fprintf(stderr, "The value %u of the arrays of size %u is not zero!\n", i, sizes[s]);
+                    status = EXIT_FAILURE;
+                    break;
+                }
+            }
+        }
+        if (zeroed)
+        {
+            DELETE_ARRAY(zeroed)
+        }
+        if (untouched)
+        {
+            DELETE_ARRAY(untouched)
+        }
+        free_array_data(buffer);
+    }
+    return status;
+}
+/**
+ * @brief Test the arrays built in an arena : header and data in its region, data aligned and zeroed,
+ *        failure once the region is full
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_build_array_in_arena()
+{
+    const unsigned int sizes[] = {13, 1, 100};
+    const size_t capacity = get_array_arena_footprint(sizes[0]) + get_array_arena_footprint(sizes[1]) +
+                            get_array_arena_footprint(sizes[2]);
+    ArrayArena_s *arena = build_array_arena(capacity);
+    if (arena == NULL)
+        return EXIT_FAILURE;
+
+    int status = EXIT_SUCCESS;
+    // Taking no byte gives the start of the free part of the region
+    const char *const region_start = (const char *)allocate_in_array_arena(arena, 0);
+    for (unsigned int a = 0; a < 3 && status == EXIT_SUCCESS; ++a)
+    {
+        BUILD_ARRAY_IN_ARENA(arena, in_arena, sizes[a])
+        if (!is_valid_array(in_arena) || in_arena->size != sizes[a] || strcmp(in_arena->label, "in_arena") != 0 ||
+            !is_aligned_array(in_arena))
+        {
+            fprintf(stderr, "The array %u has not been built in the arena as expected!\n", a);
+            status = EXIT_FAILURE;
+            break;
+        }
+        for (unsigned int i = 0; i < sizes[a]; ++i)
+        {
+            if (in_arena->data[i] != 0.)
+            {
+                fprintf(stderr, "The value %u of the array %u is not zero!\n", i, a);
+                status = EXIT_FAILURE;
+            }
+        }
+        fill_array(in_arena, 1. + a);
+        // The header and the data are in the region, one after the other
+        const char *header = (const char *)in_arena;
+        if (header < region_start || (const char *)in_arena->data <= header ||
+            (const char *)(in_arena->data + sizes[a]) > region_start + capacity)
+        {
+            fprintf(stderr, "The array %u is not in the region of the arena!\n", a);
+            status = EXIT_FAILURE;
+        }
+    }
+    if (status == EXIT_SUCCESS && get_array_arena_used(arena) != capacity)
+    {
+        fprintf(stderr, "The arena should be full : %zu bytes used instead of %zu\n", get_array_arena_used(arena),
+                capacity);
+        status = EXIT_FAILURE;
+    }
+    if (status == EXIT_SUCCESS && build_array_in_arena(arena, 1, "One array too many") != NULL)
+    {
+        fprintf(stderr, "The building of an array in a full arena should have failed!\n");
+        status = EXIT_FAILURE;
+    }
+    delete_array_arena(arena);
+    return status;
+}
+
+/**
+ * @brief Test that the reset of an arena gives its region back to the next arrays, zeroed
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_reset_array_arena()
+{
+    const unsigned int size = 1000;
+    ArrayArena_s *arena = build_array_arena(get_array_arena_footprint(size));
+    if (arena == NULL)
+        return EXIT_FAILURE;
+
+    int status = EXIT_SUCCESS;
+    p_array first = build_array_in_arena(arena, size, "first");
+    if (first == NULL)
+        status = EXIT_FAILURE;
+    else
+        fill_array(first, 3.);
+    reset_array_arena(arena);
+    if (status == EXIT_SUCCESS && get_array_arena_used(arena) != 0)
+    {
+        fprintf(stderr, "The arena should be empty after its reset!\n");
+        status = EXIT_FAILURE;
+    }
+    p_array second = status == EXIT_SUCCESS ? build_array_in_arena(arena, size, "second") : NULL;
+    if (status == EXIT_SUCCESS && second != first)
+    {
+        fprintf(stderr, "The array built after the reset should reuse the region!\n");
+        status = EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < size && status == EXIT_SUCCESS; ++i)
+    {
+        if (second->data[i] != 0.)
+        {
+            fprintf(stderr, "The value %u of the array built after the reset is not zero!\n", i);
+            status = EXIT_FAILURE;
+        }
+    }
+    delete_array_arena(arena);
+    return status;
+}
+
+/**
+ * @brief Test that a sub array shares the values of its array and that a range outside the array is refused
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_get_sub_array()
+{
+    BUILD_ARRAY(whole, 100)
+    if (whole == NULL)
+        return EXIT_FAILURE;
+    for (size_t i = 0; i < whole->size; ++i)
+        whole->data[i] = i;
+
+    int status = EXIT_SUCCESS;
+    s_array slice = get_sub_array(whole, 40, 20);
+    if (slice.size != 20 || slice.data != whole->data + 40 || slice.data[0] != 40.)
+    {
+        fprintf(stderr, "The sub array [40, 60[ does not hold the values 40 to 59 of the array!\n");
+        status = EXIT_FAILURE;
+    }
+    fill_array(&slice, -1.);
+    if (whole->data[39] != 39. || whole->data[40] != -1. || whole->data[59] != -1. || whole->data[60] != 60.)
+    {
+        fprintf(stderr, "Filling the sub array should modify the values [40, 60[ of the array only!\n");
+        status = EXIT_FAILURE;
+    }
+    s_array outside = get_sub_array(whole, 90, 20);
+    if (outside.data != NULL || outside.size != 0)
+    {
+        fprintf(stderr, "The sub array [90, 110[ should have no data!\n");
+        status = EXIT_FAILURE;
+    }
+    DELETE_ARRAY(whole)
+    return status;
+}
+
+/**
+ * @brief Test the gathering and the scattering of the values of strided views, forward and backward
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_strided_view()
+{
+    BUILD_ARRAY(interleaved, 10)
+    BUILD_ARRAY(odd_values, 5)
+    if (interleaved == NULL || odd_values == NULL)
+        return EXIT_FAILURE;
+    for (size_t i = 0; i < interleaved->size; ++i)
+        interleaved->data[i] = i;
+
+    int status = EXIT_SUCCESS;
+    // Every odd value, then the same ones from the last
+    const s_array_view forward = get_strided_view(interleaved, 1, 5, 2);
+    const s_array_view backward = get_strided_view(interleaved, 9, 5, -2);
+    if (gather_array_view(&forward, odd_values) == EXIT_FAILURE)
+        status = EXIT_FAILURE;
+    for (size_t i = 0; i < odd_values->size && status == EXIT_SUCCESS; ++i)
+    {
+        if (odd_values->data[i] != 2. * i + 1.)
+        {
+            fprintf(stderr, "The value %zu gathered is %g instead of %g!\n", i, odd_values->data[i], 2. * i + 1.);
+            status = EXIT_FAILURE;
+        }
+    }
+    if (status == EXIT_SUCCESS && scatter_array_view(odd_values, &backward) == EXIT_FAILURE)
+        status = EXIT_FAILURE;
+    for (size_t i = 0; i < interleaved->size && status == EXIT_SUCCESS; ++i)
+    {
+        const double expected = i % 2 == 0 ? i : 10. - i;
+        if (interleaved->data[i] != expected)
+        {
+            fprintf(stderr, "The value %zu after the scatter is %g instead of %g!\n", i, interleaved->data[i],
+                    expected);
+            status = EXIT_FAILURE;
+        }
+    }
+    // The view should stay inside the array
+    const s_array_view outside = get_strided_view(interleaved, 1, 6, 2);
+    if (outside.data != NULL || gather_array_view(&outside, odd_values) != EXIT_FAILURE)
+    {
+        fprintf(stderr, "The view of 6 values of stride 2 from 1 should have no data!\n");
+        status = EXIT_FAILURE;
+    }
+    DELETE_ARRAY(interleaved)
+    DELETE_ARRAY(odd_values)
+    return status;
+}
+
+/**
+ * @brief Test an array built without label, in the heap and in an arena
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_build_array_without_label()
+{
+    p_array unlabeled = build_array(10, NULL);
+    ArrayArena_s *arena = build_array_arena(get_array_arena_footprint(10));
+    p_array unlabeled_in_arena = arena ? build_array_in_arena(arena, 10, NULL) : NULL;
+    int status = EXIT_SUCCESS;
+    if (unlabeled == NULL || unlabeled_in_arena == NULL || unlabeled->label != NULL ||
+        unlabeled_in_arena->label != NULL || strcmp(get_array_label(unlabeled), "unnamed") != 0)
+    {
+        fprintf(stderr, "The arrays built without label should be valid and unnamed!\n");
+        status = EXIT_FAILURE;
+    }
+    if (unlabeled)
+    {
+        DELETE_ARRAY(unlabeled)
+    }
+    delete_array_arena(arena);
+    return status;
+}
+
+/**
+ * @brief Test that the values written in an array mapped on a file are read back by an array mapped on this file
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_build_array_in_file()
+{
+    const char *path = "test_array_in_file.bin";
+    const size_t size = 3000;
+    p_array written = build_array_in_file(path, size, "written");
+    if (written == NULL)
+        return EXIT_FAILURE;
+    for (size_t i = 0; i < size; ++i)
+        written->data[i] = 0.5 * i;
+    int status = advise_array(written, 1000, 1000, ARRAY_COLD);
+    if (advise_array(written, 2500, 1000, ARRAY_WILL_NEED) != EXIT_FAILURE)
+    {
+        fprintf(stderr, "A hint on values outside the array should have been rejected!\n");
+        status = EXIT_FAILURE;
+    }
+    delete_mapped_array(written);
+
+    p_array read = build_array_from_file(path, "read");
+    if (read == NULL || read->size != size)
+    {
+        fprintf(stderr, "The array read from the file should hold %zu values!\n", size);
+        status = EXIT_FAILURE;
+    }
+    for (size_t i = 0; read && i < read->size && status == EXIT_SUCCESS; ++i)
+    {
+        if (read->data[i] != 0.5 * i)
+        {
+            fprintf(stderr, "The value %zu read is %g instead of %g!\n", i, read->data[i], 0.5 * i);
+            status = EXIT_FAILURE;
+        }
+    }
+    delete_mapped_array(read);
+    remove(path);
+    if (build_array_from_file(path, "missing") != NULL)
+    {
+        fprintf(stderr, "Building an array from a missing file should have failed!\n");
+        status = EXIT_FAILURE;
+    }
+    return status;
+}
+
+/**
+ * @brief Test the arrays backed by each kind of pages, large enough for huge pages, and the choice
+ *        of the pages by the environment variable if it is set
+ * 
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_array_huge_pages()
+{
+    int status = EXIT_SUCCESS;
+    const char *requested = getenv(ARRAY_HUGE_PAGES_ENV_VAR);
+    if (requested && strcmp(get_array_huge_pages_name(get_array_huge_pages()), requested) != 0)
+    {
+        fprintf(stderr, "The pages should be the ones of the environment (%s instead of %s)!\n",
+                get_array_huge_pages_name(get_array_huge_pages()), requested);
+        status = EXIT_FAILURE;
+    }
+    // A huge page and a half, so that the last huge page is partially used
+    const size_t size = 3 * ARRAY_HUGE_PAGE_SIZE / 2 / sizeof(double);
+    const ArrayHugePages_e huge_pages[3] = {ARRAY_NO_HUGE_PAGES, ARRAY_TRANSPARENT_HUGE_PAGES,
+                                            ARRAY_RESERVED_HUGE_PAGES};
+    for (int h = 0; h < 3 && status == EXIT_SUCCESS; ++h)
+    {
+        set_array_huge_pages(huge_pages[h]);
+        p_array large = build_array(size, "large");
+        double *small = allocate_array_data(10);
+        if (large == NULL || small == NULL || !is_aligned_array(large) || !is_aligned_data(small))
+        {
+            fprintf(stderr, "Unable to build aligned arrays with the pages %s!\n",
+                    get_array_huge_pages_name(huge_pages[h]));
+            status = EXIT_FAILURE;
+        }
+        for (size_t i = 0; i < size && status == EXIT_SUCCESS; ++i)
+        {
+            if (large->data[i] != 0.)
+            {
+                fprintf(stderr, "The value %zu of the array built with the pages %s is not zero!\n", i,
+                        get_array_huge_pages_name(huge_pages[h]));
+                status = EXIT_FAILURE;
+            }
+            large->data[i] = i;
+        }
+        if (large)
+        {
+            DELETE_ARRAY(large)
+        }
+        free_array_data(small);
+    }
+    set_array_huge_pages(ARRAY_NO_HUGE_PAGES);
+    return status;
+}
 
 /**
  * @brief Print usage of this program
@@ -325,7 +766,17 @@ int main(int argc, char* argv[])
         TEST_DECLARATION(test_clear_array),
         TEST_DECLARATION(test_is_valid_array),
         TEST_DECLARATION(test_copy_array),
-        TEST_DECLARATION(test_copy_array_size_mismatch)
+        TEST_DECLARATION(test_copy_array_size_mismatch),
+        TEST_DECLARATION(test_float_array),
+        TEST_DECLARATION(test_build_array_untouched),
+        TEST_DECLARATION(test_build_array_aligned),
+        TEST_DECLARATION(test_build_array_in_arena),
+        TEST_DECLARATION(test_reset_array_arena),
+        TEST_DECLARATION(test_get_sub_array),
+        TEST_DECLARATION(test_strided_view),
+        TEST_DECLARATION(test_build_array_without_label),
+        TEST_DECLARATION(test_build_array_in_file),
+        TEST_DECLARATION(test_array_huge_pages)
     };
     const int test_number = sizeof(test_collection) / sizeof(s_unittest);
 
@@ -0,0 +1,125 @@
+/**
+ * @file benchmark_array_arena.c
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Compare the cost of the short-lived arrays of a solve built and deleted one by one
+ *        (build_array and DELETE_ARRAY) or built in an arena reset at the end of the cycle,
+ *        each thread building its own arrays at the same time.
+ *        Run it with OMP_NUM_THREADS set to the number of threads wanted.
+ * @version 0.1
+ * @date 2020-05-04
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Usage : benchmark_array_arena [number_of_cells_per_array] [number_of_cycles]
+ */
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "array_arena.h"
+#include "benchmark_utils.h"
+
+/**
+ * @brief Number of arrays built by a thread at each cycle (as many as the buffers of a Newton workspace)
+ *
+ */
+#define NB_ARRAYS 14
+
+/**
+ * @brief Number of ways of building the arrays compared
+ *
+ */
+#define NB_MODES 3
+
+/**
+ * @brief Build, write and release the arrays of one cycle of a thread
+ *
+ * @param[in] mode : 0 build_array and DELETE_ARRAY, 1 arena of the thread, 2 arena shared by the threads
+ * @param[in] arena : the arena of the mode 1 or 2
+ * @param[in] size : size of the arrays
+ * @return int : success (0) or failure (1)
+ */
+static int run_cycle(const int mode, ArrayArena_s *arena, const unsigned int size)
+{
+    p_array arrays[NB_ARRAYS];
+    int status = EXIT_SUCCESS;
+    for (int a = 0; a < NB_ARRAYS; ++a)
+    {
+        arrays[a] = mode == 0 ? build_array(size, "temporary") : build_array_in_arena(arena, size, "temporary");
+        if (arrays[a] == NULL)
+            status = EXIT_FAILURE;
+        else
+            arrays[a]->data[size - 1] = a;
+    }
+    if (mode == 0)
+    {
+        for (int a = 0; a < NB_ARRAYS; ++a)
+        {
+            if (arrays[a])
+            {
+                DELETE_ARRAY(arrays[a])
+            }
+        }
+    }
+    return status;
+}
+
+/**
+ * @brief Launch the benchmark
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+    const unsigned int size = get_positive_argument(argc, argv, 1, 1000);
+    const unsigned int nb_cycles = get_positive_argument(argc, argv, 2, 100000);
+    const int nb_threads = omp_get_max_threads();
+    const char *names[NB_MODES] = {"build/delete", "arena per thread", "shared arena"};
+
+    printf("%d threads, %d arrays of %u cells per thread and per cycle, %u cycles\n", nb_threads, NB_ARRAYS, size,
+           nb_cycles);
+    printf("%18s | %16s\n", "arrays", "time/cycle (us)");
+    ArrayArena_s *shared_arena = build_array_arena(nb_threads * NB_ARRAYS * get_array_arena_footprint(size));
+    if (shared_arena == NULL)
+        return EXIT_FAILURE;
+    int status = EXIT_SUCCESS;
+    for (int mode = 0; mode < NB_MODES && status == EXIT_SUCCESS; ++mode)
+    {
+        double elapsed = 0.;
+#pragma omp parallel reduction(max : status, elapsed)
+        {
+            int thread_status = EXIT_SUCCESS;
+            ArrayArena_s *arena = mode == 2 ? shared_arena : NULL;
+            if (mode == 1)
+            {
+                arena = build_array_arena(NB_ARRAYS * get_array_arena_footprint(size));
+                thread_status = arena == NULL ? EXIT_FAILURE : EXIT_SUCCESS;
+            }
+            const double start = get_wall_time();
+            // Every thread runs every cycle, so that they all meet at the barriers of the shared arena
+            for (unsigned int cycle = 0; cycle < nb_cycles; ++cycle)
+            {
+                if (thread_status == EXIT_SUCCESS)
+                    thread_status = run_cycle(mode, arena, size);
+                if (mode == 1 && arena)
+                    reset_array_arena(arena);
+                if (mode == 2)
+                {
+                    // The shared arena is reset once every thread is done with its arrays
+#pragma omp barrier
+#pragma omp single
+                    reset_array_arena(shared_arena);
+                }
+            }
+            elapsed = get_wall_time() - start;
+            status = thread_status;
+            if (mode == 1)
+                delete_array_arena(arena);
+        }
+        if (status == EXIT_SUCCESS)
+            printf("%18s | %16.3f\n", names[mode], 1.e+06 * elapsed / nb_cycles);
+    }
+    delete_array_arena(shared_arena);
+    return status;
+}
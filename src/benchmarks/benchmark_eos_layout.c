@@ -0,0 +1,96 @@
+/**
+ * @file benchmark_eos_layout.c
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Time the allocation, the initialization and the pressure kernels of the MieGruneisen eos
+ *        with the layout of its per cell terms selected at build time (EOS_ALIGNED_SOA option).
+ *        Run it from a build of each layout to compare them.
+ * @version 0.1
+ * @date 2020-05-06
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Usage : benchmark_eos_layout [number_of_cells] [number_of_repetitions]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "benchmark_utils.h"
+#include "miegruneisen.h"
+#include "miegruneisen_params.h"
+
+/**
+ * @brief Launch the benchmark
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+    const unsigned int pb_size = get_positive_argument(argc, argv, 1, 4000000);
+    const unsigned int nb_repeats = get_positive_argument(argc, argv, 2, 20);
+
+    BUILD_ARRAY(specific_volume, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(gamma_per_vol, pb_size)
+    BUILD_ARRAY(c_son, pb_size)
+    p_array built_arrays[] = {specific_volume, internal_energy, pressure, gamma_per_vol, c_son};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        specific_volume->data[i] = 1. / (8700. + 1500. * i / pb_size);
+    }
+    fill_array(internal_energy, 1.e+05);
+
+    MieGruneisenParams_s copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    int status = EXIT_SUCCESS;
+    double allocation_time = 0.;
+    double init_time = 0.;
+    double derivative_time = 0.;
+    double sound_speed_time = 0.;
+    for (unsigned int repeat = 0; repeat < nb_repeats && status == EXIT_SUCCESS; ++repeat)
+    {
+        MieGruneisenEOS_s copper_eos = {.params = &copper_mat, .is_affine_in_energy = true, .init = init,
+                                        .finalize = finalize};
+        double start = get_wall_time();
+        status = allocate_miegruneisen_arrays(&copper_eos, pb_size);
+        allocation_time += get_wall_time() - start;
+        start = get_wall_time();
+        if (status == EXIT_SUCCESS)
+            status = copper_eos.init(&copper_eos, pb_size, specific_volume->data);
+        init_time += get_wall_time() - start;
+        if (status == EXIT_SUCCESS)
+        {
+            start = get_wall_time();
+            compute_pressure_and_derivative(&copper_eos, pb_size, specific_volume->data, internal_energy->data,
+                                            pressure->data, gamma_per_vol->data);
+            derivative_time += get_wall_time() - start;
+            start = get_wall_time();
+            compute_pressure_and_sound_speed(&copper_eos, pb_size, specific_volume->data, internal_energy->data,
+                                             pressure->data, c_son->data);
+            sound_speed_time += get_wall_time() - start;
+        }
+        copper_eos.finalize(&copper_eos);
+    }
+
+#ifdef MIEGRUNEISEN_ALIGNED_SOA
+    printf("Layout of the eos terms : single block aligned on %d bytes (stride of %lu doubles)\n",
+           MIEGRUNEISEN_ALIGNMENT, get_miegruneisen_terms_stride(pb_size));
+#else
+    printf("Layout of the eos terms : five separate arrays\n");
+#endif
+    printf("%u cells, %u repetitions\n", pb_size, nb_repeats);
+    printf("%30s | %14s\n", "step", "time (s)");
+    printf("%30s | %14.6g\n", "allocation", allocation_time / nb_repeats);
+    printf("%30s | %14.6g\n", "init (first touch)", init_time / nb_repeats);
+    printf("%30s | %14.6g\n", "pressure and derivative", derivative_time / nb_repeats);
+    printf("%30s | %14.6g\n", "pressure and sound speed", sound_speed_time / nb_repeats);
+
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file benchmark_halley.c
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Compare the Halley incrementation to the classical Newton one, in number of sweeps
+ *        over the arrays and in time, on the cubic function and on the VNR equation
+ * @version 0.1
+ * @date 2020-05-04
+ * 
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ * 
+ * Usage : benchmark_halley [number_of_cells] [number_of_repetitions]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "benchmark_utils.h"
+#include "cubic.h"
+#include "incrementations_methods.h"
+#include "launch_vnr_resolution.h"
+#include "miegruneisen_params.h"
+#include "newton.h"
+#include "stop_criterions.h"
+
+/**
+ * @brief Solve the cubic function with both incrementations and print the results
+ * 
+ * @param[in] pb_size : number of unknowns
+ * @param[in] nb_repetitions : number of solves timed
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+static int benchmark_cubic(const unsigned int pb_size, const unsigned int nb_repetitions)
+{
+    NewtonParameters_s newton = {.evaluate_the_function = cubic_function,
+                                 .compute_increment_vector = classical_incrementation,
+                                 .check_convergence = relative_gap};
+    NewtonParameters_s halley = newton;
+    halley.evaluate_the_function_and_second_derivative = cubic_function_with_second_derivative;
+    halley.compute_second_order_increment_vector = halley_incrementation;
+    NewtonParameters_s *solvers[] = {&newton, &halley};
+    const char *names[] = {"classical", "halley"};
+
+    BUILD_ARRAY(x, pb_size)
+    BUILD_ARRAY(sol, pb_size)
+    p_array built_arrays[] = {x, sol};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    NewtonWorkspace_s *workspace = build_newton_workspace(pb_size);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE || workspace == NULL)
+    {
+        delete_newton_workspace(workspace);
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    // Initial values spread between 2 and 10, far above the largest root (1.618...)
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        x->data[i] = 2. + 8. * i / pb_size;
+    }
+
+    printf("Cubic function (%u unknowns, %u solves)\n", pb_size, nb_repetitions);
+    printf("%12s | %8s | %14s | %14s\n", "method", "sweeps", "time/solve (s)", "max residual");
+    int status = EXIT_SUCCESS;
+    for (unsigned int s = 0; s < sizeof(solvers) / sizeof(NewtonParameters_s *); ++s)
+    {
+        const double start = get_wall_time();
+        for (unsigned int r = 0; r < nb_repetitions; ++r)
+        {
+            if (solveNewtonWithWorkspace(solvers[s], NULL, x, sol, workspace) == EXIT_FAILURE)
+                status = EXIT_FAILURE;
+        }
+        const double elapsed = get_wall_time() - start;
+        printf("%12s | %8d | %14.6g | %14.6g\n", names[s], workspace->report.nb_iterations, elapsed / nb_repetitions,
+               workspace->report.max_residual);
+    }
+
+    delete_newton_workspace(workspace);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Solve the VNR equation on a strongly shocked mesh with both incrementations and print the results
+ * 
+ * @param[in] pb_size : number of cells
+ * @param[in] nb_repetitions : number of solves timed
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+static int benchmark_vnr(const unsigned int pb_size, const unsigned int nb_repetitions)
+{
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(new_pressure, pb_size)
+    BUILD_ARRAY(new_cson, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                              new_pressure, new_cson};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    VnrSolver_s *solver = build_vnr_solver(pb_size);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE || solver == NULL)
+    {
+        delete_vnr_solver(solver);
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    fill_array(pressure, 10.e+09);
+    fill_array(internal_energy, 1.325e+04);
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        // From a light compression to a strong shock
+        old_specific_volume->data[i] = 1. / 8230.;
+        new_specific_volume->data[i] = 1. / (8300. + 5000. * i / pb_size);
+    }
+
+    MieGruneisenParams_s const copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    const VnrKernel_e kernels[] = {VNR_GENERIC_NEWTON_KERNEL, VNR_HALLEY_KERNEL};
+    const char *names[] = {"classical", "halley"};
+
+    printf("VNR equation (%u cells, %u solves)\n", pb_size, nb_repetitions);
+    printf("%12s | %8s | %14s | %14s\n", "method", "sweeps", "time/solve (s)", "max residual");
+    int status = EXIT_SUCCESS;
+    for (unsigned int k = 0; k < sizeof(kernels) / sizeof(VnrKernel_e); ++k)
+    {
+        VnrSolverOptions_s *options = get_vnr_solver_options(solver);
+        options->use_direct_solve = false;
+        options->kernel = kernels[k];
+        const double start = get_wall_time();
+        for (unsigned int r = 0; r < nb_repetitions; ++r)
+        {
+            if (launch_vnr_resolution_with_solver(solver, &copper_mat, old_specific_volume, new_specific_volume, pressure,
+                                                  internal_energy, solution, new_pressure, new_cson) == EXIT_FAILURE)
+                status = EXIT_FAILURE;
+        }
+        const double elapsed = get_wall_time() - start;
+        const NewtonReport_s *report = get_vnr_solver_report(solver);
+        printf("%12s | %8d | %14.6g | %14.6g\n", names[k], report->nb_iterations, elapsed / nb_repetitions,
+               report->max_residual);
+    }
+    printf("The MieGruneisen eos is affine in internal energy : the second derivative is null and the Halley\n"
+           "increment is the classical one, so only the cost of the second derivative is measured here.\n");
+
+    delete_vnr_solver(solver);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Launch the benchmark
+ * 
+ * @return int : success (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+    const unsigned int pb_size = get_positive_argument(argc, argv, 1, 100000);
+    const unsigned int nb_repetitions = get_positive_argument(argc, argv, 2, 100);
+
+    if (benchmark_cubic(pb_size, nb_repetitions) == EXIT_FAILURE)
+    {
+        fprintf(stderr, "The benchmark of the cubic function has failed!\n");
+        return EXIT_FAILURE;
+    }
+    printf("\n");
+    if (benchmark_vnr(pb_size, nb_repetitions) == EXIT_FAILURE)
+    {
+        fprintf(stderr, "The benchmark of the VNR equation has failed!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
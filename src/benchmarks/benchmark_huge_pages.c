@@ -0,0 +1,163 @@
+/**
+ * @file benchmark_huge_pages.c
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Compare the time per solve of a large mesh which arrays, and the scratch memory of the solver,
+ *        are backed by the pages of the system, by transparent huge pages or by reserved huge pages.
+ *        The reserved huge pages should have been set by the administrator
+ *        (e.g echo 512 > /proc/sys/vm/nr_hugepages), otherwise the transparent ones are used instead.
+ *        Run it with OMP_NUM_THREADS set to the number of threads wanted.
+ * @version 0.1
+ * @date 2020-05-04
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Usage : benchmark_huge_pages [number_of_cells] [number_of_cycles]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "array.h"
+#include "benchmark_utils.h"
+#include "launch_vnr_resolution.h"
+#include "miegruneisen_params.h"
+
+/**
+ * @brief Number of arrays of the problem
+ *
+ */
+#define NB_ARRAYS 7
+
+/**
+ * @brief Return a value of /proc/meminfo
+ *
+ * @param[in] key : name of the value (e.g "HugePages_Free:")
+ * @return long : the value (in kB for the sizes), -1 if it is unknown
+ */
+static long get_meminfo_value(const char *key)
+{
+    long value = -1;
+    char line[256];
+    FILE *meminfo = fopen("/proc/meminfo", "r");
+    while (meminfo && value < 0 && fgets(line, sizeof(line), meminfo) != NULL)
+    {
+        if (strncmp(line, key, strlen(key)) == 0)
+            value = strtol(line + strlen(key), NULL, 10);
+    }
+    if (meminfo)
+        fclose(meminfo);
+    return value;
+}
+
+/**
+ * @brief Print the setting of the transparent huge pages and the number of reserved huge pages
+ *
+ */
+static void print_huge_pages_settings(void)
+{
+    char setting[256] = "unknown\n";
+    FILE *enabled = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+    if (enabled)
+    {
+        if (fgets(setting, sizeof(setting), enabled) == NULL)
+            snprintf(setting, sizeof(setting), "unknown\n");
+        fclose(enabled);
+    }
+    printf("Transparent huge pages : %s", setting);
+    printf("Reserved huge pages : %ld (%ld free)\n", get_meminfo_value("HugePages_Total:"),
+           get_meminfo_value("HugePages_Free:"));
+}
+
+/**
+ * @brief Time the solves of the mesh with the pages given
+ *
+ * @param[in] huge_pages : pages backing the arrays and the scratch memory of the solver
+ * @param[in] pb_size : number of cells
+ * @param[in] nb_cycles : number of solves
+ * @param[out] elapsed : time per solve
+ * @param[out] huge_memory : memory backed by huge pages (transparent and reserved) during the solves, in MiB
+ * @return int : success (0) or failure (1)
+ */
+static int time_pages(const ArrayHugePages_e huge_pages, const unsigned int pb_size, const unsigned int nb_cycles,
+                      double *elapsed, double *huge_memory)
+{
+    const char *labels[NB_ARRAYS] = {"old_specific_volume", "new_specific_volume", "pressure", "internal_energy",
+                                     "solution", "new_p", "new_vson"};
+    const long anonymous_before = get_meminfo_value("AnonHugePages:");
+    const long free_before = get_meminfo_value("HugePages_Free:");
+    // Every allocation from now on is backed by these pages
+    set_array_huge_pages(huge_pages);
+    VnrSolver_s *solver = build_vnr_solver(pb_size);
+    if (solver == NULL)
+        return EXIT_FAILURE;
+    p_array arrays[NB_ARRAYS];
+    for (int a = 0; a < NB_ARRAYS; ++a)
+    {
+        arrays[a] = build_array(pb_size, labels[a]);
+    }
+    if (check_arrays_building(arrays, NB_ARRAYS) == EXIT_FAILURE)
+    {
+        cleanup_memory(arrays, NB_ARRAYS);
+        delete_vnr_solver(solver);
+        return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        arrays[0]->data[i] = 1. / 8930.;
+        arrays[1]->data[i] = 1. / (8700. + 1500. * i / pb_size);
+    }
+    fill_array(arrays[2], 1.e+09);
+    fill_array(arrays[3], 1.e+04);
+
+    MieGruneisenParams_s copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    int status = EXIT_SUCCESS;
+    // The first solve maps the scratch memory of the threads, it is not timed
+    for (unsigned int cycle = 0; cycle <= nb_cycles && status == EXIT_SUCCESS; ++cycle)
+    {
+        const double start = get_wall_time();
+        status = launch_vnr_resolution_with_solver(solver, &copper_mat, arrays[0], arrays[1], arrays[2], arrays[3],
+                                                   arrays[4], arrays[5], arrays[6]);
+        if (cycle == 0)
+            *elapsed = 0.;
+        else
+            *elapsed += get_wall_time() - start;
+    }
+    *elapsed /= nb_cycles;
+    const long reserved_used = free_before - get_meminfo_value("HugePages_Free:");
+    *huge_memory = (get_meminfo_value("AnonHugePages:") - anonymous_before) / 1024. +
+                   reserved_used * (double)ARRAY_HUGE_PAGE_SIZE / (1 << 20);
+
+    cleanup_memory(arrays, NB_ARRAYS);
+    delete_vnr_solver(solver);
+    set_array_huge_pages(ARRAY_NO_HUGE_PAGES);
+    return status;
+}
+
+/**
+ * @brief Launch the benchmark
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+    const unsigned int pb_size = get_positive_argument(argc, argv, 1, 20000000);
+    const unsigned int nb_cycles = get_positive_argument(argc, argv, 2, 20);
+    const ArrayHugePages_e huge_pages[3] = {ARRAY_NO_HUGE_PAGES, ARRAY_TRANSPARENT_HUGE_PAGES,
+                                            ARRAY_RESERVED_HUGE_PAGES};
+
+    print_huge_pages_settings();
+    printf("VNR equation (%u cells, %u cycles)\n", pb_size, nb_cycles);
+    printf("%12s | %14s | %16s\n", "pages", "time/solve (s)", "huge pages (MiB)");
+    int status = EXIT_SUCCESS;
+    for (int h = 0; h < 3 && status == EXIT_SUCCESS; ++h)
+    {
+        double elapsed = 0.;
+        double huge_memory = 0.;
+        status = time_pages(huge_pages[h], pb_size, nb_cycles, &elapsed, &huge_memory);
+        if (status == EXIT_SUCCESS)
+            printf("%12s | %14.6g | %16.0f\n", get_array_huge_pages_name(huge_pages[h]), elapsed, huge_memory);
+    }
+    printf("The transparent huge pages are only used if the kernel has free ones, and may be used without being "
+           "advised if they are enabled always.\n");
+    return status;
+}
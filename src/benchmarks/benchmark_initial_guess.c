@@ -0,0 +1,154 @@
+/**
+ * @file benchmark_initial_guess.c
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Compare the initial guess strategies of the VNR solver, in number of Newton iterations,
+ *        over several cycles of a mesh crossed by a compression wave
+ * @version 0.1
+ * @date 2020-05-04
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Usage : benchmark_initial_guess [number_of_cells] [number_of_cycles]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "benchmark_utils.h"
+#include "launch_vnr_resolution.h"
+#include "miegruneisen_params.h"
+#include "newton.h"
+
+/**
+ * @brief Specific volume of a cell at a given cycle : a compression wave travels along the mesh
+ *
+ * @param[in] cell : index of the cell
+ * @param[in] pb_size : number of cells
+ * @param[in] cycle : index of the cycle
+ * @return double : the specific volume
+ */
+static double get_specific_volume(const unsigned int cell, const unsigned int pb_size, const unsigned int cycle)
+{
+    const double phase = 2. * M_PI * ((double)cell / pb_size - 0.01 * cycle);
+    return 1. / (8930. + 500. * sin(phase));
+}
+
+/**
+ * @brief Compute the mean number of iterations of the converged cells of the report
+ *
+ * @param[in] report : the report
+ * @return double : the mean number of iterations
+ */
+static double get_mean_nb_iterations(const NewtonReport_s *report)
+{
+    double nb_iterations = 0.;
+    unsigned int nb_converged = 0;
+    for (int bin = 0; bin < NEWTON_REPORT_HISTOGRAM_SIZE; ++bin)
+    {
+        nb_iterations += (double)bin * report->iterations_histogram[bin];
+        nb_converged += report->iterations_histogram[bin];
+    }
+    return nb_converged > 0 ? nb_iterations / nb_converged : 0.;
+}
+
+/**
+ * @brief Launch the benchmark
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+    const unsigned int pb_size = get_positive_argument(argc, argv, 1, 100000);
+    const unsigned int nb_cycles = get_positive_argument(argc, argv, 2, 50);
+
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(new_pressure, pb_size)
+    BUILD_ARRAY(new_cson, pb_size)
+    BUILD_ARRAY(exact_solution, pb_size)
+    BUILD_ARRAY(exact_pressure, pb_size)
+    BUILD_ARRAY(exact_cson, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                              new_pressure, new_cson, exact_solution, exact_pressure, exact_cson};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    VnrSolver_s *solver = build_vnr_solver(pb_size);
+    VnrSolver_s *direct_solver = build_vnr_solver(pb_size);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE || solver == NULL || direct_solver == NULL)
+    {
+        delete_vnr_solver(solver);
+        delete_vnr_solver(direct_solver);
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+
+    MieGruneisenParams_s const copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    const VnrInitialGuess_e strategies[] = {VNR_CURRENT_ENERGY_GUESS, VNR_USER_GUESS, VNR_PREDICTOR_GUESS,
+                                            VNR_EXTRAPOLATED_GUESS};
+    const char *names[] = {"current", "user (exact)", "predictor", "extrapolated"};
+    // The guess of the caller is the solution of the direct solve
+    VnrSolverOptions_s *options = get_vnr_solver_options(solver);
+    options->use_direct_solve = false;
+    options->kernel = VNR_GENERIC_NEWTON_KERNEL;
+    options->user_initial_guess = exact_solution->data;
+
+    printf("VNR equation (%u cells, %u cycles)\n", pb_size, nb_cycles);
+    printf("%14s | %12s | %16s | %18s | %14s\n", "initial guess", "mean sweeps", "mean iterations", "iterations saved",
+           "time/cycle (s)");
+    int status = EXIT_SUCCESS;
+    double reference_nb_iterations = 0.;
+    for (unsigned int s = 0; s < sizeof(strategies) / sizeof(VnrInitialGuess_e); ++s)
+    {
+        options->initial_guess = strategies[s];
+        // Same initial state for every strategy
+        fill_array(pressure, 1.e+09);
+        fill_array(internal_energy, 1.e+04);
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            new_specific_volume->data[i] = get_specific_volume(i, pb_size, 0);
+        }
+        double nb_sweeps = 0.;
+        double nb_iterations = 0.;
+        double elapsed = 0.;
+        for (unsigned int cycle = 1; cycle <= nb_cycles; ++cycle)
+        {
+            for (unsigned int i = 0; i < pb_size; ++i)
+            {
+                old_specific_volume->data[i] = new_specific_volume->data[i];
+                new_specific_volume->data[i] = get_specific_volume(i, pb_size, cycle);
+            }
+            if (launch_vnr_resolution_with_solver(direct_solver, &copper_mat, old_specific_volume, new_specific_volume,
+                                                  pressure, internal_energy, exact_solution, exact_pressure,
+                                                  exact_cson) == EXIT_FAILURE)
+                status = EXIT_FAILURE;
+            const double start = get_wall_time();
+            if (launch_vnr_resolution_with_solver(solver, &copper_mat, old_specific_volume, new_specific_volume, pressure,
+                                                  internal_energy, solution, new_pressure, new_cson) == EXIT_FAILURE)
+                status = EXIT_FAILURE;
+            elapsed += get_wall_time() - start;
+            const NewtonReport_s *report = get_vnr_solver_report(solver);
+            nb_sweeps += report->nb_iterations;
+            nb_iterations += get_mean_nb_iterations(report);
+            // Next cycle
+            copy_array(solution, internal_energy);
+            copy_array(new_pressure, pressure);
+        }
+        nb_sweeps /= nb_cycles;
+        nb_iterations /= nb_cycles;
+        if (s == 0)
+            reference_nb_iterations = nb_iterations;
+        printf("%14s | %12.3f | %16.3f | %18.3f | %14.6g\n", names[s], nb_sweeps, nb_iterations,
+               reference_nb_iterations - nb_iterations, elapsed / nb_cycles);
+    }
+    printf("The iterations saved are counted per cell and per cycle, relatively to the current internal energy guess.\n"
+           "The MieGruneisen eos being affine in internal energy, the first Newton step is exact and at most\n"
+           "the iteration confirming the convergence may be saved.\n");
+
+    delete_vnr_solver(solver);
+    delete_vnr_solver(direct_solver);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
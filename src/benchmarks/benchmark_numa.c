@@ -0,0 +1,137 @@
+/**
+ * @file benchmark_numa.c
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Compare the time per solve of a large mesh which arrays are first written by the calling thread
+ *        (their pages being mapped on its NUMA node) or by the threads of the solver, pinned or not.
+ *        Run it with OMP_NUM_THREADS set to the number of threads wanted, on a multi-socket machine
+ *        or under numactl (e.g numactl --cpunodebind=0,1 benchmark_numa) to choose the nodes used.
+ * @version 0.1
+ * @date 2020-05-04
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Usage : benchmark_numa [number_of_cells] [number_of_cycles]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "benchmark_utils.h"
+#include "launch_vnr_resolution.h"
+#include "miegruneisen_params.h"
+
+/**
+ * @brief Number of placements compared
+ *
+ */
+#define NB_MODES 3
+
+/**
+ * @brief Number of arrays of the problem
+ *
+ */
+#define NB_ARRAYS 7
+
+/**
+ * @brief Print the NUMA nodes of the machine
+ *
+ */
+static void print_numa_nodes(void)
+{
+    char nodes[256] = "unknown";
+    FILE *online = fopen("/sys/devices/system/node/online", "r");
+    if (online)
+    {
+        if (fgets(nodes, sizeof(nodes), online) == NULL)
+            snprintf(nodes, sizeof(nodes), "unknown\n");
+        fclose(online);
+    }
+    printf("NUMA nodes online : %s", nodes);
+}
+
+/**
+ * @brief Time the solves of the mesh with the placement of the mode
+ *
+ * @param[in] mode : 0 the calling thread writes the arrays first, 1 the threads of the solver do,
+ *                   2 the threads of the solver are pinned then write the arrays first
+ * @param[in] pb_size : number of cells
+ * @param[in] nb_cycles : number of solves
+ * @param[out] elapsed : time per solve
+ * @return int : success (0) or failure (1)
+ */
+static int time_placement(const int mode, const unsigned int pb_size, const unsigned int nb_cycles, double *elapsed)
+{
+    const char *labels[NB_ARRAYS] = {"old_specific_volume", "new_specific_volume", "pressure", "internal_energy",
+                                     "solution", "new_p", "new_vson"};
+    VnrSolver_s *solver = build_vnr_solver(pb_size);
+    if (solver == NULL)
+        return EXIT_FAILURE;
+    int status = mode == 2 ? pin_vnr_solver_threads(solver, NULL) : EXIT_SUCCESS;
+    p_array arrays[NB_ARRAYS];
+    for (int a = 0; a < NB_ARRAYS; ++a)
+    {
+        arrays[a] = mode == 0 ? build_array(pb_size, labels[a]) : build_vnr_solver_array(solver, pb_size, labels[a]);
+    }
+    if (check_arrays_building(arrays, NB_ARRAYS) == EXIT_FAILURE)
+    {
+        cleanup_memory(arrays, NB_ARRAYS);
+        delete_vnr_solver(solver);
+        return EXIT_FAILURE;
+    }
+
+    // The pages have been first written by build_array, on the calling thread, in the mode 0
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        arrays[0]->data[i] = 1. / 8930.;
+        arrays[1]->data[i] = 1. / (8700. + 1500. * i / pb_size);
+    }
+    fill_array(arrays[2], 1.e+09);
+    fill_array(arrays[3], 1.e+04);
+    fill_array(arrays[4], 0.);
+    fill_array(arrays[5], 0.);
+    fill_array(arrays[6], 0.);
+
+    MieGruneisenParams_s copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    // The first solve maps the scratch memory of the threads, it is not timed
+    for (unsigned int cycle = 0; cycle <= nb_cycles && status == EXIT_SUCCESS; ++cycle)
+    {
+        const double start = get_wall_time();
+        status = launch_vnr_resolution_with_solver(solver, &copper_mat, arrays[0], arrays[1], arrays[2], arrays[3],
+                                                   arrays[4], arrays[5], arrays[6]);
+        if (cycle == 0)
+            *elapsed = 0.;
+        else
+            *elapsed += get_wall_time() - start;
+    }
+    *elapsed /= nb_cycles;
+
+    cleanup_memory(arrays, NB_ARRAYS);
+    delete_vnr_solver(solver);
+    return status;
+}
+
+/**
+ * @brief Launch the benchmark
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+    const unsigned int pb_size = get_positive_argument(argc, argv, 1, 20000000);
+    const unsigned int nb_cycles = get_positive_argument(argc, argv, 2, 20);
+    const char *names[NB_MODES] = {"calling thread", "solver threads", "pinned solver threads"};
+
+    print_numa_nodes();
+    printf("VNR equation (%u cells, %u cycles)\n", pb_size, nb_cycles);
+    printf("%22s | %14s\n", "first written by", "time/solve (s)");
+    int status = EXIT_SUCCESS;
+    for (int mode = 0; mode < NB_MODES && status == EXIT_SUCCESS; ++mode)
+    {
+        double elapsed = 0.;
+        status = time_placement(mode, pb_size, nb_cycles, &elapsed);
+        if (status == EXIT_SUCCESS)
+            printf("%22s | %14.6g\n", names[mode], elapsed);
+    }
+    printf("On a single NUMA node the three placements should give the same time.\n");
+    return status;
+}
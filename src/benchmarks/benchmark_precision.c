@@ -0,0 +1,183 @@
+/**
+ * @file benchmark_precision.c
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Compare the double, float and mixed precision fused kernels solving the VNR equation,
+ *        in time per solve and in accuracy relatively to the direct solve in double precision
+ * @version 0.1
+ * @date 2020-05-06
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Usage : benchmark_precision [number_of_cells] [number_of_repetitions]
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "array_float.h"
+#include "benchmark_utils.h"
+#include "miegruneisen.h"
+#include "miegruneisen_float.h"
+#include "miegruneisen_params.h"
+#include "newton.h"
+#include "vnr_internalenergy_evolution.h"
+#include "vnr_internalenergy_fused.h"
+
+/**
+ * @brief Number of solve modes compared
+ *
+ */
+#define NB_MODES 3
+
+/**
+ * @brief Compute the maximum and the mean of the relative errors of a solution
+ *
+ * @param[in] solution : the solution
+ * @param[in] reference : the reference solution
+ * @param[in] pb_size : size of the arrays
+ * @param[out] max_error : maximum relative error
+ * @param[out] mean_error : mean relative error
+ */
+static void compute_relative_errors(const double *solution, const double *reference, const unsigned int pb_size,
+                                    double *max_error, double *mean_error)
+{
+    *max_error = 0.;
+    *mean_error = 0.;
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        const double error = fabs(solution[i] - reference[i]) / fabs(reference[i]);
+        *max_error = fmax(*max_error, error);
+        *mean_error += error;
+    }
+    *mean_error /= pb_size;
+}
+
+/**
+ * @brief Launch the benchmark
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+    const unsigned int pb_size = get_positive_argument(argc, argv, 1, 1000000);
+    const unsigned int nb_repeats = get_positive_argument(argc, argv, 2, 20);
+
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(exact_solution, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                              exact_solution};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    BUILD_ARRAY_F(old_specific_volume_f, pb_size)
+    BUILD_ARRAY_F(new_specific_volume_f, pb_size)
+    BUILD_ARRAY_F(pressure_f, pb_size)
+    BUILD_ARRAY_F(internal_energy_f, pb_size)
+    BUILD_ARRAY_F(solution_f, pb_size)
+    p_array_f float_arrays[] = {old_specific_volume_f, new_specific_volume_f, pressure_f, internal_energy_f,
+                                solution_f};
+    const unsigned int nb_float_arrays = sizeof(float_arrays) / sizeof(p_array_f);
+    bool *has_converged = (bool *)malloc(pb_size * sizeof(bool));
+    float *float_buffer = (float *)malloc(VNR_MIXED_NB_FLOAT_ARRAYS * (size_t)pb_size * sizeof(float));
+    MieGruneisenFloatTerms_s *float_terms = build_miegruneisen_float_terms(pb_size);
+    MieGruneisenParams_s copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    MieGruneisenEOS_s copper_eos = {.params = &copper_mat, .is_affine_in_energy = true,
+                                    .get_pressure_and_derivative = compute_pressure_and_derivative, .init = init,
+                                    .finalize = finalize};
+
+    int status = check_arrays_building(built_arrays, nb_arrays);
+    for (unsigned int i = 0; i < nb_float_arrays; ++i)
+    {
+        if (float_arrays[i] == NULL)
+            status = EXIT_FAILURE;
+    }
+    if (has_converged == NULL || float_buffer == NULL || float_terms == NULL)
+        status = EXIT_FAILURE;
+
+    if (status == EXIT_SUCCESS)
+    {
+        // From expansion to strong compression
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            old_specific_volume->data[i] = 1. / 8930.;
+            new_specific_volume->data[i] = 1. / (8700. + 1500. * i / pb_size);
+        }
+        fill_array(pressure, 1.e+09);
+        fill_array(internal_energy, 1.e+04);
+        convert_array_to_float(old_specific_volume, old_specific_volume_f);
+        convert_array_to_float(new_specific_volume, new_specific_volume_f);
+        convert_array_to_float(pressure, pressure_f);
+        convert_array_to_float(internal_energy, internal_energy_f);
+        compute_miegruneisen_float_terms(&copper_mat, pb_size, new_specific_volume_f->data, float_terms);
+        status = copper_eos.init(&copper_eos, pb_size, new_specific_volume->data);
+    }
+    VnrParameters_s parameters = {old_specific_volume, new_specific_volume, internal_energy, pressure, &copper_eos,
+                                  NULL, NULL};
+    VnrParametersFloat_s float_parameters = {old_specific_volume_f, new_specific_volume_f, internal_energy_f,
+                                             pressure_f, float_terms};
+    if (status == EXIT_SUCCESS)
+        status = solve_internal_energy_evolution_VNR_direct(&parameters, exact_solution);
+
+    if (status == EXIT_SUCCESS)
+    {
+        const char *names[NB_MODES] = {"double", "float", "mixed"};
+        // Bytes read or written per cell and per sweep : 4 inputs, 3 terms of the eos and the unknown.
+        // The float sweeps of the mixed mode read the half variation of the specific volume instead of both volumes.
+        const char *bytes_per_cell[NB_MODES] = {"64", "32", "28 then 64"};
+        printf("VNR equation (%u cells, %u repetitions)\n", pb_size, nb_repeats);
+        printf("%8s | %14s | %10s | %11s | %18s | %18s\n", "mode", "time/solve (s)", "iterations", "bytes/sweep",
+               "max relative error", "mean relative error");
+        double reference_time = 0.;
+        for (int mode = 0; mode < NB_MODES; ++mode)
+        {
+            NewtonReport_s report;
+            double elapsed = 0.;
+            // The last repetition fills the report, which is not timed
+            for (unsigned int repeat = 0; repeat <= nb_repeats && status == EXIT_SUCCESS; ++repeat)
+            {
+                NewtonReport_s *const repeat_report = repeat == nb_repeats ? &report : NULL;
+                const double start = get_wall_time();
+                if (mode == 0)
+                    status = solve_internal_energy_evolution_VNR_fused(&parameters, internal_energy, solution,
+                                                                       has_converged, NULL, repeat_report);
+                else if (mode == 1)
+                    status = solve_internal_energy_evolution_VNR_float(&float_parameters, internal_energy_f,
+                                                                       solution_f, NULL, repeat_report);
+                else
+                    status = solve_internal_energy_evolution_VNR_mixed(&parameters, internal_energy, solution,
+                                                                       has_converged, float_buffer, NULL,
+                                                                       repeat_report);
+                if (repeat_report == NULL)
+                    elapsed += get_wall_time() - start;
+            }
+            if (mode == 1)
+                convert_array_to_double(solution_f, solution);
+            if (mode == 0)
+                reference_time = elapsed;
+            double max_error, mean_error;
+            compute_relative_errors(solution->data, exact_solution->data, pb_size, &max_error, &mean_error);
+            printf("%8s | %14.6g | %10d | %11s | %18.3g | %18.3g\n", names[mode], elapsed / nb_repeats,
+                   report.nb_iterations, bytes_per_cell[mode], max_error, mean_error);
+        }
+        printf("Time per solve of the double precision mode : %.6g s. The iterations of the mixed mode are the\n"
+               "double precision ones, done after its float sweeps. The MieGruneisen eos being affine in internal\n"
+               "energy, the first Newton step is exact : the mixed mode can not save any double precision sweep\n"
+               "and costs more than the double one. The float mode gives an accuracy of a few FLT_EPSILON, mostly\n"
+               "lost in the variation of the specific volume rounded to float.\n", reference_time / nb_repeats);
+    }
+
+    copper_eos.finalize(&copper_eos);
+    delete_miegruneisen_float_terms(float_terms);
+    free(float_buffer);
+    free(has_converged);
+    for (unsigned int i = 0; i < nb_float_arrays; ++i)
+    {
+        DELETE_ARRAY_F(float_arrays[i])
+    }
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file benchmark_schedule.c
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Compare the static and dynamic schedules of the VNR solver on a mesh crossed by a shock front :
+ *        only the cells behind the front are compressed, the ones ahead keep their state and converge
+ *        at the first iteration. The front lies in the chunk of the first thread of the static schedule.
+ *        Run it with OMP_NUM_THREADS set to the number of threads wanted.
+ * @version 0.1
+ * @date 2020-05-04
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Usage : benchmark_schedule [number_of_cells] [number_of_cycles] [block_size]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "benchmark_utils.h"
+#include "launch_vnr_resolution.h"
+#include "miegruneisen_params.h"
+
+/**
+ * @brief Number of configurations compared
+ *
+ */
+#define NB_CONFIGURATIONS 4
+
+/**
+ * @brief Launch the benchmark
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+    const unsigned int pb_size = get_positive_argument(argc, argv, 1, 1000000);
+    const unsigned int nb_cycles = get_positive_argument(argc, argv, 2, 20);
+    const unsigned int block_size = get_positive_argument(argc, argv, 3, VNR_DEFAULT_SCHEDULE_BLOCK_SIZE);
+
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(new_p, pb_size)
+    BUILD_ARRAY(new_vson, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution, new_p,
+                              new_vson};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    VnrSolver_s *solver = build_vnr_solver(pb_size);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE || solver == NULL)
+    {
+        delete_vnr_solver(solver);
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+
+    // The shocked cells are the first tenth of the mesh
+    const unsigned int front = pb_size / 10;
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        old_specific_volume->data[i] = 1. / 8930.;
+        new_specific_volume->data[i] = i < front ? 1. / (9500. + 500. * i / front) : old_specific_volume->data[i];
+    }
+    fill_array(pressure, 1.e+05);
+    fill_array(internal_energy, 1.e+04);
+
+    MieGruneisenParams_s copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    VnrSolverOptions_s *options = get_vnr_solver_options(solver);
+    // The Newton kernels iterate ; the eos terms are computed at each solve, whatever the thread solving the cells
+    options->use_direct_solve = false;
+    options->use_eos_cache = false;
+    options->schedule_block_size = block_size;
+    const char *names[NB_CONFIGURATIONS] = {"fused, static", "fused, dynamic", "safeguarded, static",
+                                            "safeguarded, dynamic"};
+    printf("VNR equation (%u cells, %u shocked, %u cycles, blocks of %u cells)\n", pb_size, front, nb_cycles,
+           block_size);
+    printf("%22s | %14s | %13s | %10s\n", "configuration", "time/solve (s)", "idle fraction", "sweeps");
+    int status = EXIT_SUCCESS;
+    for (int configuration = 0; configuration < NB_CONFIGURATIONS && status == EXIT_SUCCESS; ++configuration)
+    {
+        options->controls.safeguarded = configuration >= 2;
+        options->schedule = configuration % 2 == 0 ? VNR_STATIC_SCHEDULE : VNR_DYNAMIC_SCHEDULE;
+        double elapsed = 0.;
+        double idle_fraction = 0.;
+        for (unsigned int cycle = 0; cycle < nb_cycles && status == EXIT_SUCCESS; ++cycle)
+        {
+            const double start = get_wall_time();
+            status = launch_vnr_resolution_with_solver(solver, &copper_mat, old_specific_volume, new_specific_volume,
+                                                       pressure, internal_energy, solution, new_p, new_vson);
+            elapsed += get_wall_time() - start;
+            idle_fraction += get_vnr_solver_idle_fraction(solver);
+        }
+        printf("%22s | %14.6g | %13.3f | %10d\n", names[configuration], elapsed / nb_cycles,
+               idle_fraction / nb_cycles, get_vnr_solver_report(solver)->nb_iterations);
+    }
+    printf("The idle fraction is the share of the time of the threads spent waiting for the slowest one.\n"
+           "The sweeps are the maximum number of iterations over the batches of cells.\n");
+
+    delete_vnr_solver(solver);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
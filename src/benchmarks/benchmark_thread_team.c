@@ -0,0 +1,109 @@
+/**
+ * @file benchmark_thread_team.c
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Compare the fixed cost of a solve on small and medium meshes, at high cycle counts :
+ *        one-shot resolutions, solver context with an OpenMP parallel region per solve and
+ *        solver context with its persistent team of threads.
+ *        Run it with OMP_NUM_THREADS set to the number of threads wanted.
+ * @version 0.1
+ * @date 2020-05-04
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Usage : benchmark_thread_team [number_of_cycles]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "benchmark_utils.h"
+#include "launch_vnr_resolution.h"
+#include "miegruneisen_params.h"
+
+/**
+ * @brief Number of ways of solving compared
+ *
+ */
+#define NB_MODES 3
+
+/**
+ * @brief Time the cycles of one mesh size for each way of solving
+ *
+ * @param[in] pb_size : number of cells
+ * @param[in] nb_cycles : number of solves
+ * @return int : success (0) or failure (1)
+ */
+static int time_mesh(const unsigned int pb_size, const unsigned int nb_cycles)
+{
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(new_p, pb_size)
+    BUILD_ARRAY(new_vson, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution, new_p,
+                              new_vson};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    VnrSolver_s *solver = build_vnr_solver(pb_size);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE || solver == NULL)
+    {
+        delete_vnr_solver(solver);
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        old_specific_volume->data[i] = 1. / 8930.;
+        new_specific_volume->data[i] = 1. / (8700. + 1500. * i / pb_size);
+    }
+    fill_array(pressure, 1.e+09);
+    fill_array(internal_energy, 1.e+04);
+
+    MieGruneisenParams_s copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    VnrSolverOptions_s *options = get_vnr_solver_options(solver);
+    const char *names[NB_MODES] = {"one-shot", "OpenMP region", "thread team"};
+    int status = EXIT_SUCCESS;
+    for (int mode = 0; mode < NB_MODES && status == EXIT_SUCCESS; ++mode)
+    {
+        options->use_thread_team = mode == 2;
+        const double start = get_wall_time();
+        for (unsigned int cycle = 0; cycle < nb_cycles && status == EXIT_SUCCESS; ++cycle)
+        {
+            if (mode == 0)
+                status = launch_vnr_resolution(&copper_mat, old_specific_volume, new_specific_volume, pressure,
+                                               internal_energy, solution, new_p, new_vson);
+            else
+                status = launch_vnr_resolution_with_solver(solver, &copper_mat, old_specific_volume,
+                                                           new_specific_volume, pressure, internal_energy, solution,
+                                                           new_p, new_vson);
+        }
+        const double elapsed = get_wall_time() - start;
+        printf("%10u | %14s | %16.3f\n", pb_size, names[mode], 1.e+06 * elapsed / nb_cycles);
+    }
+
+    delete_vnr_solver(solver);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Launch the benchmark
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main(int argc, char *argv[])
+{
+    const unsigned int nb_cycles = get_positive_argument(argc, argv, 1, 2000);
+    const unsigned int mesh_sizes[] = {100, 1000, 10000, 100000};
+    const unsigned int nb_meshes = sizeof(mesh_sizes) / sizeof(unsigned int);
+
+    printf("%u cycles per mesh\n", nb_cycles);
+    printf("%10s | %14s | %16s\n", "cells", "threads", "time/solve (us)");
+    int status = EXIT_SUCCESS;
+    for (unsigned int m = 0; m < nb_meshes && status == EXIT_SUCCESS; ++m)
+    {
+        status = time_mesh(mesh_sizes[m], nb_cycles);
+    }
+    return status;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file benchmark_utils.h
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Utility functions shared by the benchmarks
+ * @version 0.1
+ * @date 2020-05-04
+ * 
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ * 
+ */
+#ifndef BENCHMARK_UTILS_H
+#define BENCHMARK_UTILS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Return the elapsed (wall clock) time in seconds since an arbitrary origin
+ * 
+ * @return double : the time in seconds
+ */
+static double get_wall_time(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + 1.e-09 * (double)now.tv_nsec;
+}
+
+/**
+ * @brief Read an optional positive integer from the command line
+ * 
+ * @param[in] argc : number of arguments
+ * @param[in] argv : arguments
+ * @param[in] position : position of the argument
+ * @param[in] default_value : value returned if the argument is missing or invalid
+ * @return unsigned int : the value of the argument
+ */
+static unsigned int get_positive_argument(int argc, char *argv[], const int position, const unsigned int default_value)
+{
+    if (argc <= position)
+        return default_value;
+    const long value = strtol(argv[position], NULL, 10);
+    if (value <= 0)
+    {
+        fprintf(stderr, "Invalid argument %s, %u is used instead!\n", argv[position], default_value);
+        return default_value;
+    }
+    return (unsigned int)value;
+}
+
+#endif
@@ -5,20 +5,55 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "array.h"
+#include "array_float.h"
+#include "simd_dispatch.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
+/**
+ * @brief Prototype of the kernels checking the convergence on raw arrays
+ *
+ */
+typedef bool (*relative_gap_kernel_fct_ptr)(const double *delta_x_k, const double *func,
+                                            const ConvergenceTolerances_s *tolerances, bool *has_converged,
+                                            const size_t size);
 
-bool relative_gap(p_array delta_x_k, p_array func, bool *has_converged)
-{
-    assert(is_valid_array(delta_x_k));
-    assert(is_valid_array(func));
-    assert(delta_x_k->size == func->size);
+/**
+ * @brief The kernel chosen according to the SIMD level of the processor
+ *
+ */
+static relative_gap_kernel_fct_ptr relative_gap_kernel;
+
+/**
+ * @brief Prototype of the single precision kernels checking the convergence with uniform tolerances
+ *
+ */
+typedef bool (*relative_gap_kernel_f_fct_ptr)(const float *delta_x_k, const float *func, const float epsilon,
+                                              const float precision, bool *has_converged, const size_t size);
+
+/**
+ * @brief The single precision kernel chosen according to the SIMD level of the processor
+ *
+ */
+static relative_gap_kernel_f_fct_ptr relative_gap_kernel_f;
 
-    const double epsilon = 1.0e-08;
-    const double precision = 1.0e-09;
+/*
+ * Scalar kernel. It also handles the remainders of the vectorized ones.
+ * The convergence markers never overlap the values read, hence the restrict qualifiers.
+ */
+static bool relative_gap_kernel_scalar(const double *restrict delta_x_k, const double *restrict func,
+                                       const ConvergenceTolerances_s *tolerances, bool *restrict has_converged,
+                                       const size_t size)
+{
+    const double *const epsilon_per_cell = tolerances->epsilon_per_cell;
+    const double *const precision_per_cell = tolerances->precision_per_cell;
     bool all_converged = true;
-    for (size_t i = 0; i < func->size; ++i)
+    for (size_t i = 0; i < size; ++i)
     {
-        if (fabs(func->data[i]) < epsilon * fabs(delta_x_k->data[i]) + precision)
+        const double epsilon = epsilon_per_cell ? epsilon_per_cell[i] : tolerances->epsilon;
+        const double precision = precision_per_cell ? precision_per_cell[i] : tolerances->precision;
+        if (fabs(func[i]) < epsilon * fabs(delta_x_k[i]) + precision)
         {
             // CONVERGENCE
             has_converged[i] = true;
@@ -32,3 +67,290 @@ bool relative_gap(p_array delta_x_k, p_array func, bool *has_converged)
 
     return all_converged;
 }
+
+/**
+ * @brief Single precision scalar kernel. The per cell tolerances, being stored in double precision,
+ *        are only handled by this kernel.
+ *
+ */
+static bool relative_gap_kernel_f_per_cell(const float *restrict delta_x_k, const float *restrict func,
+                                           const ConvergenceTolerances_s *tolerances, bool *restrict has_converged,
+                                           const size_t size)
+{
+    const double *const epsilon_per_cell = tolerances->epsilon_per_cell;
+    const double *const precision_per_cell = tolerances->precision_per_cell;
+    bool all_converged = true;
+    for (size_t i = 0; i < size; ++i)
+    {
+        const float epsilon = (float)(epsilon_per_cell ? epsilon_per_cell[i] : tolerances->epsilon);
+        const float precision = (float)(precision_per_cell ? precision_per_cell[i] : tolerances->precision);
+        if (fabsf(func[i]) < epsilon * fabsf(delta_x_k[i]) + precision)
+            has_converged[i] = true;
+        else
+            all_converged = false;
+    }
+    return all_converged;
+}
+
+static bool relative_gap_kernel_f_scalar(const float *restrict delta_x_k, const float *restrict func,
+                                         const float epsilon, const float precision, bool *restrict has_converged,
+                                         const size_t size)
+{
+    bool all_converged = true;
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (fabsf(func[i]) < epsilon * fabsf(delta_x_k[i]) + precision)
+            has_converged[i] = true;
+        else
+            all_converged = false;
+    }
+    return all_converged;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Check the convergence of the cells left over by a vectorized kernel
+ *
+ * @param[in] delta_x_k : increments of the whole array
+ * @param[in] func : values of the function of the whole array
+ * @param[in] tolerances : tolerances of the whole array
+ * @param[in, out] has_converged : convergence markers of the whole array
+ * @param[in] first : index of the first remaining cell
+ * @param[in] size : size of the whole array
+ * @return true : if every remaining cell has converged
+ * @return false : otherwise
+ */
+static bool relative_gap_on_remainder(const double *delta_x_k, const double *func,
+                                      const ConvergenceTolerances_s *tolerances, bool *has_converged,
+                                      const size_t first, const size_t size)
+{
+    ConvergenceTolerances_s remainder_tolerances = *tolerances;
+    if (tolerances->epsilon_per_cell)
+        remainder_tolerances.epsilon_per_cell += first;
+    if (tolerances->precision_per_cell)
+        remainder_tolerances.precision_per_cell += first;
+    return relative_gap_kernel_scalar(delta_x_k + first, func + first, &remainder_tolerances, has_converged + first,
+                                      size - first);
+}
+
+/**
+ * @brief Mark as converged the unknowns whose bit is set in the mask
+ *
+ * @param[in] mask : the convergence bits of the vector
+ * @param[in] width : number of unknowns in the vector
+ * @param[in, out] has_converged : convergence markers of the vector
+ */
+static inline void scatter_convergence_mask(const unsigned int mask, const unsigned int width, bool *has_converged)
+{
+    for (unsigned int k = 0; k < width; ++k)
+    {
+        has_converged[k] |= (mask >> k) & 1;
+    }
+}
+
+__attribute__((target("sse2"))) static bool relative_gap_kernel_sse2(const double *delta_x_k, const double *func,
+                                                                     const ConvergenceTolerances_s *tolerances,
+                                                                     bool *has_converged, const size_t size)
+{
+    const __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    const double *const epsilon_per_cell = tolerances->epsilon_per_cell;
+    const double *const precision_per_cell = tolerances->precision_per_cell;
+    const __m128d uniform_epsilon = _mm_set1_pd(tolerances->epsilon);
+    const __m128d uniform_precision = _mm_set1_pd(tolerances->precision);
+    unsigned int all_mask = 0x3;
+    size_t i = 0;
+    for (; i + 2 <= size; i += 2)
+    {
+        const __m128d abs_f = _mm_and_pd(_mm_loadu_pd(func + i), abs_mask);
+        const __m128d abs_dx = _mm_and_pd(_mm_loadu_pd(delta_x_k + i), abs_mask);
+        const __m128d epsilon = epsilon_per_cell ? _mm_loadu_pd(epsilon_per_cell + i) : uniform_epsilon;
+        const __m128d precision = precision_per_cell ? _mm_loadu_pd(precision_per_cell + i) : uniform_precision;
+        const __m128d threshold = _mm_add_pd(_mm_mul_pd(epsilon, abs_dx), precision);
+        const unsigned int mask = (unsigned int)_mm_movemask_pd(_mm_cmplt_pd(abs_f, threshold));
+        scatter_convergence_mask(mask, 2, has_converged + i);
+        all_mask &= mask;
+    }
+    const bool remainder_converged = relative_gap_on_remainder(delta_x_k, func, tolerances, has_converged, i, size);
+    return all_mask == 0x3 && remainder_converged;
+}
+
+__attribute__((target("avx2"))) static bool relative_gap_kernel_avx2(const double *delta_x_k, const double *func,
+                                                                     const ConvergenceTolerances_s *tolerances,
+                                                                     bool *has_converged, const size_t size)
+{
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    const double *const epsilon_per_cell = tolerances->epsilon_per_cell;
+    const double *const precision_per_cell = tolerances->precision_per_cell;
+    const __m256d uniform_epsilon = _mm256_set1_pd(tolerances->epsilon);
+    const __m256d uniform_precision = _mm256_set1_pd(tolerances->precision);
+    unsigned int all_mask = 0xF;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m256d abs_f = _mm256_and_pd(_mm256_loadu_pd(func + i), abs_mask);
+        const __m256d abs_dx = _mm256_and_pd(_mm256_loadu_pd(delta_x_k + i), abs_mask);
+        const __m256d epsilon = epsilon_per_cell ? _mm256_loadu_pd(epsilon_per_cell + i) : uniform_epsilon;
+        const __m256d precision = precision_per_cell ? _mm256_loadu_pd(precision_per_cell + i) : uniform_precision;
+        const __m256d threshold = _mm256_add_pd(_mm256_mul_pd(epsilon, abs_dx), precision);
+        const unsigned int mask = (unsigned int)_mm256_movemask_pd(_mm256_cmp_pd(abs_f, threshold, _CMP_LT_OQ));
+        scatter_convergence_mask(mask, 4, has_converged + i);
+        all_mask &= mask;
+    }
+    const bool remainder_converged = relative_gap_on_remainder(delta_x_k, func, tolerances, has_converged, i, size);
+    return all_mask == 0xF && remainder_converged;
+}
+
+__attribute__((target("avx512f"))) static bool relative_gap_kernel_avx512(const double *delta_x_k, const double *func,
+                                                                          const ConvergenceTolerances_s *tolerances,
+                                                                          bool *has_converged, const size_t size)
+{
+    const double *const epsilon_per_cell = tolerances->epsilon_per_cell;
+    const double *const precision_per_cell = tolerances->precision_per_cell;
+    const __m512d uniform_epsilon = _mm512_set1_pd(tolerances->epsilon);
+    const __m512d uniform_precision = _mm512_set1_pd(tolerances->precision);
+    unsigned int all_mask = 0xFF;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m512d abs_f = _mm512_abs_pd(_mm512_loadu_pd(func + i));
+        const __m512d abs_dx = _mm512_abs_pd(_mm512_loadu_pd(delta_x_k + i));
+        const __m512d epsilon = epsilon_per_cell ? _mm512_loadu_pd(epsilon_per_cell + i) : uniform_epsilon;
+        const __m512d precision = precision_per_cell ? _mm512_loadu_pd(precision_per_cell + i) : uniform_precision;
+        const __m512d threshold = _mm512_add_pd(_mm512_mul_pd(epsilon, abs_dx), precision);
+        const unsigned int mask = (unsigned int)_mm512_cmp_pd_mask(abs_f, threshold, _CMP_LT_OQ);
+        scatter_convergence_mask(mask, 8, has_converged + i);
+        all_mask &= mask;
+    }
+    const bool remainder_converged = relative_gap_on_remainder(delta_x_k, func, tolerances, has_converged, i, size);
+    return all_mask == 0xFF && remainder_converged;
+}
+
+/*
+ * Single precision kernels : twice as many values per vector as the double precision ones
+ */
+__attribute__((target("sse2"))) static bool relative_gap_kernel_f_sse2(const float *delta_x_k, const float *func,
+                                                                       const float epsilon, const float precision,
+                                                                       bool *has_converged, const size_t size)
+{
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 epsilon_vec = _mm_set1_ps(epsilon);
+    const __m128 precision_vec = _mm_set1_ps(precision);
+    unsigned int all_mask = 0xF;
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m128 abs_f = _mm_and_ps(_mm_loadu_ps(func + i), abs_mask);
+        const __m128 abs_dx = _mm_and_ps(_mm_loadu_ps(delta_x_k + i), abs_mask);
+        const __m128 threshold = _mm_add_ps(_mm_mul_ps(epsilon_vec, abs_dx), precision_vec);
+        const unsigned int mask = (unsigned int)_mm_movemask_ps(_mm_cmplt_ps(abs_f, threshold));
+        scatter_convergence_mask(mask, 4, has_converged + i);
+        all_mask &= mask;
+    }
+    const bool remainder_converged = relative_gap_kernel_f_scalar(delta_x_k + i, func + i, epsilon, precision,
+                                                                  has_converged + i, size - i);
+    return all_mask == 0xF && remainder_converged;
+}
+
+__attribute__((target("avx2"))) static bool relative_gap_kernel_f_avx2(const float *delta_x_k, const float *func,
+                                                                       const float epsilon, const float precision,
+                                                                       bool *has_converged, const size_t size)
+{
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 epsilon_vec = _mm256_set1_ps(epsilon);
+    const __m256 precision_vec = _mm256_set1_ps(precision);
+    unsigned int all_mask = 0xFF;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256 abs_f = _mm256_and_ps(_mm256_loadu_ps(func + i), abs_mask);
+        const __m256 abs_dx = _mm256_and_ps(_mm256_loadu_ps(delta_x_k + i), abs_mask);
+        const __m256 threshold = _mm256_add_ps(_mm256_mul_ps(epsilon_vec, abs_dx), precision_vec);
+        const unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(abs_f, threshold, _CMP_LT_OQ));
+        scatter_convergence_mask(mask, 8, has_converged + i);
+        all_mask &= mask;
+    }
+    const bool remainder_converged = relative_gap_kernel_f_scalar(delta_x_k + i, func + i, epsilon, precision,
+                                                                  has_converged + i, size - i);
+    return all_mask == 0xFF && remainder_converged;
+}
+
+__attribute__((target("avx512f"))) static bool relative_gap_kernel_f_avx512(const float *delta_x_k, const float *func,
+                                                                            const float epsilon, const float precision,
+                                                                            bool *has_converged, const size_t size)
+{
+    const __m512 epsilon_vec = _mm512_set1_ps(epsilon);
+    const __m512 precision_vec = _mm512_set1_ps(precision);
+    unsigned int all_mask = 0xFFFF;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m512 abs_f = _mm512_abs_ps(_mm512_loadu_ps(func + i));
+        const __m512 abs_dx = _mm512_abs_ps(_mm512_loadu_ps(delta_x_k + i));
+        const __m512 threshold = _mm512_add_ps(_mm512_mul_ps(epsilon_vec, abs_dx), precision_vec);
+        const unsigned int mask = (unsigned int)_mm512_cmp_ps_mask(abs_f, threshold, _CMP_LT_OQ);
+        scatter_convergence_mask(mask, 16, has_converged + i);
+        all_mask &= mask;
+    }
+    const bool remainder_converged = relative_gap_kernel_f_scalar(delta_x_k + i, func + i, epsilon, precision,
+                                                                  has_converged + i, size - i);
+    return all_mask == 0xFFFF && remainder_converged;
+}
+#endif
+
+/**
+ * @brief Choose the kernel according to the SIMD level, once, when the library is loaded
+ *
+ */
+__attribute__((constructor)) static void select_kernel(void)
+{
+    relative_gap_kernel = relative_gap_kernel_scalar;
+    relative_gap_kernel_f = relative_gap_kernel_f_scalar;
+#if defined(__x86_64__) || defined(__i386__)
+    switch (get_simd_level())
+    {
+    case SIMD_AVX512:
+        relative_gap_kernel = relative_gap_kernel_avx512;
+        relative_gap_kernel_f = relative_gap_kernel_f_avx512;
+        break;
+    case SIMD_AVX2:
+        relative_gap_kernel = relative_gap_kernel_avx2;
+        relative_gap_kernel_f = relative_gap_kernel_f_avx2;
+        break;
+    case SIMD_SSE2:
+        relative_gap_kernel = relative_gap_kernel_sse2;
+        relative_gap_kernel_f = relative_gap_kernel_f_sse2;
+        break;
+    default:
+        break;
+    }
+#endif
+}
+
+bool relative_gap(p_array delta_x_k, p_array func, const ConvergenceTolerances_s *tolerances, bool *has_converged)
+{
+    assert(is_valid_array(delta_x_k));
+    assert(is_valid_array(func));
+    assert(delta_x_k->size == func->size);
+
+    static const ConvergenceTolerances_s default_tolerances = RELATIVE_GAP_DEFAULT_TOLERANCES;
+    if (tolerances == NULL)
+        tolerances = &default_tolerances;
+
+    return relative_gap_kernel(delta_x_k->data, func->data, tolerances, has_converged, func->size);
+}
+
+bool relative_gap_f(p_array_f delta_x_k, p_array_f func, const ConvergenceTolerances_s *tolerances, bool *has_converged)
+{
+    assert(is_valid_array_f(delta_x_k));
+    assert(is_valid_array_f(func));
+    assert(delta_x_k->size == func->size);
+
+    static const ConvergenceTolerances_s default_tolerances = RELATIVE_GAP_DEFAULT_TOLERANCES;
+    if (tolerances == NULL)
+        tolerances = &default_tolerances;
+
+    if (tolerances->epsilon_per_cell || tolerances->precision_per_cell)
+        return relative_gap_kernel_f_per_cell(delta_x_k->data, func->data, tolerances, has_converged, func->size);
+    return relative_gap_kernel_f(delta_x_k->data, func->data, (float)tolerances->epsilon, (float)tolerances->precision,
+                                 has_converged, func->size);
+}
@@ -14,23 +14,78 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include "array.h"
+#include "array_float.h"
+
+/**
+ * @brief Relative part of the tolerance of the relative_gap criterion
+ * 
+ */
+#define RELATIVE_GAP_EPSILON 1.0e-08
+/**
+ * @brief Absolute part of the tolerance of the relative_gap criterion
+ * 
+ */
+#define RELATIVE_GAP_PRECISION 1.0e-09
+
+/**
+ * @brief The tolerances of the relative_gap criterion.
+ *        Uniform values are used unless per cell arrays are given.
+ * 
+ */
+typedef struct ConvergenceTolerances
+{
+    double epsilon;  /**< Relative part of the tolerance */
+    double precision;  /**< Absolute part of the tolerance */
+    const double *epsilon_per_cell;  /**< Relative part of the tolerance of each cell (optional, overrides epsilon) */
+    const double *precision_per_cell;  /**< Absolute part of the tolerance of each cell (optional, overrides precision) */
+} ConvergenceTolerances_s;
+
+/**
+ * @brief Initializer of the default tolerances of the relative_gap criterion
+ * 
+ */
+#define RELATIVE_GAP_DEFAULT_TOLERANCES {.epsilon = RELATIVE_GAP_EPSILON, .precision = RELATIVE_GAP_PRECISION}
 
 /**
  * @brief Check the convergence of the function
- * 		  The convergence is obtained if the value of the function is sufficiently close to zero.
+ * 		  The convergence is obtained if the value of the function is sufficiently close to zero :
+ * 		  \f$|f| < \epsilon |\Delta x| + precision\f$
+ * 
+ * @param[in] delta_x_k : array of the Newton's incrementation values 
+ * @param[in] func : array of the function values
+ * @param[in] tolerances : tolerances of the criterion (NULL for the default ones)
+ * @param[out] has_converged : array of boolean indicating the convergence of each item
+ * @return true : if convergence of all items is achieved 
+ * @return false : otherwise
+ */
+bool relative_gap(p_array delta_x_k, p_array func, const ConvergenceTolerances_s *tolerances, bool *has_converged);
+
+/**
+ * @brief Same as relative_gap in single precision : the tolerances are rounded to float.
+ *        They should thus be reachable in single precision, i.e the precision should be above
+ *        the rounding error of the function (a few FLT_EPSILON times its terms).
  * 
  * @param[in] delta_x_k : array of the Newton's incrementation values 
  * @param[in] func : array of the function values
+ * @param[in] tolerances : tolerances of the criterion (NULL for the default ones)
  * @param[out] has_converged : array of boolean indicating the convergence of each item
  * @return true : if convergence of all items is achieved 
  * @return false : otherwise
  */
-bool relative_gap(p_array delta_x_k, p_array func, bool *has_converged);
+bool relative_gap_f(p_array_f delta_x_k, p_array_f func, const ConvergenceTolerances_s *tolerances, bool *has_converged);
 
 /**
  * @brief The prototype of criterion checking function to be used with the Newton algorithm
  * 
  */
-typedef bool (*criterion_fct_ptr)(p_array delta_x_k, p_array func, bool *has_converged);
+typedef bool (*criterion_fct_ptr)(p_array delta_x_k, p_array func, const ConvergenceTolerances_s *tolerances,
+                                  bool *has_converged);
+
+/**
+ * @brief The prototype of the single precision criterion checking functions
+ * 
+ */
+typedef bool (*criterion_f_fct_ptr)(p_array_f delta_x_k, p_array_f func, const ConvergenceTolerances_s *tolerances,
+                                    bool *has_converged);
 
 #endif
\ No newline at end of file
@@ -1,9 +1,156 @@
+#include <string.h>
 #include "stop_criterions.h"
+#include "simd_dispatch.h"
 #include "test_utils.h"
 #include "array.h"
+#include "array_float.h"
 
 #define PB_SIZE 2
 
+/**
+ * @brief Size of the arrays used to test the vectorized kernels. It is not a multiple
+ *        of any vector width so that the remainders are exercised too.
+ */
+#define LARGE_PB_SIZE 1003
+
+/**
+ * @brief Check the relative gap criterion on an array large enough to use the vectorized
+ *        kernels of the current SIMD level. The results are compared to a scalar computation.
+ * 
+ * @return true : success
+ * @return false : failure
+ */
+static bool check_relative_gap_on_large_array()
+{
+    BUILD_ARRAY(delta_x_k, LARGE_PB_SIZE)
+    BUILD_ARRAY(func, LARGE_PB_SIZE)
+    if (delta_x_k == NULL || func == NULL)
+    {
+        fprintf(stderr, "Error during building of the large arrays\n");
+        DELETE_ARRAY(delta_x_k);
+        DELETE_ARRAY(func);
+        return false;
+    }
+
+    printf("SIMD level : %s\n", get_simd_level_name(get_simd_level()));
+
+    bool has_converged[LARGE_PB_SIZE];
+    bool expected_has_converged[LARGE_PB_SIZE];
+    // Every cell converges but one. Some cells are already marked as converged and must stay so.
+    for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+    {
+        delta_x_k->data[i] = (i % 2 == 0) ? 5. + i : -10. - i;
+        func->data[i] = (i % 3 == 0) ? -1.e-09 * i : 1.e-09 * i;
+        has_converged[i] = (i % 7 == 0);
+    }
+    func->data[LARGE_PB_SIZE / 2] = 1.;
+
+    // Per cell tolerances : the tolerance of one cell out of four is too tight to converge
+    double epsilon_per_cell[LARGE_PB_SIZE];
+    double precision_per_cell[LARGE_PB_SIZE];
+    for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+    {
+        epsilon_per_cell[i] = (i % 4 == 1) ? 0. : 2. * RELATIVE_GAP_EPSILON;
+        precision_per_cell[i] = (i % 4 == 1) ? 1.e-12 : RELATIVE_GAP_PRECISION;
+    }
+    const ConvergenceTolerances_s uniform_tolerances = RELATIVE_GAP_DEFAULT_TOLERANCES;
+    const ConvergenceTolerances_s cell_tolerances = {.epsilon_per_cell = epsilon_per_cell,
+                                                     .precision_per_cell = precision_per_cell};
+    const ConvergenceTolerances_s *tolerances_of_pass[] = {NULL, NULL, &cell_tolerances};
+
+    bool success = true;
+    for (unsigned int pass = 0; pass < 3; ++pass)
+    {
+        const ConvergenceTolerances_s *tolerances = tolerances_of_pass[pass] ? tolerances_of_pass[pass] : &uniform_tolerances;
+        bool expected_all_conv = true;
+        for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+        {
+            const double epsilon = tolerances->epsilon_per_cell ? tolerances->epsilon_per_cell[i] : tolerances->epsilon;
+            const double precision = tolerances->precision_per_cell ? tolerances->precision_per_cell[i] : tolerances->precision;
+            const bool converged = fabs(func->data[i]) < epsilon * fabs(delta_x_k->data[i]) + precision;
+            expected_has_converged[i] = has_converged[i] || converged;
+            expected_all_conv = expected_all_conv && converged;
+        }
+        const bool all_conv = relative_gap(delta_x_k, func, tolerances_of_pass[pass], has_converged);
+
+        success = assert_equal_bool_arrays(has_converged, expected_has_converged, LARGE_PB_SIZE, "has_converged") && success;
+        if (all_conv != expected_all_conv)
+        {
+            fprintf(stderr, "relative_gap returns %d instead of %d (pass %u)\n", all_conv, expected_all_conv, pass);
+            success = false;
+        }
+        // Second pass : every cell converges with the default tolerances
+        func->data[LARGE_PB_SIZE / 2] = 0.;
+        // Third pass : the markers are reset to check the per cell tolerances
+        if (pass == 1)
+            memset(has_converged, 0, sizeof(has_converged));
+    }
+
+    DELETE_ARRAY(delta_x_k);
+    DELETE_ARRAY(func);
+    return success;
+}
+
+/**
+ * @brief Check the single precision relative gap criterion on a large array, with uniform then
+ *        per cell tolerances. The results are compared to a scalar computation in single precision.
+ * 
+ * @return true : success
+ * @return false : failure
+ */
+static bool check_relative_gap_f_on_large_array()
+{
+    BUILD_ARRAY_F(delta_x_k, LARGE_PB_SIZE)
+    BUILD_ARRAY_F(func, LARGE_PB_SIZE)
+    if (delta_x_k == NULL || func == NULL)
+    {
+        fprintf(stderr, "Error during building of the large float arrays\n");
+        DELETE_ARRAY_F(delta_x_k);
+        DELETE_ARRAY_F(func);
+        return false;
+    }
+
+    bool has_converged[LARGE_PB_SIZE];
+    bool expected_has_converged[LARGE_PB_SIZE];
+    double precision_per_cell[LARGE_PB_SIZE];
+    for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+    {
+        delta_x_k->data[i] = (i % 2 == 0) ? 5.f + i : -10.f - i;
+        func->data[i] = (i % 3 == 0) ? -1.e-3f * i : 1.e-3f * i;
+        precision_per_cell[i] = (i % 4 == 1) ? 1.e-6 : 1.e-2;
+    }
+    // A precision above the float rounding of the function
+    const ConvergenceTolerances_s uniform_tolerances = {.epsilon = 1.e-4, .precision = 1.e-2};
+    const ConvergenceTolerances_s cell_tolerances = {.epsilon = 1.e-4, .precision_per_cell = precision_per_cell};
+    const ConvergenceTolerances_s *tolerances_of_pass[] = {&uniform_tolerances, &cell_tolerances};
+
+    bool success = true;
+    for (unsigned int pass = 0; pass < 2; ++pass)
+    {
+        const ConvergenceTolerances_s *tolerances = tolerances_of_pass[pass];
+        bool expected_all_conv = true;
+        memset(has_converged, 0, sizeof(has_converged));
+        for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+        {
+            const float precision = (float)(tolerances->precision_per_cell ? tolerances->precision_per_cell[i] : tolerances->precision);
+            expected_has_converged[i] = fabsf(func->data[i]) < (float)tolerances->epsilon * fabsf(delta_x_k->data[i]) + precision;
+            expected_all_conv = expected_all_conv && expected_has_converged[i];
+        }
+        const bool all_conv = relative_gap_f(delta_x_k, func, tolerances, has_converged);
+
+        success = assert_equal_bool_arrays(has_converged, expected_has_converged, LARGE_PB_SIZE, "has_converged_f") && success;
+        if (all_conv != expected_all_conv)
+        {
+            fprintf(stderr, "relative_gap_f returns %d instead of %d (pass %u)\n", all_conv, expected_all_conv, pass);
+            success = false;
+        }
+    }
+
+    DELETE_ARRAY_F(delta_x_k);
+    DELETE_ARRAY_F(func);
+    return success;
+}
+
 /**
  * @brief Launch the unit tests of the stop criterions 
  * 
@@ -37,7 +184,7 @@ int main()
     bool has_converged[PB_SIZE] = {false, false};
     bool expected_has_converged[PB_SIZE] = {false, true};
 
-    bool all_conv = relative_gap(delta_x_k, func, has_converged);
+    bool all_conv = relative_gap(delta_x_k, func, NULL, has_converged);
 
     bool success = true;
     
@@ -49,6 +196,14 @@ int main()
     {
         success = false;
     }
+    if (!check_relative_gap_on_large_array())
+    {
+        success = false;
+    }
+    if (!check_relative_gap_f_on_large_array())
+    {
+        success = false;
+    }
 
     if (!success)
         return (EXIT_FAILURE);
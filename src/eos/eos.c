@@ -0,0 +1,38 @@
+#include "eos.h"
+#include <stdio.h>
+#include "stiffened_gas.h"
+
+int set_eos_params(MieGruneisenEOS_s *eos, const EosParams_s *params)
+{
+    eos->type = params->type;
+    eos->is_affine_in_energy = true;
+    eos->get_pressure_and_derivative = compute_pressure_and_derivative;
+    eos->get_pressure_and_derivative_on_subset = compute_pressure_and_derivative_on_subset;
+    eos->get_pressure_and_derivatives = compute_pressure_and_derivatives;
+    eos->finalize = finalize;
+    switch (params->type)
+    {
+    case MIEGRUNEISEN_EOS:
+        eos->params = &params->miegruneisen;
+        eos->get_pressure_and_sound_speed = compute_pressure_and_sound_speed;
+        eos->init = init;
+        return EXIT_SUCCESS;
+    case IDEAL_GAS_EOS:
+    case STIFFENED_GAS_EOS:
+        if (!(params->gas.gamma > 1.))
+        {
+            fprintf(stderr, "The adiabatic index of the gas should be above 1 (%g)!\n", params->gas.gamma);
+            return EXIT_FAILURE;
+        }
+        eos->params = NULL;
+        eos->gas_params = params->gas;
+        if (params->type == IDEAL_GAS_EOS)
+            eos->gas_params.p_inf = 0.;
+        eos->get_pressure_and_sound_speed = compute_stiffened_gas_pressure_and_sound_speed;
+        eos->init = init_stiffened_gas;
+        return EXIT_SUCCESS;
+    default:
+        fprintf(stderr, "Unknown type of equation of state (%d)!\n", params->type);
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef EOS_H
+#define EOS_H
+/**
+ * @file eos.h
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Selection of the functions of the equation of state of a material
+ * @version 0.1
+ * @date 2020-05-06
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ */
+#include "eos_params.h"
+#include "miegruneisen.h"
+
+/**
+ * @brief Set the parameters of the eos and the functions (init and get_pressure_and_sound_speed)
+ *        matching its type. The other functions are the MieGruneisen ones, shared by every type.
+ *        The arrays and the cache of the eos are kept, so that the same eos may be used successively
+ *        for several materials. The parameters should outlive the use of the eos.
+ *
+ * @param[in,out] eos : the equation of state
+ * @param[in] params : parameters of the equation of state of the material
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : if the type is unknown or the parameters are invalid
+ */
+int set_eos_params(MieGruneisenEOS_s *eos, const EosParams_s *params);
+
+#endif
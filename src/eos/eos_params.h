@@ -0,0 +1,46 @@
+#ifndef EOS_PARAMS_H
+#define EOS_PARAMS_H
+/**
+ * @file eos_params.h
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Holds the parameters of the equations of state available for a material
+ * @version 0.1
+ * @date 2020-05-06
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ */
+#include "miegruneisen_params.h"
+
+/**
+ * @brief Equations of state available
+ *
+ */
+typedef enum EosType
+{
+    MIEGRUNEISEN_EOS,  /**< MieGruneisen eos (see miegruneisen.h) */
+    IDEAL_GAS_EOS,  /**< Ideal gas : \f$p = (\gamma - 1) \rho e\f$ */
+    STIFFENED_GAS_EOS  /**< Stiffened gas : \f$p = (\gamma - 1) \rho e - \gamma p_\infty\f$ */
+} EosType_e;
+
+/**
+ * @brief Holds the ideal and stiffened gas equations of state parameters
+ *
+ */
+typedef struct StiffenedGasParams {
+    double gamma;  /**< Adiabatic index (above 1) */
+    double p_inf;  /**< Stiffening pressure (ignored for the ideal gas) */
+} StiffenedGasParams_s;
+
+/**
+ * @brief Holds the parameters of the equation of state of a material.
+ *        Only the parameters of its type are used.
+ *
+ */
+typedef struct EosParams {
+    EosType_e type;  /**< Type of the equation of state */
+    MieGruneisenParams_s miegruneisen;  /**< Parameters of the MieGruneisen eos */
+    StiffenedGasParams_s gas;  /**< Parameters of the ideal and stiffened gas eos */
+} EosParams_s;
+
+#endif
@@ -1,7 +1,10 @@
 #include "miegruneisen.h"
+#include "array.h"
+#include "stiffened_gas.h"
 #include <math.h>
-#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 /**
  * @brief Compute the compression ($\dfrac{\rho - \rho_0}{\rho}$)
@@ -46,11 +49,62 @@ static inline double compute_denom(const double s1, const double s2, const doubl
     return 1. / (1. - (s1 + s2 * epsv + s3 * epsv * epsv) * epsv);
 }
 
-int init(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * const specific_volume)
+unsigned long get_miegruneisen_terms_stride(const unsigned int nb_cells)
+{
+    const unsigned long doubles_per_line = MIEGRUNEISEN_ALIGNMENT / sizeof(double);
+    const unsigned long doubles_per_page = 4096 / sizeof(double);
+    unsigned long stride = (nb_cells + doubles_per_line - 1) / doubles_per_line * doubles_per_line;
+    if (stride % doubles_per_page == 0)
+        stride += doubles_per_line;
+    return stride;
+}
+
+#ifdef MIEGRUNEISEN_ALIGNED_SOA
+/**
+ * @brief Allocate the block of the five per cell terms of the eos and point the terms inside it
+ *
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : number of cells
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+static int allocate_miegruneisen_terms(MieGruneisenEOS_s *eos, const unsigned int nb_cells)
+{
+    if (eos->terms_block != NULL)
+        return EXIT_SUCCESS;
+    // Not zeroed, so that the first touch of the pages is left to init, which computes every term before it is read.
+    // A large block is backed by huge pages if they are enabled (see array.h)
+    const unsigned long stride = get_miegruneisen_terms_stride(nb_cells);
+    eos->terms_block = (double *)allocate_array_memory(5 * stride * sizeof(double) + MIEGRUNEISEN_ALIGNMENT);
+    if (eos->terms_block == NULL)
+    {
+        fprintf(stderr, "Error during allocation of the eos terms block (size requested : %u)!\n", nb_cells);
+        return EXIT_FAILURE;
+    }
+    const uintptr_t misalignment = (uintptr_t)eos->terms_block % MIEGRUNEISEN_ALIGNMENT;
+    double *const first_term = (double *)((char *)eos->terms_block + (MIEGRUNEISEN_ALIGNMENT - misalignment) %
+                                                                     MIEGRUNEISEN_ALIGNMENT);
+    eos->phi = first_term;
+    eos->dphi = first_term + stride;
+    eos->einth = first_term + 2 * stride;
+    eos->deinth = first_term + 3 * stride;
+    eos->gamma_per_vol = first_term + 4 * stride;
+    return EXIT_SUCCESS;
+}
+#else
+/**
+ * @brief Allocate the five per cell terms of the eos that are still NULL as separate arrays
+ *
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : number of cells
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+static int allocate_miegruneisen_terms(MieGruneisenEOS_s *eos, const unsigned int nb_cells)
 {
     if (eos->phi == NULL)
     {
-        eos->phi = (double *)calloc(nb_cells, sizeof(double));
+        eos->phi = (double *)allocate_array_memory(nb_cells * sizeof(double));
         if (eos->phi == NULL)
         {
             fprintf(stderr, "Error during allocation of eos->phi array (size requested : %u)!\n", nb_cells);
@@ -59,7 +113,7 @@ int init(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * con
     }
     if (eos->dphi == NULL)
     {
-        eos->dphi = (double *)calloc(nb_cells, sizeof(double));
+        eos->dphi = (double *)allocate_array_memory(nb_cells * sizeof(double));
         if (eos->dphi == NULL)
         {
             fprintf(stderr, "Error during allocation of eos->dphi array (size requested : %u)!\n", nb_cells);
@@ -68,7 +122,7 @@ int init(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * con
     }
     if (eos->einth == NULL)
     {
-        eos->einth = (double *)calloc(nb_cells, sizeof(double));
+        eos->einth = (double *)allocate_array_memory(nb_cells * sizeof(double));
         if (eos->einth == NULL)
         {
             fprintf(stderr, "Error during allocation of eos->einth array (size requested : %u)!\n", nb_cells);
@@ -77,7 +131,7 @@ int init(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * con
     }
     if (eos->deinth == NULL)
     {
-        eos->deinth = (double *)calloc(nb_cells, sizeof(double));
+        eos->deinth = (double *)allocate_array_memory(nb_cells * sizeof(double));
         if (eos->deinth == NULL)
         {
             fprintf(stderr, "Error during allocation of eos->deinth array (size requested : %u)!\n", nb_cells);
@@ -86,55 +140,237 @@ int init(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * con
     }
     if (eos->gamma_per_vol == NULL)
     {
-        eos->gamma_per_vol = (double *)calloc(nb_cells, sizeof(double));
+        eos->gamma_per_vol = (double *)allocate_array_memory(nb_cells * sizeof(double));
         if (eos->gamma_per_vol == NULL)
         {
             fprintf(stderr, "Error during allocation of eos->gamma_per_vol array (size requested : %u)!\n", nb_cells);
             return EXIT_FAILURE;
         }
     }
+    return EXIT_SUCCESS;
+}
+#endif
+
+int allocate_miegruneisen_arrays(MieGruneisenEOS_s *eos, const unsigned int nb_cells)
+{
+    if (allocate_miegruneisen_terms(eos, nb_cells) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if (eos->invalid_sound_speed == NULL)
+    {
+        eos->invalid_sound_speed = (bool *)calloc(nb_cells, sizeof(bool));
+        if (eos->invalid_sound_speed == NULL)
+        {
+            fprintf(stderr, "Error during allocation of eos->invalid_sound_speed array (size requested : %u)!\n", nb_cells);
+            return EXIT_FAILURE;
+        }
+    }
+    if (eos->cached_specific_volume == NULL)
+    {
+        eos->cached_specific_volume = (double *)calloc(nb_cells, sizeof(double));
+        if (eos->cached_specific_volume == NULL)
+        {
+            fprintf(stderr, "Error during allocation of eos->cached_specific_volume array (size requested : %u)!\n", nb_cells);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
 
-    const double s1 = eos->params->s1;
-    const double s2 = eos->params->s2;
-    const double s3 = eos->params->s3;
-    const double rho_zero = eos->params->rho_zero;
-    const double gamma_zero = eos->params->gamma_zero;
-    const double coeff_b = eos->params->coeff_b;
-    const double e_zero = eos->params->e_zero;
-    const double c_zero_2 = eos->params->c_zero * eos->params->c_zero;
+void compute_miegruneisen_terms(const MieGruneisenParams_s *params, const unsigned int nb_cells,
+                                const double *specific_volume, double *phi, double *dphi, double *einth,
+                                double *deinth, double *gamma_per_vol)
+{
+    const double s1 = params->s1;
+    const double s2 = params->s2;
+    const double s3 = params->s3;
+    const double rho_zero = params->rho_zero;
+    const double gamma_zero = params->gamma_zero;
+    const double coeff_b = params->coeff_b;
+    const double e_zero = params->e_zero;
+    const double c_zero_2 = params->c_zero * params->c_zero;
     const double rho_czero2 = rho_zero * c_zero_2;
     const double inv_rhozero_x2 = 1. / (2.* rho_zero); 
     for (unsigned int i = 0; i < nb_cells; ++i)
     {
         const double epsv = compute_epsv(rho_zero, specific_volume[i]);
-        eos->gamma_per_vol[i] = compute_dp_de(gamma_zero, coeff_b, epsv, specific_volume[i]);
+        gamma_per_vol[i] = compute_dp_de(gamma_zero, coeff_b, epsv, specific_volume[i]);
         if (epsv > 0)
         {
             const double denom = compute_denom(s1, s2, s3, epsv);
-            const double phi = rho_czero2 * epsv * denom * denom;
-            eos->phi[i] = phi;
-            eos->einth[i] = e_zero + phi * epsv * inv_rhozero_x2;
+            const double phi_i = rho_czero2 * epsv * denom * denom;
+            phi[i] = phi_i;
+            einth[i] = e_zero + phi_i * epsv * inv_rhozero_x2;
             const double redond_a = (s1 + 2. * s2 * epsv + 3. * s3 * epsv * epsv);
-            eos->dphi[i] = phi * rho_zero * (-1. / epsv - 2. * redond_a * denom);
-            eos->deinth[i] = phi * (-1. - epsv * redond_a * denom);
+            dphi[i] = phi_i * rho_zero * (-1. / epsv - 2. * redond_a * denom);
+            deinth[i] = phi_i * (-1. - epsv * redond_a * denom);
         }
         else
         {
-            eos->phi[i] = rho_czero2 * epsv / (1. - epsv);
-            eos->einth[i] = e_zero;
-            eos->dphi[i] = -c_zero_2 / (specific_volume[i] * specific_volume[i]);
+            phi[i] = rho_czero2 * epsv / (1. - epsv);
+            einth[i] = e_zero;
+            dphi[i] = -c_zero_2 / (specific_volume[i] * specific_volume[i]);
+            deinth[i] = 0.;
         }
     }
+}
+
+/**
+ * @brief Compute all that depends only on the specific volume for the cells in [first, last[,
+ *        analytically or by interpolation in the table of the eos if any
+ * 
+ * @param[in] eos : the equation of state (its arrays should have been allocated)
+ * @param[in] first : index of the first cell
+ * @param[in] last : index following the one of the last cell
+ * @param[in] specific_volume : specific volume
+ */
+static void compute_hugoniot_terms(MieGruneisenEOS_s *eos, const unsigned int first, const unsigned int last,
+                                   const double * const specific_volume)
+{
+    if (eos->type != MIEGRUNEISEN_EOS)
+    {
+        compute_stiffened_gas_terms(&eos->gas_params, last - first, specific_volume + first, eos->phi + first,
+                                    eos->dphi + first, eos->einth + first, eos->deinth + first,
+                                    eos->gamma_per_vol + first);
+    }
+    else if (eos->table)
+    {
+        interpolate_miegruneisen_table(eos->table, last - first, specific_volume + first, eos->phi + first,
+                                       eos->dphi + first, eos->einth + first, eos->deinth + first,
+                                       eos->gamma_per_vol + first);
+    }
+    else
+    {
+        compute_miegruneisen_terms(eos->params, last - first, specific_volume + first, eos->phi + first,
+                                   eos->dphi + first, eos->einth + first, eos->deinth + first,
+                                   eos->gamma_per_vol + first);
+    }
+}
+
+int init(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * const specific_volume)
+{
+    if (allocate_miegruneisen_arrays(eos, nb_cells) == EXIT_FAILURE)
+    {
+        return EXIT_FAILURE;
+    }
+    eos->nb_cached_cells = 0;
+    compute_miegruneisen_terms(eos->params, nb_cells, specific_volume, eos->phi, eos->dphi, eos->einth, eos->deinth,
+                               eos->gamma_per_vol);
+    return EXIT_SUCCESS;
+}
+
+int init_from_table(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * const specific_volume)
+{
+    if (eos->table == NULL)
+    {
+        fprintf(stderr, "The MieGruneisen eos has no table to interpolate!\n");
+        return EXIT_FAILURE;
+    }
+    if (allocate_miegruneisen_arrays(eos, nb_cells) == EXIT_FAILURE)
+    {
+        return EXIT_FAILURE;
+    }
+    eos->nb_cached_cells = 0;
+    interpolate_miegruneisen_table(eos->table, nb_cells, specific_volume, eos->phi, eos->dphi, eos->einth, eos->deinth,
+                                   eos->gamma_per_vol);
+    return EXIT_SUCCESS;
+}
+
+int update_miegruneisen_terms(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * const specific_volume,
+                              unsigned int *nb_updated_cells)
+{
+    if (allocate_miegruneisen_arrays(eos, nb_cells) == EXIT_FAILURE)
+    {
+        return EXIT_FAILURE;
+    }
+
+    const bool same_params = eos->type == MIEGRUNEISEN_EOS ?
+                             memcmp(&eos->cached_params, eos->params, sizeof(MieGruneisenParams_s)) == 0 &&
+                             eos->cached_table == eos->table :
+                             memcmp(&eos->cached_gas_params, &eos->gas_params, sizeof(StiffenedGasParams_s)) == 0;
+    const bool is_cache_valid = eos->nb_cached_cells == nb_cells && eos->cached_type == eos->type && same_params;
+    unsigned int nb_updated = 0;
+    for (unsigned int first = 0; first < nb_cells; first += MIEGRUNEISEN_CACHE_BLOCK_SIZE)
+    {
+        const unsigned int last = nb_cells - first > MIEGRUNEISEN_CACHE_BLOCK_SIZE ? first + MIEGRUNEISEN_CACHE_BLOCK_SIZE : nb_cells;
+        const size_t block_bytes = (last - first) * sizeof(double);
+        if (is_cache_valid && memcmp(eos->cached_specific_volume + first, specific_volume + first, block_bytes) == 0)
+            continue;
+        compute_hugoniot_terms(eos, first, last, specific_volume);
+        memcpy(eos->cached_specific_volume + first, specific_volume + first, block_bytes);
+        nb_updated += last - first;
+    }
+    eos->nb_cached_cells = nb_cells;
+    eos->cached_type = eos->type;
+    if (eos->type == MIEGRUNEISEN_EOS)
+    {
+        eos->cached_params = *eos->params;
+        eos->cached_table = eos->table;
+    }
+    else
+    {
+        eos->cached_gas_params = eos->gas_params;
+    }
+
+    if (nb_updated_cells)
+        *nb_updated_cells = nb_updated;
     return EXIT_SUCCESS;
 }
 
 void finalize(MieGruneisenEOS_s *eos)
 {
-    free(eos->gamma_per_vol);
-    free(eos->phi);
-    free(eos->dphi);
-    free(eos->einth);
-    free(eos->deinth);
+#ifdef MIEGRUNEISEN_ALIGNED_SOA
+    free_array_data(eos->terms_block);
+#else
+    free_array_data(eos->gamma_per_vol);
+    free_array_data(eos->phi);
+    free_array_data(eos->dphi);
+    free_array_data(eos->einth);
+    free_array_data(eos->deinth);
+#endif
+    free(eos->invalid_sound_speed);
+    free(eos->cached_specific_volume);
+}
+
+MieGruneisenTermsView_s get_miegruneisen_terms_view(const MieGruneisenEOS_s *eos, const unsigned int nb_cells)
+{
+    const MieGruneisenTermsView_s view = {nb_cells, eos->phi, eos->dphi, eos->einth, eos->deinth, eos->gamma_per_vol};
+    return view;
+}
+
+/**
+ * @brief Tells the compiler that an array given by the caller is aligned on MIEGRUNEISEN_ALIGNMENT bytes
+ *
+ */
+#define CALLER_ASSUME_ALIGNED(ptr) __builtin_assume_aligned((ptr), MIEGRUNEISEN_ALIGNMENT)
+
+/**
+ * @brief Check if the pointer is aligned on MIEGRUNEISEN_ALIGNMENT bytes
+ *
+ * @param[in] ptr : the pointer
+ * @return true : if the pointer is aligned
+ * @return false : otherwise
+ */
+static inline bool is_aligned(const void *ptr)
+{
+    return (uintptr_t)ptr % MIEGRUNEISEN_ALIGNMENT == 0;
+}
+
+/**
+ * @brief Loop of compute_pressure_and_derivative (the outputs do not overlap the inputs), inlined
+ *        in an aligned and an unaligned version
+ *
+ */
+__attribute__((always_inline))
+static inline void pressure_and_derivative_loop(const int nb_cells, const double *restrict phi,
+                                                const double *restrict einth, const double *restrict eos_gamma_per_vol,
+                                                const double *restrict internal_energy, double *restrict pressure,
+                                                double *restrict gamma_per_vol)
+{
+    for (int i = 0; i < nb_cells; ++i)
+    {
+        gamma_per_vol[i] = eos_gamma_per_vol[i];
+        pressure[i] = phi[i] + eos_gamma_per_vol[i] * (internal_energy[i] - einth[i]);
+    }
 }
 
 void compute_pressure_and_derivative(MieGruneisenEOS_s *eos, const int nb_cells,
@@ -142,32 +378,96 @@ void compute_pressure_and_derivative(MieGruneisenEOS_s *eos, const int nb_cells,
                                      const double *internal_energy, double *pressure,
                                      double *gamma_per_vol)
 {
+    const double *phi = MIEGRUNEISEN_ASSUME_ALIGNED(eos->phi);
+    const double *einth = MIEGRUNEISEN_ASSUME_ALIGNED(eos->einth);
+    const double *eos_gamma_per_vol = MIEGRUNEISEN_ASSUME_ALIGNED(eos->gamma_per_vol);
+    if (is_aligned(internal_energy) && is_aligned(pressure) && is_aligned(gamma_per_vol))
+        pressure_and_derivative_loop(nb_cells, phi, einth, eos_gamma_per_vol, CALLER_ASSUME_ALIGNED(internal_energy),
+                                     CALLER_ASSUME_ALIGNED(pressure), CALLER_ASSUME_ALIGNED(gamma_per_vol));
+    else
+        pressure_and_derivative_loop(nb_cells, phi, einth, eos_gamma_per_vol, internal_energy, pressure,
+                                     gamma_per_vol);
+}
+
+void compute_pressure_and_derivatives(MieGruneisenEOS_s *eos, const int nb_cells,
+                                      const double *specific_volume,
+                                      const double *internal_energy, double *pressure,
+                                      double *gamma_per_vol, double *d2p_de2)
+{
+    compute_pressure_and_derivative(eos, nb_cells, specific_volume, internal_energy, pressure, gamma_per_vol);
     for (int i = 0; i < nb_cells; ++i)
     {
-        gamma_per_vol[i] = eos->gamma_per_vol[i];
-        pressure[i] = eos->phi[i] + eos->gamma_per_vol[i] * (internal_energy[i] - eos->einth[i]);
+        d2p_de2[i] = 0.;
     }
 }
 
-void compute_pressure_and_sound_speed(MieGruneisenEOS_s *eos, const int nb_cells,
-                                      const double *specific_volume,
-                                      const double *internal_energy, double *pressure, double *c_son)
+void compute_pressure_and_derivative_on_subset(MieGruneisenEOS_s *eos, const unsigned int *indices,
+                                               const unsigned int nb_indices, const double *internal_energy,
+                                               double *pressure, double *gamma_per_vol)
 {
-    const double dgam = eos->params->rho_zero * (eos->params->gamma_zero - eos->params->coeff_b);
+    for (unsigned int j = 0; j < nb_indices; ++j)
+    {
+        const unsigned int i = indices[j];
+        gamma_per_vol[j] = eos->gamma_per_vol[i];
+        pressure[j] = eos->phi[i] + eos->gamma_per_vol[i] * (internal_energy[i] - eos->einth[i]);
+    }
+}
+
+/**
+ * @brief Branch-free loop of compute_pressure_and_sound_speed (the outputs do not overlap the inputs),
+ *        inlined in an aligned and an unaligned version
+ * 
+ * @return unsigned int : number of cells which squared sound speed is negative
+ */
+__attribute__((always_inline))
+static inline unsigned int sound_speed_loop(const int nb_cells, const double dgam, const double *restrict phi,
+                                            const double *restrict dphi, const double *restrict einth,
+                                            const double *restrict deinth, const double *restrict gamma_per_vol,
+                                            const double *restrict specific_volume, const double *restrict internal_energy,
+                                            double *restrict pressure, double *restrict c_son,
+                                            bool *restrict invalid_sound_speed)
+{
+    unsigned int nb_invalid = 0;
     for (int i = 0; i < nb_cells; ++i)
     {
-        pressure[i] = eos->phi[i] + eos->gamma_per_vol[i] * (internal_energy[i] - eos->einth[i]);
-        double dpdv = eos->dphi[i] + (dgam - eos->gamma_per_vol[i]) * (internal_energy[i] - eos->einth[i]) / specific_volume[i] - eos->gamma_per_vol[i] * eos->deinth[i];
-        double vson_2 = specific_volume[i] * specific_volume[i] * (pressure[i] * eos->gamma_per_vol[i] - dpdv);
-        if (vson_2 < 0)
-        {
-            printf("Carré de la vitesse du son < 0\n");
-            printf("specific_volume[%d] = %15.9g\n", i, specific_volume[i]);
-            printf("pressure[%d] = %15.9g\n", i, pressure[i]);
-            printf("dpsurde[%d] = %15.9g\n", i, eos->gamma_per_vol[i]);
-            printf("dpdv[%d] = %15.9g\n", i, dpdv);
-            raise(SIGABRT);
-        }
+        const double p = phi[i] + gamma_per_vol[i] * (internal_energy[i] - einth[i]);
+        const double dpdv = dphi[i] + (dgam - gamma_per_vol[i]) * (internal_energy[i] - einth[i]) / specific_volume[i] - gamma_per_vol[i] * deinth[i];
+        const double vson_2 = specific_volume[i] * specific_volume[i] * (p * gamma_per_vol[i] - dpdv);
+        pressure[i] = p;
+        // NaN for the invalid cells
         c_son[i] = sqrt(vson_2);
+        invalid_sound_speed[i] = vson_2 < 0.;
+        nb_invalid += vson_2 < 0.;
+    }
+    return nb_invalid;
+}
+
+unsigned int compute_pressure_and_sound_speed(MieGruneisenEOS_s *eos, const int nb_cells,
+                                              const double *specific_volume,
+                                              const double *internal_energy, double *pressure, double *c_son)
+{
+    const double dgam = eos->params->rho_zero * (eos->params->gamma_zero - eos->params->coeff_b);
+    if (is_aligned(specific_volume) && is_aligned(internal_energy) && is_aligned(pressure) && is_aligned(c_son))
+        return sound_speed_loop(nb_cells, dgam, MIEGRUNEISEN_ASSUME_ALIGNED(eos->phi),
+                                MIEGRUNEISEN_ASSUME_ALIGNED(eos->dphi), MIEGRUNEISEN_ASSUME_ALIGNED(eos->einth),
+                                MIEGRUNEISEN_ASSUME_ALIGNED(eos->deinth), MIEGRUNEISEN_ASSUME_ALIGNED(eos->gamma_per_vol),
+                                CALLER_ASSUME_ALIGNED(specific_volume), CALLER_ASSUME_ALIGNED(internal_energy),
+                                CALLER_ASSUME_ALIGNED(pressure), CALLER_ASSUME_ALIGNED(c_son),
+                                eos->invalid_sound_speed);
+    return sound_speed_loop(nb_cells, dgam, MIEGRUNEISEN_ASSUME_ALIGNED(eos->phi), MIEGRUNEISEN_ASSUME_ALIGNED(eos->dphi),
+                            MIEGRUNEISEN_ASSUME_ALIGNED(eos->einth), MIEGRUNEISEN_ASSUME_ALIGNED(eos->deinth),
+                            MIEGRUNEISEN_ASSUME_ALIGNED(eos->gamma_per_vol), specific_volume, internal_energy,
+                            pressure, c_son, eos->invalid_sound_speed);
+}
+
+unsigned int list_invalid_sound_speeds(const MieGruneisenEOS_s *eos, const unsigned int nb_cells,
+                                       unsigned int *invalid_cells)
+{
+    unsigned int nb_invalid = 0;
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        if (eos->invalid_sound_speed[i])
+            invalid_cells[nb_invalid++] = i;
     }
-}
\ No newline at end of file
+    return nb_invalid;
+}
@@ -10,31 +10,112 @@
  * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
  * 
  */
+#include <stdbool.h>
 #include <stdlib.h>
+#include "eos_params.h"
 #include "miegruneisen_params.h"
+#include "miegruneisen_table.h"
 
 typedef struct MieGruneisenEOS MieGruneisenEOS_s;
 
 /**
- * @brief Defines a MieGruneisen equation of state
+ * @brief Number of cells of the blocks which specific volumes are compared to the cached ones
+ *        (see update_miegruneisen_terms)
+ * 
+ */
+#define MIEGRUNEISEN_CACHE_BLOCK_SIZE 64
+
+/**
+ * @brief Alignment, in bytes, of the block holding the per cell terms of the eos and of each of its
+ *        terms (MIEGRUNEISEN_ALIGNED_SOA layout, selected by the EOS_ALIGNED_SOA build option)
+ *
+ */
+#define MIEGRUNEISEN_ALIGNMENT 64
+
+/**
+ * @brief Tells the compiler that a term of the eos is aligned on MIEGRUNEISEN_ALIGNMENT bytes
+ *        (no-op with the separate arrays layout)
+ *
+ */
+#ifdef MIEGRUNEISEN_ALIGNED_SOA
+#define MIEGRUNEISEN_ASSUME_ALIGNED(ptr) ((const double *)__builtin_assume_aligned((ptr), MIEGRUNEISEN_ALIGNMENT))
+#else
+#define MIEGRUNEISEN_ASSUME_ALIGNED(ptr) ((const double *)(ptr))
+#endif
+
+/**
+ * @brief Defines a MieGruneisen equation of state.
+ *        The ideal and stiffened gas eos share the MieGruneisen form
+ *        \f$p = \phi(v) + \frac{dp}{de}(v) (e - e_{h}(v))\f$ and thus this structure, its arrays and
+ *        its pressure functions. Only the terms computed at init and the sound speed differ
+ *        (see stiffened_gas.h and set_eos_params in eos.h).
  * 
  */
 struct MieGruneisenEOS
 {
-    MieGruneisenParams_s const *params;  /**< The equation of state parameters */
+    EosType_e type;  /**< Type of the equation of state (MIEGRUNEISEN_EOS by default) */
+    MieGruneisenParams_s const *params;  /**< The equation of state parameters (MIEGRUNEISEN_EOS) */
+    StiffenedGasParams_s gas_params;  /**< The equation of state parameters (IDEAL_GAS_EOS and STIFFENED_GAS_EOS) */
+    bool is_affine_in_energy;  /**< True if, at fixed specific volume, the pressure is an affine function of the
+                                    internal energy (\f$p = p_0(v) + \frac{dp}{de}(v) e\f$) */
     double *phi;  /**< Array of pressures along the Hugoniot */
     double *dphi;  /**< Derivative of the pressures along the Hugoniot */
     double *einth;  /**< Internal energy along the Hugoniot */
     double *deinth;  /**< Derivative of the internal energy along the Hugoniot */
     double *gamma_per_vol;  /**< \f$dp/de\f$ */
+    double *terms_block;  /**< Allocation holding the five arrays above, each aligned on MIEGRUNEISEN_ALIGNMENT bytes
+                               (MIEGRUNEISEN_ALIGNED_SOA layout, NULL otherwise) */
+    bool *invalid_sound_speed;  /**< Cells which squared sound speed was negative at the last call of get_pressure_and_sound_speed */
+    const MieGruneisenTable_s *table;  /**< Table interpolated instead of the analytic terms by init_from_table and
+                                            update_miegruneisen_terms (NULL for the analytic eos) */
+    double *cached_specific_volume;  /**< Specific volume for which the arrays above have been computed by update_miegruneisen_terms */
+    unsigned int nb_cached_cells;  /**< Number of cells of the cache (0 if the cache is empty) */
+    EosType_e cached_type;  /**< Type of the equation of state for which the cache has been computed */
+    MieGruneisenParams_s cached_params;  /**< Parameters for which the cache has been computed (MIEGRUNEISEN_EOS) */
+    StiffenedGasParams_s cached_gas_params;  /**< Parameters for which the cache has been computed (gas eos) */
+    const MieGruneisenTable_s *cached_table;  /**< Table with which the cache has been computed */
     void (*get_pressure_and_derivative)(MieGruneisenEOS_s *, const int, const double *,
                                         const double *, double *, double *);  /**< Function that computes pressure and derivative of the pressure according to internal energy */
-    void (*get_pressure_and_sound_speed)(MieGruneisenEOS_s *, const int, const double *,
-                                         const double *, double *, double *);  /**< Function that computes pressure and the sound speed */
+    void (*get_pressure_and_derivative_on_subset)(MieGruneisenEOS_s *, const unsigned int *, const unsigned int,
+                                                  const double *, double *, double *);  /**< Same as get_pressure_and_derivative but only on a subset of cells */
+    void (*get_pressure_and_derivatives)(MieGruneisenEOS_s *, const int, const double *,
+                                         const double *, double *, double *, double *);  /**< Same as get_pressure_and_derivative plus the second derivative of the pressure according to internal energy */
+    unsigned int (*get_pressure_and_sound_speed)(MieGruneisenEOS_s *, const int, const double *,
+                                                 const double *, double *, double *);  /**< Function that computes pressure and the sound speed
+                                                                                            and returns the number of invalid cells */
     int (*init)(MieGruneisenEOS_s *, const unsigned int, const double * const);  /**< Function that computes every parameters of the function that depend only on density */
     void (*finalize)(MieGruneisenEOS_s *);  /**< Function that release the memory allocated during init */
 };
 
+/**
+ * @brief Allocate the arrays of the eos that are still NULL (phi, dphi, einth, deinth, gamma_per_vol, invalid_sound_speed
+ *        and cached_specific_volume)
+ *        so that they may hold nb_cells values. Already allocated arrays are left untouched.
+ *        Calling it once with the largest size expected allows to reuse the eos without
+ *        further allocation.
+ *
+ * With the MIEGRUNEISEN_ALIGNED_SOA layout (default), phi, dphi, einth, deinth and gamma_per_vol are
+ * carved out of a single block aligned on MIEGRUNEISEN_ALIGNMENT bytes, with a stride padded to a
+ * whole number of cache lines (see get_miegruneisen_terms_stride). Otherwise they are five separate arrays.
+ * 
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : size of the arrays to allocate
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int allocate_miegruneisen_arrays(MieGruneisenEOS_s *eos, const unsigned int nb_cells);
+
+/**
+ * @brief Number of doubles between the beginnings of two consecutive terms of the block of the
+ *        MIEGRUNEISEN_ALIGNED_SOA layout : nb_cells rounded up to a whole number of cache lines, plus
+ *        one cache line when the stride is a multiple of 4 KiB, so that the five terms of a cell
+ *        do not map to the same cache set
+ *
+ * @param[in] nb_cells : number of cells
+ * @return unsigned long : the stride
+ */
+unsigned long get_miegruneisen_terms_stride(const unsigned int nb_cells);
+
 /**
  * @brief Initialize the eos by computing all that depends only on density (specific volume):
  *        - phi : pressure on the hugoniot
@@ -43,6 +124,9 @@ struct MieGruneisenEOS
  *        - deinth : derivative of this internal energy
  *        - gamma_per_vol : dp/de 
  * 
+ * If the arrays of the eos have already been allocated (see allocate_miegruneisen_arrays) they are
+ * reused and should be at least nb_cells long.
+ *
  * @param[in] params : params of the eos
  * @param[in] nb_cells : size of the pb
  * @param[in] specific_volume : specific volume
@@ -52,6 +136,51 @@ struct MieGruneisenEOS
 int init(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * const specific_volume);
 
 
+/**
+ * @brief Same as init but the terms are interpolated in the table of the eos (see miegruneisen_table.h).
+ *        This function may be used as the init member of the eos.
+ * 
+ * @param[in] eos : the equation of state (its table should not be NULL)
+ * @param[in] nb_cells : size of the pb
+ * @param[in] specific_volume : specific volume
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int init_from_table(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * const specific_volume);
+
+/**
+ * @brief Compute the terms of the MieGruneisen eos that depend only on the specific volume
+ * 
+ * @param[in] params : parameters of the equation of state
+ * @param[in] nb_cells : size of the arrays
+ * @param[in] specific_volume : specific volume
+ * @param[out] phi : pressure on the hugoniot
+ * @param[out] dphi : derivative of the pressure on the hugoniot
+ * @param[out] einth : internal energy on the hugoniot
+ * @param[out] deinth : derivative of the internal energy on the hugoniot
+ * @param[out] gamma_per_vol : dp/de
+ */
+void compute_miegruneisen_terms(const MieGruneisenParams_s *params, const unsigned int nb_cells,
+                                const double *specific_volume, double *phi, double *dphi, double *einth,
+                                double *deinth, double *gamma_per_vol);
+
+/**
+ * @brief Same as init (or init_from_table if the eos has a table, or init_stiffened_gas for the gas eos) but,
+ *        if the previous call was done with the same number of cells, the same type of eos, the same parameters
+ *        and the same table,
+ *        only recomputes the terms of the blocks of MIEGRUNEISEN_CACHE_BLOCK_SIZE cells where the specific volume
+ *        differs, bitwise, from the one of the previous call. Calling init empties the cache.
+ * 
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : size of the pb
+ * @param[in] specific_volume : specific volume
+ * @param[out] nb_updated_cells : number of cells which terms have been recomputed (may be NULL)
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int update_miegruneisen_terms(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * const specific_volume,
+                              unsigned int *nb_updated_cells);
+
 /**
  * @brief Ends up the use of the eos by freeing memory allocated at init
  * 
@@ -61,6 +190,35 @@ int init(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * con
  */
 void finalize(MieGruneisenEOS_s *eos);
 
+/**
+ * @brief Read-only view on the terms of the eos that only depend on the specific volume.
+ *        It stays valid until the next init, update_miegruneisen_terms or finalize of the eos.
+ *
+ * When the eos is affine in internal energy (is_affine_in_energy), the pressure is
+ * \f$p = \phi + \frac{dp}{de} (e - e_h)\f$ and its derivative gamma_per_vol is constant along the
+ * Newton iterations : the residual functions may read them here instead of calling
+ * get_pressure_and_derivative, which copies gamma_per_vol at every call.
+ *
+ */
+typedef struct MieGruneisenTermsView
+{
+    unsigned int nb_cells;  /**< Number of cells of the view */
+    const double *phi;  /**< Pressure along the Hugoniot */
+    const double *dphi;  /**< Derivative of the pressure along the Hugoniot */
+    const double *einth;  /**< Internal energy along the Hugoniot */
+    const double *deinth;  /**< Derivative of the internal energy along the Hugoniot */
+    const double *gamma_per_vol;  /**< \f$dp/de\f$ */
+} MieGruneisenTermsView_s;
+
+/**
+ * @brief Get a view on the terms of the initialized eos (no copy)
+ *
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : number of cells of the view (at most the number of cells of the last init)
+ * @return MieGruneisenTermsView_s : the view
+ */
+MieGruneisenTermsView_s get_miegruneisen_terms_view(const MieGruneisenEOS_s *eos, const unsigned int nb_cells);
+
 /**
  * @brief Compute the pressure and the derivative of the pressure with respect to the specific
  *        internal energy
@@ -80,17 +238,65 @@ void compute_pressure_and_derivative(MieGruneisenEOS_s *eos, const int nb_cells,
                                      double *gamma_per_vol);
 
 /**
- * @brief Compute the pressure and the sound speed
+ * @brief Compute the pressure and its first and second derivatives with respect to the specific
+ *        internal energy. As the MieGruneisen eos is affine in internal energy, the second derivative is null.
  * 
- * @param[in] params : parameters of the equation of state
+ * @param[in] eos : the equation of state
  * @param[in] nb_cells : size of the arrays
  * @param[in] specific_volume : specific volume array
  * @param[in] internal_energy : internal energy array
  * @param[out] pressure : pressure array
- * @param[out] c_son : sound speed array
+ * @param[out] gamma_per_vol : dp/de array
+ * @param[out] d2p_de2 : d2p/de2 array
  */
-void compute_pressure_and_sound_speed(MieGruneisenEOS_s *eos, const int nb_cells,
+void compute_pressure_and_derivatives(MieGruneisenEOS_s *eos, const int nb_cells,
                                       const double *specific_volume,
-                                      const double *internal_energy, double *pressure, double *c_son);
+                                      const double *internal_energy, double *pressure,
+                                      double *gamma_per_vol, double *d2p_de2);
+
+/**
+ * @brief Compute the pressure and the derivative of the pressure with respect to the specific
+ *        internal energy only for the cells which indices are given
+ * 
+ * @param[in] eos : the equation of state
+ * @param[in] indices : indices of the cells
+ * @param[in] nb_indices : number of indices
+ * @param[in] internal_energy : internal energy array (indexed by cell)
+ * @param[out] pressure : pressure array (pressure[j] is the pressure of the cell indices[j])
+ * @param[out] gamma_per_vol : dp/de array (same ordering as pressure)
+ */
+void compute_pressure_and_derivative_on_subset(MieGruneisenEOS_s *eos, const unsigned int *indices,
+                                               const unsigned int nb_indices, const double *internal_energy,
+                                               double *pressure, double *gamma_per_vol);
+
+/**
+ * @brief Compute the pressure and the sound speed.
+ *        The loop has no branch so that it may be vectorized : the cells which squared sound speed is negative
+ *        get a NaN sound speed and are flagged in the invalid_sound_speed mask of the eos. They may then be listed
+ *        by list_invalid_sound_speeds. The output arrays should not overlap the input ones.
+ * 
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : size of the arrays
+ * @param[in] specific_volume : specific volume array
+ * @param[in] internal_energy : internal energy array
+ * @param[out] pressure : pressure array
+ * @param[out] c_son : sound speed array
+ * @return unsigned int : number of cells which squared sound speed is negative
+ */
+unsigned int compute_pressure_and_sound_speed(MieGruneisenEOS_s *eos, const int nb_cells,
+                                              const double *specific_volume,
+                                              const double *internal_energy, double *pressure, double *c_son);
+
+/**
+ * @brief List the cells flagged as invalid by the last call of get_pressure_and_sound_speed.
+ *        Meant for the error path, once get_pressure_and_sound_speed has returned a non zero count.
+ * 
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : size of the arrays given to get_pressure_and_sound_speed
+ * @param[out] invalid_cells : indices of the invalid cells (room for the count returned by get_pressure_and_sound_speed)
+ * @return unsigned int : number of invalid cells
+ */
+unsigned int list_invalid_sound_speeds(const MieGruneisenEOS_s *eos, const unsigned int nb_cells,
+                                       unsigned int *invalid_cells);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "miegruneisen_float.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+MieGruneisenFloatTerms_s *build_miegruneisen_float_terms(const unsigned int nb_cells)
+{
+    MieGruneisenFloatTerms_s *terms = (MieGruneisenFloatTerms_s *)calloc(1, sizeof(MieGruneisenFloatTerms_s));
+    if (terms == NULL)
+    {
+        fprintf(stderr, "The allocation of the float terms of the eos has failed!\n");
+        return NULL;
+    }
+    terms->nb_cells = nb_cells;
+    terms->phi = (float *)calloc(nb_cells, sizeof(float));
+    terms->dphi = (float *)calloc(nb_cells, sizeof(float));
+    terms->einth = (float *)calloc(nb_cells, sizeof(float));
+    terms->deinth = (float *)calloc(nb_cells, sizeof(float));
+    terms->gamma_per_vol = (float *)calloc(nb_cells, sizeof(float));
+    if (terms->phi == NULL || terms->dphi == NULL || terms->einth == NULL || terms->deinth == NULL ||
+        terms->gamma_per_vol == NULL)
+    {
+        fprintf(stderr, "The allocation of the float terms of the eos has failed (size requested : %u)!\n", nb_cells);
+        delete_miegruneisen_float_terms(terms);
+        return NULL;
+    }
+    return terms;
+}
+
+void delete_miegruneisen_float_terms(MieGruneisenFloatTerms_s *terms)
+{
+    if (terms)
+    {
+        free(terms->phi);
+        free(terms->dphi);
+        free(terms->einth);
+        free(terms->deinth);
+        free(terms->gamma_per_vol);
+        free(terms);
+    }
+}
+
+void compute_miegruneisen_float_terms(const MieGruneisenParams_s *params, const unsigned int nb_cells,
+                                      const float *specific_volume, MieGruneisenFloatTerms_s *terms)
+{
+    const float s1 = (float)params->s1;
+    const float s2 = (float)params->s2;
+    const float s3 = (float)params->s3;
+    const float rho_zero = (float)params->rho_zero;
+    const float gamma_zero = (float)params->gamma_zero;
+    const float coeff_b = (float)params->coeff_b;
+    const float e_zero = (float)params->e_zero;
+    const float c_zero_2 = (float)(params->c_zero * params->c_zero);
+    const float rho_czero2 = rho_zero * c_zero_2;
+    const float inv_rhozero_x2 = 1.f / (2.f * rho_zero);
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        const float v = specific_volume[i];
+        const float epsv = 1.f - rho_zero * v;
+        terms->gamma_per_vol[i] = (gamma_zero * (1.f - epsv) + coeff_b * epsv) / v;
+        if (epsv > 0)
+        {
+            const float denom = 1.f / (1.f - (s1 + s2 * epsv + s3 * epsv * epsv) * epsv);
+            const float phi_i = rho_czero2 * epsv * denom * denom;
+            const float redond_a = (s1 + 2.f * s2 * epsv + 3.f * s3 * epsv * epsv);
+            terms->phi[i] = phi_i;
+            terms->einth[i] = e_zero + phi_i * epsv * inv_rhozero_x2;
+            terms->dphi[i] = phi_i * rho_zero * (-1.f / epsv - 2.f * redond_a * denom);
+            terms->deinth[i] = phi_i * (-1.f - epsv * redond_a * denom);
+        }
+        else
+        {
+            terms->phi[i] = rho_czero2 * epsv / (1.f - epsv);
+            terms->einth[i] = e_zero;
+            terms->dphi[i] = -c_zero_2 / (v * v);
+            terms->deinth[i] = 0.f;
+        }
+    }
+}
+
+void convert_miegruneisen_terms_to_float(const MieGruneisenEOS_s *eos, const unsigned int nb_cells,
+                                         MieGruneisenFloatTerms_s *terms)
+{
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        terms->phi[i] = (float)eos->phi[i];
+        terms->dphi[i] = (float)eos->dphi[i];
+        terms->einth[i] = (float)eos->einth[i];
+        terms->deinth[i] = (float)eos->deinth[i];
+        terms->gamma_per_vol[i] = (float)eos->gamma_per_vol[i];
+    }
+}
+
+void compute_pressure_and_derivative_float(const MieGruneisenFloatTerms_s *terms, const unsigned int nb_cells,
+                                           const float *internal_energy, float *pressure, float *gamma_per_vol)
+{
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        gamma_per_vol[i] = terms->gamma_per_vol[i];
+        pressure[i] = terms->phi[i] + terms->gamma_per_vol[i] * (internal_energy[i] - terms->einth[i]);
+    }
+}
+
+/**
+ * @brief Branch-free loop of compute_pressure_and_sound_speed_float (the outputs do not overlap the inputs)
+ *
+ * @return unsigned int : number of cells which squared sound speed is negative
+ */
+static unsigned int sound_speed_loop_float(const unsigned int nb_cells, const float dgam, const float *restrict phi,
+                                           const float *restrict dphi, const float *restrict einth,
+                                           const float *restrict deinth, const float *restrict gamma_per_vol,
+                                           const float *restrict specific_volume,
+                                           const float *restrict internal_energy, float *restrict pressure,
+                                           float *restrict c_son, bool *restrict invalid_sound_speed)
+{
+    unsigned int nb_invalid = 0;
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        const float p = phi[i] + gamma_per_vol[i] * (internal_energy[i] - einth[i]);
+        const float dpdv = dphi[i] + (dgam - gamma_per_vol[i]) * (internal_energy[i] - einth[i]) / specific_volume[i] - gamma_per_vol[i] * deinth[i];
+        const float vson_2 = specific_volume[i] * specific_volume[i] * (p * gamma_per_vol[i] - dpdv);
+        pressure[i] = p;
+        // NaN for the invalid cells
+        c_son[i] = sqrtf(vson_2);
+        invalid_sound_speed[i] = vson_2 < 0.f;
+        nb_invalid += vson_2 < 0.f;
+    }
+    return nb_invalid;
+}
+
+unsigned int compute_pressure_and_sound_speed_float(const MieGruneisenParams_s *params,
+                                                    const MieGruneisenFloatTerms_s *terms, const unsigned int nb_cells,
+                                                    const float *specific_volume, const float *internal_energy,
+                                                    float *pressure, float *c_son, bool *invalid_sound_speed)
+{
+    const float dgam = (float)(params->rho_zero * (params->gamma_zero - params->coeff_b));
+    return sound_speed_loop_float(nb_cells, dgam, terms->phi, terms->dphi, terms->einth, terms->deinth,
+                                  terms->gamma_per_vol, specific_volume, internal_energy, pressure, c_son,
+                                  invalid_sound_speed);
+}
@@ -0,0 +1,103 @@
+#ifndef MIEGRUNEISEN_FLOAT_H
+#define MIEGRUNEISEN_FLOAT_H
+/**
+ * @file miegruneisen_float.h
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Single precision storage and computation of the MieGruneisen equation of state,
+ *        used by the float and mixed precision solve modes
+ * @version 0.1
+ * @date 2020-05-06
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * The relative error of the float terms is a few FLT_EPSILON (about 1e-7), which is enough for
+ * the first Newton iterations but not for the default tolerances of the solver.
+ */
+#include <stdbool.h>
+#include "miegruneisen.h"
+#include "miegruneisen_params.h"
+
+/**
+ * @brief Terms of the equation of state that depend only on the specific volume, in single precision
+ *
+ */
+typedef struct MieGruneisenFloatTerms
+{
+    unsigned int nb_cells;  /**< Size of the arrays */
+    float *phi;  /**< Pressure along the Hugoniot */
+    float *dphi;  /**< Derivative of the pressure along the Hugoniot */
+    float *einth;  /**< Internal energy along the Hugoniot */
+    float *deinth;  /**< Derivative of the internal energy along the Hugoniot */
+    float *gamma_per_vol;  /**< \f$dp/de\f$ */
+} MieGruneisenFloatTerms_s;
+
+/**
+ * @brief Build the float terms for nb_cells cells. Once used, they should be deleted
+ *        thanks to delete_miegruneisen_float_terms.
+ *
+ * @param[in] nb_cells : size of the arrays
+ * @return MieGruneisenFloatTerms_s* : pointer on the newly created terms in case of success, NULL otherwise
+ */
+MieGruneisenFloatTerms_s *build_miegruneisen_float_terms(const unsigned int nb_cells);
+
+/**
+ * @brief Release the memory held by the float terms
+ *
+ * @param[in] terms : terms to delete (may be NULL)
+ */
+void delete_miegruneisen_float_terms(MieGruneisenFloatTerms_s *terms);
+
+/**
+ * @brief Same as compute_miegruneisen_terms with single precision arithmetic
+ *
+ * @param[in] params : parameters of the equation of state
+ * @param[in] nb_cells : size of the arrays (at most the size of the terms)
+ * @param[in] specific_volume : specific volume
+ * @param[out] terms : terms of the equation of state
+ */
+void compute_miegruneisen_float_terms(const MieGruneisenParams_s *params, const unsigned int nb_cells,
+                                      const float *specific_volume, MieGruneisenFloatTerms_s *terms);
+
+/**
+ * @brief Round the terms of an initialized eos (of any type) to single precision
+ *
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : number of cells (at most the size of the terms)
+ * @param[out] terms : terms of the equation of state
+ */
+void convert_miegruneisen_terms_to_float(const MieGruneisenEOS_s *eos, const unsigned int nb_cells,
+                                         MieGruneisenFloatTerms_s *terms);
+
+/**
+ * @brief Same as compute_pressure_and_derivative in single precision
+ *
+ * @param[in] terms : terms of the equation of state
+ * @param[in] nb_cells : size of the arrays
+ * @param[in] internal_energy : internal energy array
+ * @param[out] pressure : pressure array
+ * @param[out] gamma_per_vol : dp/de array
+ */
+void compute_pressure_and_derivative_float(const MieGruneisenFloatTerms_s *terms, const unsigned int nb_cells,
+                                           const float *internal_energy, float *pressure, float *gamma_per_vol);
+
+/**
+ * @brief Same as compute_pressure_and_sound_speed in single precision : the cells which squared sound
+ *        speed is negative get a NaN sound speed and are flagged in invalid_sound_speed.
+ *        The output arrays should not overlap the input ones.
+ *
+ * @param[in] params : parameters of the equation of state
+ * @param[in] terms : terms of the equation of state
+ * @param[in] nb_cells : size of the arrays
+ * @param[in] specific_volume : specific volume array
+ * @param[in] internal_energy : internal energy array
+ * @param[out] pressure : pressure array
+ * @param[out] c_son : sound speed array
+ * @param[out] invalid_sound_speed : cells which squared sound speed is negative
+ * @return unsigned int : number of cells which squared sound speed is negative
+ */
+unsigned int compute_pressure_and_sound_speed_float(const MieGruneisenParams_s *params,
+                                                    const MieGruneisenFloatTerms_s *terms, const unsigned int nb_cells,
+                                                    const float *specific_volume, const float *internal_energy,
+                                                    float *pressure, float *c_son, bool *invalid_sound_speed);
+
+#endif
@@ -0,0 +1,225 @@
+#include "miegruneisen_table.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "miegruneisen.h"
+
+/**
+ * @brief Number of terms tabulated
+ *
+ */
+#define NB_TABULATED_TERMS 5
+
+/**
+ * @brief Return the abscissa of the table corresponding to the specific volume
+ *
+ * @param[in] spacing : spacing of the table
+ * @param[in] specific_volume : specific volume
+ * @return double : the abscissa
+ */
+static inline double get_abscissa(const MieGruneisenTableSpacing_e spacing, const double specific_volume)
+{
+    return spacing == MIEGRUNEISEN_TABLE_LOG ? log(specific_volume) : specific_volume;
+}
+
+/**
+ * @brief Return the specific volume corresponding to the abscissa of the table
+ *
+ * @param[in] spacing : spacing of the table
+ * @param[in] abscissa : abscissa
+ * @return double : the specific volume
+ */
+static inline double get_specific_volume(const MieGruneisenTableSpacing_e spacing, const double abscissa)
+{
+    return spacing == MIEGRUNEISEN_TABLE_LOG ? exp(abscissa) : abscissa;
+}
+
+/**
+ * @brief Allocate a table and fill it with the analytic terms of the equation of state.
+ *        The terms have a kink at the reference specific volume (1 / rho_zero). If it is inside the range
+ *        of the table, the step is reduced so that it falls on a point, and the last point is moved
+ *        so that the whole range is still covered. The table may thus hold a few more points than requested.
+ *
+ * @param[in] params : parameters of the equation of state
+ * @param[in] settings : range and spacing of the table
+ * @param[in] nb_points_requested : number of points
+ * @return MieGruneisenTable_s* : the table in case of success, NULL otherwise
+ */
+static MieGruneisenTable_s *fill_table(const MieGruneisenParams_s *params, const MieGruneisenTableSettings_s *settings,
+                                       const unsigned int nb_points_requested)
+{
+    const double origin = get_abscissa(settings->spacing, settings->v_min);
+    const double end = get_abscissa(settings->spacing, settings->v_max);
+    const double kink = get_abscissa(settings->spacing, 1. / params->rho_zero);
+    double step = (end - origin) / (nb_points_requested - 1);
+    unsigned int nb_points = nb_points_requested;
+    if (kink > origin && kink < end)
+    {
+        step = (kink - origin) / ceil((kink - origin) / step);
+        nb_points = (unsigned int)ceil((end - origin) / step) + 1;
+    }
+
+    MieGruneisenTable_s *table = (MieGruneisenTable_s *)calloc(1, sizeof(MieGruneisenTable_s));
+    double *specific_volume = (double *)calloc(nb_points, sizeof(double));
+    if (table == NULL || specific_volume == NULL)
+    {
+        fprintf(stderr, "The allocation of the MieGruneisen table has failed!\n");
+        free(table);
+        free(specific_volume);
+        return NULL;
+    }
+    table->phi = (double *)calloc(nb_points, sizeof(double));
+    table->dphi = (double *)calloc(nb_points, sizeof(double));
+    table->einth = (double *)calloc(nb_points, sizeof(double));
+    table->deinth = (double *)calloc(nb_points, sizeof(double));
+    table->gamma_per_vol = (double *)calloc(nb_points, sizeof(double));
+    if (table->phi == NULL || table->dphi == NULL || table->einth == NULL || table->deinth == NULL ||
+        table->gamma_per_vol == NULL)
+    {
+        fprintf(stderr, "Error during allocation of the MieGruneisen table arrays (size requested : %u)!\n", nb_points);
+        free(specific_volume);
+        delete_miegruneisen_table(table);
+        return NULL;
+    }
+
+    table->params = *params;
+    table->spacing = settings->spacing;
+    table->nb_points = nb_points;
+    table->origin = origin;
+    table->inv_step = 1. / step;
+    for (unsigned int k = 0; k < nb_points; ++k)
+    {
+        specific_volume[k] = get_specific_volume(settings->spacing, table->origin + k * step);
+    }
+    compute_miegruneisen_terms(params, nb_points, specific_volume, table->phi, table->dphi, table->einth, table->deinth,
+                               table->gamma_per_vol);
+    free(specific_volume);
+    return table;
+}
+
+/**
+ * @brief Measure the interpolation error of the table at MIEGRUNEISEN_TABLE_ERROR_SAMPLES - 1 points
+ *        inside each of its intervals
+ *
+ * @param[in] table : the table
+ * @return double : the error (see MieGruneisenTable_s::max_error), or a negative value if the memory
+ *                  needed could not be allocated
+ */
+static double measure_table_error(const MieGruneisenTable_s *table)
+{
+    const unsigned int nb_samples = (table->nb_points - 1) * (MIEGRUNEISEN_TABLE_ERROR_SAMPLES - 1);
+    double *buffer = (double *)calloc((2 * NB_TABULATED_TERMS + 1) * nb_samples, sizeof(double));
+    if (buffer == NULL)
+    {
+        fprintf(stderr, "Unable to allocate the memory needed to measure the error of the table!\n");
+        return -1.;
+    }
+    double *specific_volume = buffer;
+    double *exact[NB_TABULATED_TERMS];
+    double *interpolated[NB_TABULATED_TERMS];
+    for (int t = 0; t < NB_TABULATED_TERMS; ++t)
+    {
+        exact[t] = buffer + (1 + t) * nb_samples;
+        interpolated[t] = buffer + (1 + NB_TABULATED_TERMS + t) * nb_samples;
+    }
+
+    for (unsigned int k = 0; k + 1 < table->nb_points; ++k)
+    {
+        for (int j = 1; j < MIEGRUNEISEN_TABLE_ERROR_SAMPLES; ++j)
+        {
+            const double abscissa = table->origin + (k + (double)j / MIEGRUNEISEN_TABLE_ERROR_SAMPLES) / table->inv_step;
+            specific_volume[k * (MIEGRUNEISEN_TABLE_ERROR_SAMPLES - 1) + j - 1] = get_specific_volume(table->spacing, abscissa);
+        }
+    }
+    compute_miegruneisen_terms(&table->params, nb_samples, specific_volume, exact[0], exact[1], exact[2], exact[3], exact[4]);
+    interpolate_miegruneisen_table(table, nb_samples, specific_volume, interpolated[0], interpolated[1], interpolated[2],
+                                   interpolated[3], interpolated[4]);
+
+    double max_error = 0.;
+    for (int t = 0; t < NB_TABULATED_TERMS; ++t)
+    {
+        double max_value = 0.;
+        double max_difference = 0.;
+        for (unsigned int i = 0; i < nb_samples; ++i)
+        {
+            max_value = fmax(max_value, fabs(exact[t][i]));
+            max_difference = fmax(max_difference, fabs(interpolated[t][i] - exact[t][i]));
+        }
+        const double error = max_value > 0. ? max_difference / max_value : max_difference;
+        max_error = fmax(max_error, error);
+    }
+    free(buffer);
+    return max_error;
+}
+
+MieGruneisenTable_s *build_miegruneisen_table(const MieGruneisenParams_s *params, const MieGruneisenTableSettings_s *settings)
+{
+    if (!(settings->v_min > 0.) || !(settings->v_max > settings->v_min) || settings->nb_points < 2)
+    {
+        fprintf(stderr, "Invalid settings of the MieGruneisen table : [%g, %g] with %u points!\n", settings->v_min,
+                settings->v_max, settings->nb_points);
+        return NULL;
+    }
+
+    unsigned int nb_points = settings->nb_points;
+    while (true)
+    {
+        MieGruneisenTable_s *table = fill_table(params, settings, nb_points);
+        if (table == NULL)
+            return NULL;
+        table->max_error = measure_table_error(table);
+        if (table->max_error < 0.)
+        {
+            delete_miegruneisen_table(table);
+            return NULL;
+        }
+        if (settings->tolerance <= 0. || table->max_error <= settings->tolerance)
+            return table;
+        delete_miegruneisen_table(table);
+        // Doubling the number of intervals keeps the previous points
+        if (2 * nb_points - 1 > settings->nb_points_max)
+        {
+            fprintf(stderr, "The tolerance %g of the MieGruneisen table can not be reached with %u points!\n",
+                    settings->tolerance, settings->nb_points_max);
+            return NULL;
+        }
+        nb_points = 2 * nb_points - 1;
+    }
+}
+
+void delete_miegruneisen_table(MieGruneisenTable_s *table)
+{
+    if (table)
+    {
+        free(table->phi);
+        free(table->dphi);
+        free(table->einth);
+        free(table->deinth);
+        free(table->gamma_per_vol);
+        free(table);
+    }
+}
+
+void interpolate_miegruneisen_table(const MieGruneisenTable_s *table, const unsigned int nb_cells,
+                                    const double *specific_volume, double *phi, double *dphi, double *einth,
+                                    double *deinth, double *gamma_per_vol)
+{
+    const double origin = table->origin;
+    const double inv_step = table->inv_step;
+    const double last_interval = table->nb_points - 2;
+    const MieGruneisenTableSpacing_e spacing = table->spacing;
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        // Position in the table, the index of the interval being clamped so that
+        // the volumes outside of the table are extrapolated
+        const double position = (get_abscissa(spacing, specific_volume[i]) - origin) * inv_step;
+        const double interval = fmin(fmax(floor(position), 0.), last_interval);
+        const unsigned int k = (unsigned int)interval;
+        const double weight = position - interval;
+        phi[i] = table->phi[k] + weight * (table->phi[k + 1] - table->phi[k]);
+        dphi[i] = table->dphi[k] + weight * (table->dphi[k + 1] - table->dphi[k]);
+        einth[i] = table->einth[k] + weight * (table->einth[k + 1] - table->einth[k]);
+        deinth[i] = table->deinth[k] + weight * (table->deinth[k + 1] - table->deinth[k]);
+        gamma_per_vol[i] = table->gamma_per_vol[k] + weight * (table->gamma_per_vol[k + 1] - table->gamma_per_vol[k]);
+    }
+}
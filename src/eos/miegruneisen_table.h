@@ -0,0 +1,103 @@
+#ifndef MIEGRUNEISEN_TABLE_H
+#define MIEGRUNEISEN_TABLE_H
+/**
+ * @file miegruneisen_table.h
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Tabulation of the terms of the MieGruneisen equation of state that depend only on the specific volume
+ * @version 0.1
+ * @date 2020-05-06
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ */
+#include <stdbool.h>
+#include "miegruneisen_params.h"
+
+/**
+ * @brief Number of points, per interval of the table, where the interpolation error is measured
+ *
+ */
+#define MIEGRUNEISEN_TABLE_ERROR_SAMPLES 4
+
+/**
+ * @brief Spacing of the points of the table
+ *
+ */
+typedef enum MieGruneisenTableSpacing
+{
+    MIEGRUNEISEN_TABLE_UNIFORM,  /**< Points uniformly spaced in specific volume */
+    MIEGRUNEISEN_TABLE_LOG  /**< Points uniformly spaced in logarithm of the specific volume */
+} MieGruneisenTableSpacing_e;
+
+/**
+ * @brief Settings of the building of a table
+ *
+ */
+typedef struct MieGruneisenTableSettings
+{
+    double v_min;  /**< Lowest specific volume of the table */
+    double v_max;  /**< Highest specific volume of the table */
+    MieGruneisenTableSpacing_e spacing;  /**< Spacing of the points */
+    unsigned int nb_points;  /**< Number of points of the table (at least 2). A few more points may be used to
+                                  put one on the reference specific volume, where the terms have a kink */
+    double tolerance;  /**< If positive, the number of points is doubled until the interpolation error is below the tolerance */
+    unsigned int nb_points_max;  /**< Maximum number of points reached while refining the table */
+} MieGruneisenTableSettings_s;
+
+/**
+ * @brief Terms of the MieGruneisen equation of state that depend only on the specific volume,
+ *        tabulated on a grid of specific volumes and linearly interpolated
+ *
+ */
+typedef struct MieGruneisenTable
+{
+    MieGruneisenParams_s params;  /**< Parameters of the equation of state tabulated */
+    MieGruneisenTableSpacing_e spacing;  /**< Spacing of the points */
+    unsigned int nb_points;  /**< Number of points */
+    double origin;  /**< Abscissa (specific volume or its logarithm) of the first point */
+    double inv_step;  /**< Inverse of the distance between two consecutive abscissae */
+    double *phi;  /**< Pressure on the hugoniot at each point */
+    double *dphi;  /**< Derivative of the pressure on the hugoniot at each point */
+    double *einth;  /**< Internal energy on the hugoniot at each point */
+    double *deinth;  /**< Derivative of the internal energy on the hugoniot at each point */
+    double *gamma_per_vol;  /**< dp/de at each point */
+    double max_error;  /**< Interpolation error measured once the table is built : maximum over the terms of the
+                            largest difference to the analytic value divided by the largest absolute value of the term */
+} MieGruneisenTable_s;
+
+/**
+ * @brief Build the table of the terms of the equation of state. Once used, the table should be deleted
+ *        thanks to delete_miegruneisen_table.
+ *
+ * @param[in] params : parameters of the equation of state
+ * @param[in] settings : range, spacing and resolution of the table
+ * @return MieGruneisenTable_s* : pointer on the newly created table in case of success, NULL otherwise
+ *                                (invalid settings, allocation failure or tolerance not reached within nb_points_max points)
+ */
+MieGruneisenTable_s *build_miegruneisen_table(const MieGruneisenParams_s *params, const MieGruneisenTableSettings_s *settings);
+
+/**
+ * @brief Release the memory held by the table
+ *
+ * @param[in] table : table to delete (may be NULL)
+ */
+void delete_miegruneisen_table(MieGruneisenTable_s *table);
+
+/**
+ * @brief Interpolate the terms of the equation of state. The specific volumes outside the table
+ *        are extrapolated from its first or last interval.
+ *
+ * @param[in] table : the table
+ * @param[in] nb_cells : size of the arrays
+ * @param[in] specific_volume : specific volume array
+ * @param[out] phi : pressure on the hugoniot
+ * @param[out] dphi : derivative of the pressure on the hugoniot
+ * @param[out] einth : internal energy on the hugoniot
+ * @param[out] deinth : derivative of the internal energy on the hugoniot
+ * @param[out] gamma_per_vol : dp/de
+ */
+void interpolate_miegruneisen_table(const MieGruneisenTable_s *table, const unsigned int nb_cells,
+                                    const double *specific_volume, double *phi, double *dphi, double *einth,
+                                    double *deinth, double *gamma_per_vol);
+
+#endif
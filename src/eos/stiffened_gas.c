@@ -0,0 +1,67 @@
+#include "stiffened_gas.h"
+#include <math.h>
+#include <stdio.h>
+
+void compute_stiffened_gas_terms(const StiffenedGasParams_s *params, const unsigned int nb_cells,
+                                 const double *specific_volume, double *phi, double *dphi, double *einth,
+                                 double *deinth, double *gamma_per_vol)
+{
+    const double gamma_minus_one = params->gamma - 1.;
+    const double reference_pressure = -params->gamma * params->p_inf;
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        phi[i] = reference_pressure;
+        dphi[i] = 0.;
+        einth[i] = 0.;
+        deinth[i] = 0.;
+        gamma_per_vol[i] = gamma_minus_one / specific_volume[i];
+    }
+}
+
+int init_stiffened_gas(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * const specific_volume)
+{
+    if (allocate_miegruneisen_arrays(eos, nb_cells) == EXIT_FAILURE)
+    {
+        return EXIT_FAILURE;
+    }
+    eos->nb_cached_cells = 0;
+    compute_stiffened_gas_terms(&eos->gas_params, nb_cells, specific_volume, eos->phi, eos->dphi, eos->einth,
+                                eos->deinth, eos->gamma_per_vol);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Branch-free loop of compute_stiffened_gas_pressure_and_sound_speed (the outputs do not overlap the inputs)
+ *
+ * @return unsigned int : number of cells which squared sound speed is negative
+ */
+static unsigned int stiffened_gas_sound_speed_loop(const int nb_cells, const double gamma, const double p_inf,
+                                                   const double *restrict phi, const double *restrict einth,
+                                                   const double *restrict gamma_per_vol,
+                                                   const double *restrict specific_volume,
+                                                   const double *restrict internal_energy, double *restrict pressure,
+                                                   double *restrict c_son, bool *restrict invalid_sound_speed)
+{
+    unsigned int nb_invalid = 0;
+    for (int i = 0; i < nb_cells; ++i)
+    {
+        const double p = phi[i] + gamma_per_vol[i] * (internal_energy[i] - einth[i]);
+        const double vson_2 = gamma * (p + p_inf) * specific_volume[i];
+        pressure[i] = p;
+        // NaN for the invalid cells
+        c_son[i] = sqrt(vson_2);
+        invalid_sound_speed[i] = vson_2 < 0.;
+        nb_invalid += vson_2 < 0.;
+    }
+    return nb_invalid;
+}
+
+unsigned int compute_stiffened_gas_pressure_and_sound_speed(MieGruneisenEOS_s *eos, const int nb_cells,
+                                                            const double *specific_volume,
+                                                            const double *internal_energy, double *pressure,
+                                                            double *c_son)
+{
+    return stiffened_gas_sound_speed_loop(nb_cells, eos->gas_params.gamma, eos->gas_params.p_inf, eos->phi, eos->einth,
+                                          eos->gamma_per_vol, specific_volume, internal_energy, pressure, c_son,
+                                          eos->invalid_sound_speed);
+}
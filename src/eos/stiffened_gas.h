@@ -0,0 +1,68 @@
+#ifndef STIFFENED_GAS_H
+#define STIFFENED_GAS_H
+/**
+ * @file stiffened_gas.h
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Holds everything related to the ideal and stiffened gas equations of state
+ * @version 0.1
+ * @date 2020-05-06
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * The stiffened gas eos \f$p = (\gamma - 1) \frac{e}{v} - \gamma p_\infty\f$ is of the MieGruneisen form with :
+ *  - \f$\phi = -\gamma p_\infty\f$ and \f$e_h = 0\f$ (thus null derivatives)
+ *  - \f$\frac{dp}{de} = \frac{\gamma - 1}{v}\f$
+ *
+ * The ideal gas is the stiffened gas with \f$p_\infty = 0\f$.
+ */
+#include "eos_params.h"
+#include "miegruneisen.h"
+
+/**
+ * @brief Compute the terms of the stiffened gas eos that depend only on the specific volume
+ *
+ * @param[in] params : parameters of the equation of state
+ * @param[in] nb_cells : size of the arrays
+ * @param[in] specific_volume : specific volume
+ * @param[out] phi : reference pressure
+ * @param[out] dphi : derivative of the reference pressure
+ * @param[out] einth : reference internal energy
+ * @param[out] deinth : derivative of the reference internal energy
+ * @param[out] gamma_per_vol : dp/de
+ */
+void compute_stiffened_gas_terms(const StiffenedGasParams_s *params, const unsigned int nb_cells,
+                                 const double *specific_volume, double *phi, double *dphi, double *einth,
+                                 double *deinth, double *gamma_per_vol);
+
+/**
+ * @brief Same as init for the ideal and stiffened gas eos (the parameters are the gas_params of the eos).
+ *        This function may be used as the init member of the eos.
+ *
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : size of the pb
+ * @param[in] specific_volume : specific volume
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int init_stiffened_gas(MieGruneisenEOS_s *eos, const unsigned int nb_cells, const double * const specific_volume);
+
+/**
+ * @brief Compute the pressure and the sound speed of the ideal and stiffened gas eos :
+ *        \f$c^2 = \gamma (p + p_\infty) v\f$. As compute_pressure_and_sound_speed, the cells which squared
+ *        sound speed is negative get a NaN sound speed and are flagged in the invalid_sound_speed mask of the eos.
+ *        The output arrays should not overlap the input ones.
+ *
+ * @param[in] eos : the equation of state
+ * @param[in] nb_cells : size of the arrays
+ * @param[in] specific_volume : specific volume array
+ * @param[in] internal_energy : internal energy array
+ * @param[out] pressure : pressure array
+ * @param[out] c_son : sound speed array
+ * @return unsigned int : number of cells which squared sound speed is negative
+ */
+unsigned int compute_stiffened_gas_pressure_and_sound_speed(MieGruneisenEOS_s *eos, const int nb_cells,
+                                                            const double *specific_volume,
+                                                            const double *internal_energy, double *pressure,
+                                                            double *c_son);
+
+#endif
@@ -1,4 +1,6 @@
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 
 #include "miegruneisen.h"
 #include "miegruneisen_params.h"
@@ -16,9 +18,14 @@ int main()
 {
     MieGruneisenParams_s copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
     MieGruneisenEOS_s copper_eos = {
-        &copper_mat, NULL, NULL, NULL, NULL, NULL,
-        compute_pressure_and_derivative, compute_pressure_and_sound_speed,
-        init, finalize};
+        .params = &copper_mat,
+        .is_affine_in_energy = true,
+        .get_pressure_and_derivative = compute_pressure_and_derivative,
+        .get_pressure_and_derivative_on_subset = compute_pressure_and_derivative_on_subset,
+        .get_pressure_and_derivatives = compute_pressure_and_derivatives,
+        .get_pressure_and_sound_speed = compute_pressure_and_sound_speed,
+        .init = init,
+        .finalize = finalize};
 
     double density[PB_SIZE] = {8700., 9200.};
     double specific_volume[PB_SIZE] = {1. / density[0], 1. / density[1]};
@@ -42,7 +49,44 @@ int main()
                              "gamma_per_vol"))
         success = false;
 
-    compute_pressure_and_sound_speed(&copper_eos, PB_SIZE, specific_volume, internal_energy, pressure, cson);
+    // Evaluation on a subset of cells given in reverse order
+    const unsigned int indices[PB_SIZE] = {1, 0};
+    double subset_pressure[PB_SIZE] = {0., 0.};
+    double subset_gamma_per_vol[PB_SIZE] = {0., 0.};
+    double expected_subset_pressure[] = {expected_pressure[1], expected_pressure[0]};
+    double expected_subset_gamma[] = {expected_gamma[1], expected_gamma[0]};
+
+    compute_pressure_and_derivative_on_subset(&copper_eos, indices, PB_SIZE, internal_energy,
+                                              subset_pressure, subset_gamma_per_vol);
+
+    if (!assert_equal_arrays(subset_pressure, expected_subset_pressure, PB_SIZE, "subset_pressure"))
+        success = false;
+    if (!assert_equal_arrays(subset_gamma_per_vol, expected_subset_gamma, PB_SIZE,
+                             "subset_gamma_per_vol"))
+        success = false;
+
+    // Second derivative of the pressure (null as the eos is affine in internal energy)
+    double d2p_de2[PB_SIZE] = {1., 1.};
+    const bool expected_d2p_de2[PB_SIZE] = {true, true};
+    bool is_null_d2p_de2[PB_SIZE];
+    compute_pressure_and_derivatives(&copper_eos, PB_SIZE, specific_volume, internal_energy, pressure, gamma_per_vol,
+                                     d2p_de2);
+    for (unsigned int i = 0; i < PB_SIZE; ++i)
+        is_null_d2p_de2[i] = d2p_de2[i] == 0.;
+
+    if (!assert_equal_arrays(pressure, expected_pressure, PB_SIZE, "pressure"))
+        success = false;
+    if (!assert_equal_arrays(gamma_per_vol, expected_gamma, PB_SIZE,
+                             "gamma_per_vol"))
+        success = false;
+    if (!assert_equal_bool_arrays(is_null_d2p_de2, expected_d2p_de2, PB_SIZE, "is_null_d2p_de2"))
+        success = false;
+
+    if (compute_pressure_and_sound_speed(&copper_eos, PB_SIZE, specific_volume, internal_energy, pressure, cson) != 0)
+    {
+        fprintf(stderr, "No cell should have a negative squared sound speed!\n");
+        success = false;
+    }
 
     if (!assert_equal_arrays(pressure, expected_pressure, PB_SIZE, "pressure"))
         success = false;
@@ -52,6 +96,74 @@ int main()
     if (!assert_equal_arrays(cson, expected_cson, PB_SIZE, "cson"))
         success = false;
 
+    // The terms depending on the specific volume are only recomputed where it has changed
+    double expected_phi[PB_SIZE] = {copper_eos.phi[0], copper_eos.phi[1]};
+    unsigned int nb_updated_cells[4] = {0, 0, 0, 0};
+    const unsigned int expected_nb_updated_cells[4] = {PB_SIZE, 0, PB_SIZE, PB_SIZE};
+    for (unsigned int i = 0; i < PB_SIZE; ++i)
+        copper_eos.phi[i] = 0.;
+    update_miegruneisen_terms(&copper_eos, PB_SIZE, specific_volume, &nb_updated_cells[0]);
+    update_miegruneisen_terms(&copper_eos, PB_SIZE, specific_volume, &nb_updated_cells[1]);
+    if (!assert_equal_arrays(copper_eos.phi, expected_phi, PB_SIZE, "cached_phi"))
+        success = false;
+    // Change of specific volume
+    specific_volume[1] = specific_volume[0];
+    expected_phi[1] = expected_phi[0];
+    update_miegruneisen_terms(&copper_eos, PB_SIZE, specific_volume, &nb_updated_cells[2]);
+    if (!assert_equal_arrays(copper_eos.phi, expected_phi, PB_SIZE, "updated_phi"))
+        success = false;
+    // Change of parameters
+    MieGruneisenParams_s other_mat = copper_mat;
+    other_mat.c_zero *= 2.;
+    copper_eos.params = &other_mat;
+    update_miegruneisen_terms(&copper_eos, PB_SIZE, specific_volume, &nb_updated_cells[3]);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        if (nb_updated_cells[i] != expected_nb_updated_cells[i])
+        {
+            fprintf(stderr, "%u cells updated instead of %u at the call %u!\n", nb_updated_cells[i],
+                    expected_nb_updated_cells[i], i);
+            success = false;
+        }
+    }
+
+    // Strides padded to whole cache lines, and shifted by one line when multiple of 4 KiB
+    const unsigned int nb_cells[3] = {PB_SIZE, 512, 513};
+    const unsigned long expected_strides[3] = {8, 520, 520};
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        if (get_miegruneisen_terms_stride(nb_cells[i]) != expected_strides[i])
+        {
+            fprintf(stderr, "Stride of the eos terms for %u cells : %lu instead of %lu!\n", nb_cells[i],
+                    get_miegruneisen_terms_stride(nb_cells[i]), expected_strides[i]);
+            success = false;
+        }
+    }
+#ifdef MIEGRUNEISEN_ALIGNED_SOA
+    // The terms are carved out of a single aligned block
+    const double *terms[5] = {copper_eos.phi, copper_eos.dphi, copper_eos.einth, copper_eos.deinth,
+                              copper_eos.gamma_per_vol};
+    for (unsigned int i = 0; i < 5; ++i)
+    {
+        if (terms[i] != copper_eos.phi + i * get_miegruneisen_terms_stride(PB_SIZE) ||
+            (uintptr_t)terms[i] % MIEGRUNEISEN_ALIGNMENT != 0)
+        {
+            fprintf(stderr, "The term %u of the eos is not at its place in the aligned block!\n", i);
+            success = false;
+        }
+    }
+#endif
+
+    // The view reads the terms of the eos without copying them
+    const MieGruneisenTermsView_s view = get_miegruneisen_terms_view(&copper_eos, PB_SIZE);
+    if (view.nb_cells != PB_SIZE || view.phi != copper_eos.phi || view.dphi != copper_eos.dphi ||
+        view.einth != copper_eos.einth || view.deinth != copper_eos.deinth ||
+        view.gamma_per_vol != copper_eos.gamma_per_vol)
+    {
+        fprintf(stderr, "The view does not point on the terms of the eos!\n");
+        success = false;
+    }
+
     copper_eos.finalize(&copper_eos);
 
     if (!success)
@@ -0,0 +1,123 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "miegruneisen.h"
+#include "miegruneisen_float.h"
+#include "miegruneisen_params.h"
+
+#define PB_SIZE 3
+#define FLOAT_TOLERANCE 1.e-5
+
+/**
+ * @brief Check that the float values are close to the double precision ones
+ *
+ * @param[in] values : float values
+ * @param[in] expected : double precision values
+ * @param[in] size : size of the arrays
+ * @param[in] name : name of the values
+ * @return true : if the relative difference of each value is below FLOAT_TOLERANCE
+ * @return false : otherwise
+ */
+static bool check_float_values(const float *values, const double *expected, const unsigned int size, const char *name)
+{
+    bool success = true;
+    for (unsigned int i = 0; i < size; ++i)
+    {
+        if (fabs((double)values[i] - expected[i]) > FLOAT_TOLERANCE * fabs(expected[i]))
+        {
+            fprintf(stderr, "%s[%u] = %.9g instead of %.9g!\n", name, i, values[i], expected[i]);
+            success = false;
+        }
+    }
+    return success;
+}
+
+/**
+ * @brief Launch the test of the single precision MieGruneisen equation of state
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main()
+{
+    MieGruneisenParams_s copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    MieGruneisenEOS_s copper_eos = {.params = &copper_mat, .init = init, .finalize = finalize};
+
+    // Expansion and compression
+    const double density[PB_SIZE] = {8700., 9200., 9500.};
+    const double internal_energy[PB_SIZE] = {1.e+4, 1.e+6, 2.e+5};
+    double specific_volume[PB_SIZE];
+    float specific_volume_f[PB_SIZE];
+    float internal_energy_f[PB_SIZE];
+    for (unsigned int i = 0; i < PB_SIZE; ++i)
+    {
+        specific_volume[i] = 1. / density[i];
+        specific_volume_f[i] = (float)specific_volume[i];
+        internal_energy_f[i] = (float)internal_energy[i];
+    }
+    MieGruneisenFloatTerms_s *terms = build_miegruneisen_float_terms(PB_SIZE);
+    if (terms == NULL || copper_eos.init(&copper_eos, PB_SIZE, specific_volume) == EXIT_FAILURE)
+    {
+        delete_miegruneisen_float_terms(terms);
+        return EXIT_FAILURE;
+    }
+
+    bool success = true;
+    // Terms computed in single precision and rounded from the double precision ones
+    for (int conversion = 0; conversion < 2; ++conversion)
+    {
+        if (conversion == 0)
+            compute_miegruneisen_float_terms(&copper_mat, PB_SIZE, specific_volume_f, terms);
+        else
+            convert_miegruneisen_terms_to_float(&copper_eos, PB_SIZE, terms);
+        if (!check_float_values(terms->phi, copper_eos.phi, PB_SIZE, "phi") ||
+            !check_float_values(terms->dphi, copper_eos.dphi, PB_SIZE, "dphi") ||
+            !check_float_values(terms->einth, copper_eos.einth, PB_SIZE, "einth") ||
+            !check_float_values(terms->gamma_per_vol, copper_eos.gamma_per_vol, PB_SIZE, "gamma_per_vol"))
+        {
+            fprintf(stderr, "Wrong float terms (conversion : %d)!\n", conversion);
+            success = false;
+        }
+    }
+
+    double expected_pressure[PB_SIZE];
+    double expected_gamma[PB_SIZE];
+    double expected_cson[PB_SIZE];
+    float pressure[PB_SIZE];
+    float gamma_per_vol[PB_SIZE];
+    float cson[PB_SIZE];
+    bool invalid_sound_speed[PB_SIZE];
+    compute_pressure_and_derivative(&copper_eos, PB_SIZE, specific_volume, internal_energy, expected_pressure,
+                                    expected_gamma);
+    compute_pressure_and_derivative_float(terms, PB_SIZE, internal_energy_f, pressure, gamma_per_vol);
+    if (!check_float_values(pressure, expected_pressure, PB_SIZE, "pressure") ||
+        !check_float_values(gamma_per_vol, expected_gamma, PB_SIZE, "gamma_per_vol"))
+        success = false;
+
+    compute_pressure_and_sound_speed(&copper_eos, PB_SIZE, specific_volume, internal_energy, expected_pressure,
+                                     expected_cson);
+    if (compute_pressure_and_sound_speed_float(&copper_mat, terms, PB_SIZE, specific_volume_f, internal_energy_f,
+                                               pressure, cson, invalid_sound_speed) != 0 ||
+        !check_float_values(pressure, expected_pressure, PB_SIZE, "pressure") ||
+        !check_float_values(cson, expected_cson, PB_SIZE, "cson"))
+        success = false;
+
+    // Negative squared sound speed in strong expansion without internal energy
+    const float expanded_volume = 1.f / 4000.f;
+    const float null_energy = 0.f;
+    compute_miegruneisen_float_terms(&copper_mat, 1, &expanded_volume, terms);
+    if (compute_pressure_and_sound_speed_float(&copper_mat, terms, 1, &expanded_volume, &null_energy, pressure, cson,
+                                               invalid_sound_speed) != 1 ||
+        !invalid_sound_speed[0] || !isnan(cson[0]))
+    {
+        fprintf(stderr, "The strongly expanded cell should have an invalid sound speed!\n");
+        success = false;
+    }
+
+    copper_eos.finalize(&copper_eos);
+    delete_miegruneisen_float_terms(terms);
+
+    if (!success)
+        return (EXIT_FAILURE);
+    return EXIT_SUCCESS;
+}
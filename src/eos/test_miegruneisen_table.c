@@ -0,0 +1,157 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "miegruneisen.h"
+#include "miegruneisen_params.h"
+#include "miegruneisen_table.h"
+#include "test_utils.h"
+
+#define PB_SIZE 1000
+#define TABLE_TOLERANCE 1.e-6
+
+/**
+ * @brief Check that the terms interpolated in the table are close to the analytic ones
+ *
+ * @param[in] table : the table
+ * @param[in] specific_volume : specific volumes where the terms are compared
+ * @param[in] tolerance : maximum error allowed relatively to the largest absolute value of each term
+ * @return true : if every term is close enough to the analytic one
+ * @return false : otherwise
+ */
+static bool check_table_accuracy(const MieGruneisenTable_s *table, const double *specific_volume, const double tolerance)
+{
+    double exact[5][PB_SIZE];
+    double interpolated[5][PB_SIZE];
+    const char *names[5] = {"phi", "dphi", "einth", "deinth", "gamma_per_vol"};
+    compute_miegruneisen_terms(&table->params, PB_SIZE, specific_volume, exact[0], exact[1], exact[2], exact[3], exact[4]);
+    interpolate_miegruneisen_table(table, PB_SIZE, specific_volume, interpolated[0], interpolated[1], interpolated[2],
+                                   interpolated[3], interpolated[4]);
+
+    bool success = true;
+    for (int t = 0; t < 5; ++t)
+    {
+        double max_value = 0.;
+        double max_difference = 0.;
+        for (unsigned int i = 0; i < PB_SIZE; ++i)
+        {
+            max_value = fmax(max_value, fabs(exact[t][i]));
+            max_difference = fmax(max_difference, fabs(interpolated[t][i] - exact[t][i]));
+        }
+        if (max_difference > tolerance * max_value)
+        {
+            fprintf(stderr, "The error on %s is %g instead of at most %g!\n", names[t], max_difference / max_value,
+                    tolerance);
+            success = false;
+        }
+    }
+    return success;
+}
+
+/**
+ * @brief Launch the test of the tabulated MieGruneisen equation of state
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main()
+{
+    MieGruneisenParams_s copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    MieGruneisenTableSettings_s settings = {.v_min = 1. / 12000., .v_max = 1. / 6000., .nb_points = 17,
+                                            .tolerance = TABLE_TOLERANCE, .nb_points_max = 1 << 16};
+
+    // Volumes between the points of the table, from expansion to strong compression
+    double specific_volume[PB_SIZE];
+    for (unsigned int i = 0; i < PB_SIZE; ++i)
+        specific_volume[i] = settings.v_min + (settings.v_max - settings.v_min) * (i + 0.37) / PB_SIZE;
+
+    bool success = true;
+    const MieGruneisenTableSpacing_e spacings[2] = {MIEGRUNEISEN_TABLE_UNIFORM, MIEGRUNEISEN_TABLE_LOG};
+    for (int s = 0; s < 2; ++s)
+    {
+        settings.spacing = spacings[s];
+        MieGruneisenTable_s *table = build_miegruneisen_table(&copper_mat, &settings);
+        if (table == NULL || table->max_error > TABLE_TOLERANCE)
+        {
+            fprintf(stderr, "Unable to build the table with the spacing %d!\n", spacings[s]);
+            delete_miegruneisen_table(table);
+            return EXIT_FAILURE;
+        }
+        // The error is measured on a finite number of samples
+        if (!check_table_accuracy(table, specific_volume, 2. * TABLE_TOLERANCE))
+            success = false;
+        delete_miegruneisen_table(table);
+    }
+
+    // Without tolerance, the number of points is about the one requested
+    settings.tolerance = 0.;
+    MieGruneisenTable_s *table = build_miegruneisen_table(&copper_mat, &settings);
+    if (table == NULL || table->nb_points < settings.nb_points || table->nb_points > settings.nb_points + 2 ||
+        !(table->max_error > TABLE_TOLERANCE))
+    {
+        fprintf(stderr, "The table should have about %u points and an error above %g!\n", settings.nb_points, TABLE_TOLERANCE);
+        success = false;
+    }
+    delete_miegruneisen_table(table);
+
+    // Unreachable tolerance and invalid range
+    settings.tolerance = 1.e-30;
+    settings.nb_points_max = 1000;
+    if (build_miegruneisen_table(&copper_mat, &settings) != NULL)
+    {
+        fprintf(stderr, "The tolerance should not have been reached!\n");
+        success = false;
+    }
+    settings.tolerance = TABLE_TOLERANCE;
+    settings.nb_points_max = 1 << 16;
+    settings.v_min = settings.v_max;
+    if (build_miegruneisen_table(&copper_mat, &settings) != NULL)
+    {
+        fprintf(stderr, "The range of the table should have been rejected!\n");
+        success = false;
+    }
+    settings.v_min = 1. / 12000.;
+
+    // The eos with a table interpolates it, through init and through its cache
+    table = build_miegruneisen_table(&copper_mat, &settings);
+    MieGruneisenEOS_s copper_eos = {
+        .params = &copper_mat,
+        .is_affine_in_energy = true,
+        .table = table,
+        .get_pressure_and_derivative = compute_pressure_and_derivative,
+        .get_pressure_and_derivative_on_subset = compute_pressure_and_derivative_on_subset,
+        .get_pressure_and_derivatives = compute_pressure_and_derivatives,
+        .get_pressure_and_sound_speed = compute_pressure_and_sound_speed,
+        .init = init_from_table,
+        .finalize = finalize};
+    double expected[5][PB_SIZE];
+    if (table == NULL || copper_eos.init(&copper_eos, PB_SIZE, specific_volume) == EXIT_FAILURE)
+    {
+        fprintf(stderr, "Unable to initialize the eos with a table!\n");
+        delete_miegruneisen_table(table);
+        return EXIT_FAILURE;
+    }
+    interpolate_miegruneisen_table(table, PB_SIZE, specific_volume, expected[0], expected[1], expected[2], expected[3],
+                                   expected[4]);
+    if (!assert_equal_arrays(copper_eos.phi, expected[0], PB_SIZE, "phi"))
+        success = false;
+    if (!assert_equal_arrays(copper_eos.dphi, expected[1], PB_SIZE, "dphi"))
+        success = false;
+    update_miegruneisen_terms(&copper_eos, PB_SIZE, specific_volume, NULL);
+    if (!assert_equal_arrays(copper_eos.gamma_per_vol, expected[4], PB_SIZE, "cached_gamma_per_vol"))
+        success = false;
+    // Without table, the cache is recomputed analytically
+    unsigned int nb_updated_cells = 0;
+    copper_eos.table = NULL;
+    update_miegruneisen_terms(&copper_eos, PB_SIZE, specific_volume, &nb_updated_cells);
+    compute_miegruneisen_terms(&copper_mat, PB_SIZE, specific_volume, expected[0], expected[1], expected[2], expected[3],
+                               expected[4]);
+    if (nb_updated_cells != PB_SIZE || !assert_equal_arrays(copper_eos.phi, expected[0], PB_SIZE, "analytic_phi"))
+        success = false;
+
+    copper_eos.finalize(&copper_eos);
+    delete_miegruneisen_table(table);
+
+    if (!success)
+        return (EXIT_FAILURE);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "eos.h"
+#include "eos_params.h"
+#include "stiffened_gas.h"
+#include "test_utils.h"
+
+#define PB_SIZE 2
+
+/**
+ * @brief Launch the test of the ideal and stiffened gas equations of state
+ *
+ * @return int : success (0) or failure (1)
+ */
+int main()
+{
+    // Air as an ideal gas (the stiffening pressure is ignored) and water as a stiffened gas
+    const EosParams_s air = {.type = IDEAL_GAS_EOS, .gas = {1.4, 6.e+08}};
+    const EosParams_s water = {.type = STIFFENED_GAS_EOS, .gas = {4.4, 6.e+08}};
+    const EosParams_s copper = {.type = MIEGRUNEISEN_EOS,
+                                .miegruneisen = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.}};
+    MieGruneisenEOS_s eos = {.table = NULL};
+
+    double specific_volume[PB_SIZE] = {1. / 1.2, 1. / 1000.};
+    double internal_energy[PB_SIZE] = {2.5e+05, 2.e+06};
+    double pressure[PB_SIZE] = {0., 0.};
+    double gamma_per_vol[PB_SIZE] = {0., 0.};
+    double cson[PB_SIZE] = {0., 0.};
+
+    // The arrays are allocated once for the largest size used
+    if (allocate_miegruneisen_arrays(&eos, PB_SIZE) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+
+    bool success = true;
+    const EosParams_s *materials[PB_SIZE] = {&air, &water};
+    const double expected_pressure[PB_SIZE] = {120000., 4160000000.};
+    const double expected_gamma[PB_SIZE] = {0.4 * 1.2, 3.4 * 1000.};
+    const double expected_cson[PB_SIZE] = {374.16573867739413, 4576.4615151883445};
+    for (unsigned int m = 0; m < PB_SIZE; ++m)
+    {
+        if (set_eos_params(&eos, materials[m]) == EXIT_FAILURE ||
+            eos.init(&eos, 1, specific_volume + m) == EXIT_FAILURE)
+        {
+            fprintf(stderr, "Unable to initialize the eos of the material %u!\n", m);
+            success = false;
+            continue;
+        }
+        eos.get_pressure_and_derivative(&eos, 1, specific_volume + m, internal_energy + m, pressure + m,
+                                        gamma_per_vol + m);
+        if (!almost_equal(gamma_per_vol[m], expected_gamma[m]))
+        {
+            fprintf(stderr, "dp/de of the material %u is %g instead of %g!\n", m, gamma_per_vol[m], expected_gamma[m]);
+            success = false;
+        }
+        eos.get_pressure_and_sound_speed(&eos, 1, specific_volume + m, internal_energy + m, pressure + m, cson + m);
+    }
+    if (!assert_equal_arrays(pressure, expected_pressure, PB_SIZE, "pressure"))
+        success = false;
+    if (!assert_equal_arrays(cson, expected_cson, PB_SIZE, "cson"))
+        success = false;
+
+    // Water below the stiffening pressure has a negative squared sound speed
+    const double water_volume[PB_SIZE] = {1. / 1000., 1. / 1000.};
+    const double water_energy[PB_SIZE] = {2.e+06, 1.e+05};
+    const bool expected_invalid[PB_SIZE] = {false, true};
+    unsigned int invalid_cells[PB_SIZE] = {0, 0};
+    set_eos_params(&eos, &water);
+    eos.init(&eos, PB_SIZE, water_volume);
+    const unsigned int nb_invalid = eos.get_pressure_and_sound_speed(&eos, PB_SIZE, water_volume, water_energy,
+                                                                      pressure, cson);
+    if (nb_invalid != 1 || !isnan(cson[1]) || !assert_equal_bool_arrays(eos.invalid_sound_speed, expected_invalid,
+                                                                         PB_SIZE, "invalid_sound_speed"))
+    {
+        fprintf(stderr, "The second cell of water should be the only invalid one!\n");
+        success = false;
+    }
+    if (list_invalid_sound_speeds(&eos, PB_SIZE, invalid_cells) != 1 ||
+        invalid_cells[0] != 1)
+    {
+        fprintf(stderr, "The invalid cell reported is %u instead of 1!\n", invalid_cells[0]);
+        success = false;
+    }
+
+    // The cache is invalidated by a change of type or of parameters
+    unsigned int nb_updated_cells[3] = {0, 0, 0};
+    const unsigned int expected_nb_updated_cells[3] = {0, PB_SIZE, PB_SIZE};
+    set_eos_params(&eos, &water);
+    update_miegruneisen_terms(&eos, PB_SIZE, specific_volume, NULL);
+    update_miegruneisen_terms(&eos, PB_SIZE, specific_volume, &nb_updated_cells[0]);
+    set_eos_params(&eos, &air);
+    update_miegruneisen_terms(&eos, PB_SIZE, specific_volume, &nb_updated_cells[1]);
+    set_eos_params(&eos, &copper);
+    update_miegruneisen_terms(&eos, PB_SIZE, specific_volume, &nb_updated_cells[2]);
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        if (nb_updated_cells[i] != expected_nb_updated_cells[i])
+        {
+            fprintf(stderr, "%u cells updated instead of %u at the call %u!\n", nb_updated_cells[i],
+                    expected_nb_updated_cells[i], i);
+            success = false;
+        }
+    }
+
+    // Invalid parameters
+    const EosParams_s invalid_gas = {.type = STIFFENED_GAS_EOS, .gas = {1., 0.}};
+    const EosParams_s unknown_type = {.type = (EosType_e)42};
+    if (set_eos_params(&eos, &invalid_gas) == EXIT_SUCCESS || set_eos_params(&eos, &unknown_type) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The invalid parameters should have been rejected!\n");
+        success = false;
+    }
+
+    eos.finalize(&eos);
+
+    if (!success)
+        return (EXIT_FAILURE);
+    return EXIT_SUCCESS;
+}
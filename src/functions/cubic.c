@@ -17,4 +17,35 @@ void cubic_function(__attribute__((unused)) void *params, const p_array x, p_arr
         fx->data[i] = x->data[i] * x->data[i] * x->data[i] - 2. * x->data[i] * x->data[i] + 1;
         dfx->data[i] = 3. * x->data[i] * x->data[i] - 4. * x->data[i];
     }
-}
\ No newline at end of file
+}
+
+
+void cubic_function_on_subset(__attribute__((unused)) void *params, const unsigned int *indices, const unsigned int nb_indices,
+                              const p_array x, p_array fx, p_array dfx)
+{
+    assert(is_valid_array(x));
+    assert(is_valid_array(fx));
+    assert(is_valid_array(dfx));
+    assert(nb_indices == fx->size);
+    assert(nb_indices == dfx->size);
+
+    for (unsigned int j = 0; j < nb_indices; ++j)
+    {
+        const double x_i = x->data[indices[j]];
+        fx->data[j] = x_i * x_i * x_i - 2. * x_i * x_i + 1;
+        dfx->data[j] = 3. * x_i * x_i - 4. * x_i;
+    }
+}
+
+
+void cubic_function_with_second_derivative(void *params, const p_array x, p_array fx, p_array dfx, p_array d2fx)
+{
+    assert(is_valid_array(d2fx));
+    assert(x->size == d2fx->size);
+
+    cubic_function(params, x, fx, dfx);
+    for (unsigned int i = 0; i < x->size; ++i)
+    {
+        d2fx->data[i] = 6. * x->data[i] - 4.;
+    }
+}
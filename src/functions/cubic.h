@@ -22,4 +22,26 @@
  */
 void cubic_function(void *params, const p_array x, p_array fx, p_array dfx);
 
+/**
+ * @brief Evaluate the value of \f$x^3 - 2x^2 + 1\f$ and its derivative
+ *        \f$3x^2 - 4x\f$ only for the indices given
+ * @param[in] indices : indices of the unknowns
+ * @param[in] nb_indices : number of indices
+ * @param[in] x : array of unknowns
+ * @param[out] fx : array of values of f (fx[j] is the value for x[indices[j]])
+ * @param[out] dfx : array of values of df/dx (same ordering as fx)
+ */
+void cubic_function_on_subset(void *params, const unsigned int *indices, const unsigned int nb_indices,
+                              const p_array x, p_array fx, p_array dfx);
+
+/**
+ * @brief Evaluate the value of \f$x^3 - 2x^2 + 1\f$, its derivative \f$3x^2 - 4x\f$
+ *        and its second derivative \f$6x - 4\f$
+ * @param[in] x : array of unknowns
+ * @param[out] fx : array of values of f
+ * @param[out] dfx : array of values of df/dx
+ * @param[out] d2fx : array of values of d2f/dx2
+ */
+void cubic_function_with_second_derivative(void *params, const p_array x, p_array fx, p_array dfx, p_array d2fx);
+
 #endif
\ No newline at end of file
@@ -1,11 +1,76 @@
 #include "vnr_internalenergy_evolution.h"
 #include <assert.h>
 #include <math.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "array.h"
 
+/**
+ * @brief Evaluate the function and its derivative from the terms of an eos affine in internal energy,
+ *        read in place : only the pressure at the current internal energy is computed.
+ *        Inlined in an aligned and an unaligned version.
+ *
+ * @param[in] nb_cells : number of cells
+ * @param[in] terms : view on the terms of the eos
+ * @param[in] v_old : previous specific volume
+ * @param[in] v_new : current specific volume
+ * @param[in] e_old : previous internal energy
+ * @param[in] p_old : previous pressure
+ * @param[in] x : unknown
+ * @param[out] func : values of the function
+ * @param[out] dfunc : values of the derivative of the function
+ */
+__attribute__((always_inline))
+static inline void evaluate_with_terms_view(const unsigned int nb_cells, const MieGruneisenTermsView_s *terms,
+                                            const double *restrict v_old, const double *restrict v_new,
+                                            const double *restrict e_old, const double *restrict p_old,
+                                            const double *restrict x, double *restrict func, double *restrict dfunc)
+{
+    const double *restrict phi = MIEGRUNEISEN_ASSUME_ALIGNED(terms->phi);
+    const double *restrict einth = MIEGRUNEISEN_ASSUME_ALIGNED(terms->einth);
+    const double *restrict gamma_per_vol = MIEGRUNEISEN_ASSUME_ALIGNED(terms->gamma_per_vol);
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        const double delta_v = v_new[i] - v_old[i];
+        const double pression = phi[i] + gamma_per_vol[i] * (x[i] - einth[i]);
+        func[i] = x[i] + (pression + p_old[i]) * delta_v * 0.5 - e_old[i];
+        dfunc[i] = 1. + gamma_per_vol[i] * delta_v * 0.5;
+    }
+}
+
+/**
+ * @brief Evaluate the function and its derivative when the eos is affine in internal energy,
+ *        on the aligned path of evaluate_with_terms_view if every array is aligned
+ *
+ * @param[in] vars : parameters of the equation
+ * @param[in] newton_var : unknown
+ * @param[out] func : values of the function
+ * @param[out] dfunc : values of the derivative of the function
+ */
+static void evaluate_affine_in_energy(const VnrParameters_s *vars, const p_array newton_var, p_array func,
+                                      p_array dfunc)
+{
+    const unsigned int pb_size = newton_var->size;
+    const MieGruneisenTermsView_s terms = get_miegruneisen_terms_view(vars->miegruneisen, pb_size);
+    if (is_aligned_array(vars->specific_volume_old) && is_aligned_array(vars->specific_volume_new) &&
+        is_aligned_array(vars->internal_energy_old) && is_aligned_array(vars->pressure) &&
+        is_aligned_array(newton_var) && is_aligned_array(func) && is_aligned_array(dfunc))
+    {
+        evaluate_with_terms_view(pb_size, &terms, ARRAY_ALIGNED_DATA(vars->specific_volume_old),
+                                 ARRAY_ALIGNED_DATA(vars->specific_volume_new),
+                                 ARRAY_ALIGNED_DATA(vars->internal_energy_old), ARRAY_ALIGNED_DATA(vars->pressure),
+                                 ARRAY_ALIGNED_DATA(newton_var), ARRAY_ALIGNED_DATA(func), ARRAY_ALIGNED_DATA(dfunc));
+    }
+    else
+    {
+        evaluate_with_terms_view(pb_size, &terms, vars->specific_volume_old->data, vars->specific_volume_new->data,
+                                 vars->internal_energy_old->data, vars->pressure->data, newton_var->data, func->data,
+                                 dfunc->data);
+    }
+}
+
 void internal_energy_evolution_VNR(void *variables, const p_array newton_var, p_array func, p_array dfunc)
 {
     assert(is_valid_array(newton_var));
@@ -25,28 +90,220 @@ void internal_energy_evolution_VNR(void *variables, const p_array newton_var, p_
 
     const unsigned int pb_size = newton_var->size;
 
-    BUILD_ARRAY(pression, pb_size)
-    BUILD_ARRAY(dpsurde, pb_size)
+    if (vars->miegruneisen->is_affine_in_energy)
+    {
+        evaluate_affine_in_energy(vars, newton_var, func, dfunc);
+        return;
+    }
 
-    p_array built_arrays[] = {pression, dpsurde};
-    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
-    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    // Use the scratch buffers if any, otherwise allocate them
+    double *pression = vars->eos_pressure;
+    double *dpsurde = vars->eos_dpsurde;
+    const bool owns_buffers = (pression == NULL || dpsurde == NULL);
+    if (owns_buffers)
     {
-        cleanup_memory(built_arrays, nb_arrays);
-        exit(1);
+        pression = allocate_array_data(pb_size);
+        dpsurde = allocate_array_data(pb_size);
+        if (pression == NULL || dpsurde == NULL)
+        {
+            fprintf(stderr, "Error during allocation of the eos scratch buffers (size requested : %u)!\n", pb_size);
+            free_array_data(pression);
+            free_array_data(dpsurde);
+            exit(1);
+        }
     }
 
     // Call of EOS
     vars->miegruneisen->get_pressure_and_derivative(vars->miegruneisen, pb_size, vars->specific_volume_new->data,
-                                                    newton_var->data, pression->data, dpsurde->data);
+                                                    newton_var->data, pression, dpsurde);
+    for (size_t i = 0; i < pb_size; ++i)
+    {
+        const double delta_v = vars->specific_volume_new->data[i] - vars->specific_volume_old->data[i];
+        // Function to vanish
+        func->data[i] = newton_var->data[i] + (pression[i] + vars->pressure->data[i]) * delta_v * 0.5 - vars->internal_energy_old->data[i];
+        // Derivative of the function to vanish
+        dfunc->data[i] = 1. + dpsurde[i] * delta_v * 0.5;
+    }
+
+    if (owns_buffers)
+    {
+        free_array_data(pression);
+        free_array_data(dpsurde);
+    }
+}
+
+void internal_energy_evolution_VNR_with_second_derivative(void *variables, const p_array newton_var,
+                                                          p_array func, p_array dfunc, p_array d2func)
+{
+    assert(is_valid_array(newton_var));
+    assert(is_valid_array(func));
+    assert(is_valid_array(dfunc));
+    assert(is_valid_array(d2func));
+    assert(newton_var->size == func->size);
+    assert(newton_var->size == dfunc->size);
+    assert(newton_var->size == d2func->size);
+
+    VnrParameters_s *vars = (VnrParameters_s *)variables;
+    assert(is_valid_array(vars->specific_volume_old));
+    assert(is_valid_array(vars->specific_volume_new));
+    assert(is_valid_array(vars->internal_energy_old));
+    assert(is_valid_array(vars->pressure));
+    assert(vars->specific_volume_old->size == vars->specific_volume_new->size);
+    assert(vars->specific_volume_old->size == vars->internal_energy_old->size);
+    assert(vars->specific_volume_old->size == vars->pressure->size);
+
+    const unsigned int pb_size = newton_var->size;
+
+    if (vars->miegruneisen->is_affine_in_energy)
+    {
+        // The second derivative of the pressure is null
+        evaluate_affine_in_energy(vars, newton_var, func, dfunc);
+        for (unsigned int i = 0; i < pb_size; ++i)
+            d2func->data[i] = 0.;
+        return;
+    }
+
+    // Use the scratch buffers if any, otherwise allocate them
+    double *pression = vars->eos_pressure;
+    double *dpsurde = vars->eos_dpsurde;
+    const bool owns_buffers = (pression == NULL || dpsurde == NULL);
+    if (owns_buffers)
+    {
+        pression = allocate_array_data(pb_size);
+        dpsurde = allocate_array_data(pb_size);
+        if (pression == NULL || dpsurde == NULL)
+        {
+            fprintf(stderr, "Error during allocation of the eos scratch buffers (size requested : %u)!\n", pb_size);
+            free_array_data(pression);
+            free_array_data(dpsurde);
+            exit(1);
+        }
+    }
+
+    // Call of EOS (the second derivative of the pressure is written in d2func and scaled below)
+    vars->miegruneisen->get_pressure_and_derivatives(vars->miegruneisen, pb_size, vars->specific_volume_new->data,
+                                                     newton_var->data, pression, dpsurde, d2func->data);
     for (size_t i = 0; i < pb_size; ++i)
     {
         const double delta_v = vars->specific_volume_new->data[i] - vars->specific_volume_old->data[i];
         // Function to vanish
-        func->data[i] = newton_var->data[i] + (pression->data[i] + vars->pressure->data[i]) * delta_v * 0.5 - vars->internal_energy_old->data[i];
+        func->data[i] = newton_var->data[i] + (pression[i] + vars->pressure->data[i]) * delta_v * 0.5 - vars->internal_energy_old->data[i];
         // Derivative of the function to vanish
-        dfunc->data[i] = 1. + dpsurde->data[i] * delta_v * 0.5;
+        dfunc->data[i] = 1. + dpsurde[i] * delta_v * 0.5;
+        // Second derivative of the function to vanish
+        d2func->data[i] = d2func->data[i] * delta_v * 0.5;
     }
 
-    cleanup_memory(built_arrays, nb_arrays);
+    if (owns_buffers)
+    {
+        free_array_data(pression);
+        free_array_data(dpsurde);
+    }
+}
+
+void internal_energy_evolution_VNR_on_subset(void *variables, const unsigned int *indices, const unsigned int nb_indices,
+                                             const p_array newton_var, p_array func, p_array dfunc)
+{
+    assert(is_valid_array(newton_var));
+    assert(is_valid_array(func));
+    assert(is_valid_array(dfunc));
+    assert(nb_indices <= newton_var->size);
+    assert(nb_indices == func->size);
+    assert(nb_indices == dfunc->size);
+
+    VnrParameters_s *vars = (VnrParameters_s *)variables;
+    assert(is_valid_array(vars->specific_volume_old));
+    assert(is_valid_array(vars->specific_volume_new));
+    assert(is_valid_array(vars->internal_energy_old));
+    assert(is_valid_array(vars->pressure));
+    assert(vars->specific_volume_old->size == newton_var->size);
+    assert(vars->specific_volume_new->size == newton_var->size);
+    assert(vars->internal_energy_old->size == newton_var->size);
+    assert(vars->pressure->size == newton_var->size);
+
+    if (vars->miegruneisen->is_affine_in_energy)
+    {
+        const MieGruneisenTermsView_s terms = get_miegruneisen_terms_view(vars->miegruneisen, newton_var->size);
+        for (unsigned int j = 0; j < nb_indices; ++j)
+        {
+            const unsigned int i = indices[j];
+            const double delta_v = vars->specific_volume_new->data[i] - vars->specific_volume_old->data[i];
+            const double pression = terms.phi[i] + terms.gamma_per_vol[i] * (newton_var->data[i] - terms.einth[i]);
+            func->data[j] = newton_var->data[i] + (pression + vars->pressure->data[i]) * delta_v * 0.5 - vars->internal_energy_old->data[i];
+            dfunc->data[j] = 1. + terms.gamma_per_vol[i] * delta_v * 0.5;
+        }
+        return;
+    }
+
+    // Use the scratch buffers if any, otherwise allocate them
+    double *pression = vars->eos_pressure;
+    double *dpsurde = vars->eos_dpsurde;
+    const bool owns_buffers = (pression == NULL || dpsurde == NULL);
+    if (owns_buffers)
+    {
+        pression = allocate_array_data(nb_indices);
+        dpsurde = allocate_array_data(nb_indices);
+        if (pression == NULL || dpsurde == NULL)
+        {
+            fprintf(stderr, "Error during allocation of the eos scratch buffers (size requested : %u)!\n", nb_indices);
+            free_array_data(pression);
+            free_array_data(dpsurde);
+            exit(1);
+        }
+    }
+
+    // Call of EOS
+    vars->miegruneisen->get_pressure_and_derivative_on_subset(vars->miegruneisen, indices, nb_indices,
+                                                              newton_var->data, pression, dpsurde);
+    for (size_t j = 0; j < nb_indices; ++j)
+    {
+        const unsigned int i = indices[j];
+        const double delta_v = vars->specific_volume_new->data[i] - vars->specific_volume_old->data[i];
+        // Function to vanish
+        func->data[j] = newton_var->data[i] + (pression[j] + vars->pressure->data[i]) * delta_v * 0.5 - vars->internal_energy_old->data[i];
+        // Derivative of the function to vanish
+        dfunc->data[j] = 1. + dpsurde[j] * delta_v * 0.5;
+    }
+
+    if (owns_buffers)
+    {
+        free_array_data(pression);
+        free_array_data(dpsurde);
+    }
+}
+
+
+int solve_internal_energy_evolution_VNR_direct(void *variables, p_array solution)
+{
+    assert(is_valid_array(solution));
+
+    VnrParameters_s *vars = (VnrParameters_s *)variables;
+    assert(is_valid_array(vars->specific_volume_old));
+    assert(is_valid_array(vars->specific_volume_new));
+    assert(is_valid_array(vars->internal_energy_old));
+    assert(is_valid_array(vars->pressure));
+    assert(vars->specific_volume_old->size == solution->size);
+    assert(vars->specific_volume_new->size == solution->size);
+    assert(vars->internal_energy_old->size == solution->size);
+    assert(vars->pressure->size == solution->size);
+
+    if (!vars->miegruneisen->is_affine_in_energy)
+    {
+        fprintf(stderr, "The eos is not affine in internal energy, the equation cannot be solved directly!\n");
+        return EXIT_FAILURE;
+    }
+
+    const unsigned int pb_size = solution->size;
+    const MieGruneisenTermsView_s terms = get_miegruneisen_terms_view(vars->miegruneisen, pb_size);
+    for (size_t i = 0; i < pb_size; ++i)
+    {
+        const double delta_v = vars->specific_volume_new->data[i] - vars->specific_volume_old->data[i];
+        const double e_old = vars->internal_energy_old->data[i];
+        // Pressure at the previous internal energy, function and its derivative at e_old
+        const double pression = terms.phi[i] + terms.gamma_per_vol[i] * (e_old - terms.einth[i]);
+        const double func = e_old + (pression + vars->pressure->data[i]) * delta_v * 0.5 - e_old;
+        const double dfunc = 1. + terms.gamma_per_vol[i] * delta_v * 0.5;
+        solution->data[i] = e_old - func / dfunc;
+    }
+    return EXIT_SUCCESS;
 }
@@ -31,6 +31,10 @@ typedef struct VnrParameters
     const p_array internal_energy_old;  /**< Previous internal energy */
     const p_array pressure;  /**< Previous pressure */
     MieGruneisenEOS_s *miegruneisen;  /**< Parameters of the underlying eos (here MieGruneisen) */
+    double *eos_pressure;  /**< Scratch buffer for the pressure computed by an eos that is not affine in internal energy
+                                (allocated at each call if NULL) */
+    double *eos_dpsurde;  /**< Scratch buffer for dp/de computed by an eos that is not affine in internal energy
+                               (allocated at each call if NULL) */
 } VnrParameters_s;
 
 /**
@@ -40,6 +44,11 @@ typedef struct VnrParameters
  
  * \f$ e_i^{n+1} + \frac{P^n + P^{n+1}}{2} * (\frac{1}{\rho^{n+1}} - \frac{1}{\rho^n}) - e_i^n = 0\f$
  * 
+ * If the eos is affine in internal energy, its terms are read in place through get_miegruneisen_terms_view :
+ * only the pressure at the current internal energy is computed and the scratch buffers are unused.
+ * Otherwise the eos is called (get_pressure_and_derivative) : if the scratch buffers of the parameters
+ * are set, they should be at least as large as the unknown and no memory is allocated.
+ *
  * @param[in] parameters : parameters of the function
  * @param[in] newton_var : unknown of the function (here it is internal energy)
  * @param[out] func : values of the function
@@ -48,4 +57,62 @@ typedef struct VnrParameters
 void internal_energy_evolution_VNR(void *parameters, const p_array newton_var,
                                    p_array func, p_array dfunc);
 
-#endif
\ No newline at end of file
+/**
+ * @brief Evaluate the fonction governing the evolution of internal energy in the VNR scheme,
+ *        its derivative and its second derivative with respect to internal energy :
+ *
+ * \f$ \frac{d^2 f}{de^2} = \frac{d^2 P}{de^2} \frac{\Delta v}{2}\f$
+ *
+ * The second derivative of the pressure is null for an eos affine in internal energy, whose terms are
+ * read in place as in internal_energy_evolution_VNR. Otherwise it is given by the eos
+ * (get_pressure_and_derivatives) and the scratch buffers are used as in internal_energy_evolution_VNR.
+ *
+ * @param[in] parameters : parameters of the function
+ * @param[in] newton_var : unknown of the function (here it is internal energy)
+ * @param[out] func : values of the function
+ * @param[out] dfunc : values of the derivative of the function with respect to internal energy
+ * @param[out] d2func : values of the second derivative of the function with respect to internal energy
+ */
+void internal_energy_evolution_VNR_with_second_derivative(void *parameters, const p_array newton_var,
+                                                          p_array func, p_array dfunc, p_array d2func);
+
+/**
+ * @brief Evaluate the fonction governing the evolution of internal energy in the VNR scheme,
+ *        and its derivative, only for the cells which indices are given.
+ *        This function is meant to be used with the active set mode of the Newton solver.
+ * 
+ * The terms of an eos affine in internal energy are read in place, as in internal_energy_evolution_VNR.
+ * Otherwise, if the scratch buffers of the parameters are set, they should be at least nb_indices long
+ * and no memory is allocated.
+ *
+ * @param[in] parameters : parameters of the function
+ * @param[in] indices : indices of the cells
+ * @param[in] nb_indices : number of indices
+ * @param[in] newton_var : unknown of the function (here it is internal energy), indexed by cell
+ * @param[out] func : values of the function (func->data[j] is the value for the cell indices[j])
+ * @param[out] dfunc : values of the derivative of the function (same ordering as func)
+ */
+void internal_energy_evolution_VNR_on_subset(void *parameters, const unsigned int *indices, const unsigned int nb_indices,
+                                             const p_array newton_var, p_array func, p_array dfunc);
+
+/**
+ * @brief Solve the equation governing the evolution of internal energy in the VNR scheme without
+ *        iteration. This is possible only if the eos is affine in internal energy (is_affine_in_energy)
+ *        because the function to vanish is then affine in the unknown.
+ *
+ * With \f$p^{n+1} = p(e^n) + \frac{dp}{de} (e^{n+1} - e^n)\f$ the solution is :
+ *
+ * \f$ e^{n+1} = e^n - \frac{(p(e^n) + P^n) \frac{\Delta v}{2}}{1 + \frac{dp}{de} \frac{\Delta v}{2}}\f$
+ *
+ * that is to say exactly one Newton-Raphson step starting from \f$e^n\f$.
+ *
+ * The terms of the eos are read in place (get_miegruneisen_terms_view) : the scratch buffers are unused.
+ *
+ * @param[in] parameters : parameters of the function (the eos should have been initialized)
+ * @param[out] solution : the internal energy at next time step
+ * @return EXIT_SUCCESS (0) in case of success
+ *         EXIT_FAILURE (1) if the eos is not affine in internal energy
+ */
+int solve_internal_energy_evolution_VNR_direct(void *parameters, p_array solution);
+
+#endif
@@ -0,0 +1,393 @@
+#include "vnr_internalenergy_fused.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "array.h"
+#include "array_float.h"
+#include "miegruneisen_float.h"
+#include "stop_criterions.h"
+
+/**
+ * @brief Default controls used when none are given
+ *
+ */
+static const NewtonControls_s default_controls = NEWTON_DEFAULT_CONTROLS;
+
+/**
+ * @brief Fused Newton-Raphson sweeps of solve_internal_energy_evolution_VNR_fused, starting from the
+ *        current values of the unknown
+ *
+ * @param[in] parameters : parameters of the function (the eos should have been initialized)
+ * @param[in,out] x_sol : initial values of the internal energy, then solution
+ * @param[in,out] has_converged : scratch buffer for the convergence markers
+ * @param[in] controls : maximum number of iterations and tolerances (NULL for the default ones)
+ * @param[out] report : report of the solve (may be NULL)
+ * @return EXIT_SUCCESS (0) in case of success
+ *         EXIT_FAILURE (1) otherwise
+ */
+static int fused_sweeps(const VnrParameters_s *parameters, p_array x_sol, bool *has_converged,
+                        const NewtonControls_s *controls, NewtonReport_s *report)
+{
+    const unsigned int pb_size = x_sol->size;
+    const double *const v_old = parameters->specific_volume_old->data;
+    const double *const v_new = parameters->specific_volume_new->data;
+    const double *const e_old = parameters->internal_energy_old->data;
+    const double *const p_old = parameters->pressure->data;
+    const MieGruneisenTermsView_s terms = get_miegruneisen_terms_view(parameters->miegruneisen, pb_size);
+    const double *const phi = terms.phi;
+    const double *const einth = terms.einth;
+    const double *const gamma_per_vol = terms.gamma_per_vol;
+    if (controls == NULL)
+        controls = &default_controls;
+    const int nb_iter_max = controls->nb_iter_max;
+    const ConvergenceTolerances_s *const tolerances = &controls->tolerances;
+    double *const x = x_sol->data;
+
+    memset(has_converged, 0, pb_size * sizeof(bool));
+    if (report)
+        reset_newton_report(report);
+
+    for (int iter = 0; iter <= nb_iter_max; ++iter)
+    {
+        const bool last_iteration = iter == nb_iter_max;
+        bool all_converged = true;
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            if (has_converged[i])
+                continue;
+            const double delta_v = v_new[i] - v_old[i];
+            // Eos
+            const double pression = phi[i] + gamma_per_vol[i] * (x[i] - einth[i]);
+            // Function to vanish and its derivative
+            const double func = x[i] + (pression + p_old[i]) * delta_v * 0.5 - e_old[i];
+            const double dfunc = 1. + gamma_per_vol[i] * delta_v * 0.5;
+            // Classical incrementation
+            const double delta_x = -func / dfunc;
+            x[i] += delta_x;
+            // Relative gap
+            const double epsilon = tolerances->epsilon_per_cell ? tolerances->epsilon_per_cell[i] : tolerances->epsilon;
+            const double precision = tolerances->precision_per_cell ? tolerances->precision_per_cell[i] : tolerances->precision;
+            if (fabs(func) < epsilon * fabs(delta_x) + precision)
+            {
+                has_converged[i] = true;
+            }
+            else
+            {
+                all_converged = false;
+            }
+            if (report && (has_converged[i] || last_iteration))
+                record_cell_in_newton_report(report, iter + 1, has_converged[i], func);
+        }
+        if (all_converged)
+        {
+            return EXIT_SUCCESS;
+        }
+    }
+
+    fprintf(stderr, "Maximum iterations number reached (%d)!\n", nb_iter_max);
+    fprintf(stderr, "Newton-Raphson algorithm has not converged!\n");
+    return EXIT_FAILURE;
+}
+
+int solve_internal_energy_evolution_VNR_fused(const VnrParameters_s *parameters, const p_array x_ini, p_array x_sol,
+                                              bool *has_converged, const NewtonControls_s *controls,
+                                              NewtonReport_s *report)
+{
+    assert(is_valid_array(x_ini));
+    assert(is_valid_array(x_sol));
+    assert(x_ini->size == x_sol->size);
+    assert(parameters->specific_volume_old->size == x_ini->size);
+    assert(parameters->specific_volume_new->size == x_ini->size);
+    assert(parameters->internal_energy_old->size == x_ini->size);
+    assert(parameters->pressure->size == x_ini->size);
+
+    if (!parameters->miegruneisen->is_affine_in_energy)
+    {
+        fprintf(stderr, "The eos is not affine in internal energy, the fused kernel cannot be used!\n");
+        return EXIT_FAILURE;
+    }
+    if (copy_array(x_ini, x_sol) == EXIT_FAILURE) {
+        fprintf(stderr, "Unable to initialize the Newton-Raphson solver!\n");
+        return EXIT_FAILURE;
+    }
+    return fused_sweeps(parameters, x_sol, has_converged, controls, report);
+}
+
+int solve_internal_energy_evolution_VNR_cell_major(const VnrParameters_s *parameters, const p_array x_ini, p_array x_sol,
+                                                   const NewtonControls_s *controls, NewtonReport_s *report)
+{
+    assert(is_valid_array(x_ini));
+    assert(is_valid_array(x_sol));
+    assert(x_ini->size == x_sol->size);
+    assert(parameters->specific_volume_old->size == x_ini->size);
+    assert(parameters->specific_volume_new->size == x_ini->size);
+    assert(parameters->internal_energy_old->size == x_ini->size);
+    assert(parameters->pressure->size == x_ini->size);
+
+    if (!parameters->miegruneisen->is_affine_in_energy)
+    {
+        fprintf(stderr, "The eos is not affine in internal energy, the cell major kernel cannot be used!\n");
+        return EXIT_FAILURE;
+    }
+    const unsigned int pb_size = x_ini->size;
+    const double *const v_old = parameters->specific_volume_old->data;
+    const double *const v_new = parameters->specific_volume_new->data;
+    const double *const e_old = parameters->internal_energy_old->data;
+    const double *const p_old = parameters->pressure->data;
+    const MieGruneisenTermsView_s terms = get_miegruneisen_terms_view(parameters->miegruneisen, pb_size);
+    const double *const phi = terms.phi;
+    const double *const einth = terms.einth;
+    const double *const gamma_per_vol = terms.gamma_per_vol;
+    const double *const x_0 = x_ini->data;
+    if (controls == NULL)
+        controls = &default_controls;
+    const int nb_iter_max = controls->nb_iter_max;
+    const ConvergenceTolerances_s *const tolerances = &controls->tolerances;
+    double *const x = x_sol->data;
+
+    if (report)
+        reset_newton_report(report);
+
+    unsigned int nb_unconverged = 0;
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        // Everything that does not depend on the unknown is computed once
+        const double half_delta_v = (v_new[i] - v_old[i]) * 0.5;
+        const double dfunc = 1. + gamma_per_vol[i] * half_delta_v;
+        const double epsilon = tolerances->epsilon_per_cell ? tolerances->epsilon_per_cell[i] : tolerances->epsilon;
+        const double precision = tolerances->precision_per_cell ? tolerances->precision_per_cell[i] : tolerances->precision;
+        double x_i = x_0[i];
+        double func = 0.;
+        bool converged = false;
+        int iter = 0;
+        for (; iter <= nb_iter_max && !converged; ++iter)
+        {
+            const double pression = phi[i] + gamma_per_vol[i] * (x_i - einth[i]);
+            func = x_i + (pression + p_old[i]) * half_delta_v - e_old[i];
+            const double delta_x = -func / dfunc;
+            x_i += delta_x;
+            converged = fabs(func) < epsilon * fabs(delta_x) + precision;
+        }
+        x[i] = x_i;
+        if (!converged)
+            ++nb_unconverged;
+        if (report)
+            record_cell_in_newton_report(report, iter, converged, func);
+    }
+
+    if (nb_unconverged > 0)
+    {
+        fprintf(stderr, "Maximum iterations number reached (%d) for %u cells!\n", nb_iter_max, nb_unconverged);
+        fprintf(stderr, "Newton-Raphson algorithm has not converged!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief One Newton-Raphson step of a cell in single precision. The cell is converged if the relative gap
+ *        holds or if the increment is below the resolution of the float representation of the energies.
+ *
+ * @param[in] x : current value of the unknown
+ * @param[in] half_delta_v : half the variation of the specific volume
+ * @param[in] e_old : previous internal energy
+ * @param[in] p_old : previous pressure
+ * @param[in] phi : pressure along the Hugoniot
+ * @param[in] einth : internal energy along the Hugoniot
+ * @param[in] gamma_per_vol : dp/de
+ * @param[in] epsilon : relative tolerance of the relative gap
+ * @param[in] precision : absolute tolerance of the relative gap
+ * @param[out] func : value of the function
+ * @param[out] converged : 1 if the cell has converged, 0 otherwise
+ * @return float : the increment of the unknown
+ */
+static inline float float_newton_step(const float x, const float half_delta_v, const float e_old, const float p_old,
+                                      const float phi, const float einth, const float gamma_per_vol,
+                                      const float epsilon, const float precision, float *func, int *converged)
+{
+    const float pression = phi + gamma_per_vol * (x - einth);
+    const float f = x + (pression + p_old) * half_delta_v - e_old;
+    const float dfunc = 1.f + gamma_per_vol * half_delta_v;
+    const float delta_x = -f / dfunc;
+    *func = f;
+    *converged = (fabsf(f) < epsilon * fabsf(delta_x) + precision) |
+                 (fabsf(delta_x) <= VNR_FLOAT_RESOLUTION * (fabsf(x) + fabsf(e_old)));
+    return delta_x;
+}
+
+/**
+ * @brief Sweep of solve_internal_energy_evolution_VNR_float. Every cell is updated, the converged ones
+ *        by less than the float resolution, so that the loop holds no convergence marker and is vectorized.
+ *
+ * @return unsigned int : number of unconverged cells before the sweep
+ */
+static unsigned int float_sweep(const unsigned int nb_cells, const float epsilon, const float precision,
+                                const float *restrict v_old, const float *restrict v_new, const float *restrict e_old,
+                                const float *restrict p_old, const float *restrict phi, const float *restrict einth,
+                                const float *restrict gamma_per_vol, float *restrict x)
+{
+    unsigned int nb_unconverged = 0;
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        float func;
+        int converged;
+        x[i] += float_newton_step(x[i], (v_new[i] - v_old[i]) * 0.5f, e_old[i], p_old[i], phi[i], einth[i],
+                                  gamma_per_vol[i], epsilon, precision, &func, &converged);
+        nb_unconverged += 1 - converged;
+    }
+    return nb_unconverged;
+}
+
+int solve_internal_energy_evolution_VNR_float(const VnrParametersFloat_s *parameters, const p_array_f x_ini,
+                                              p_array_f x_sol, const NewtonControls_s *controls,
+                                              NewtonReport_s *report)
+{
+    assert(is_valid_array_f(x_ini));
+    assert(is_valid_array_f(x_sol));
+    assert(x_ini->size == x_sol->size);
+    assert(parameters->specific_volume_old->size == x_ini->size);
+    assert(parameters->specific_volume_new->size == x_ini->size);
+    assert(parameters->internal_energy_old->size == x_ini->size);
+    assert(parameters->pressure->size == x_ini->size);
+    assert(parameters->terms->nb_cells >= x_ini->size);
+
+    if (copy_array_f(x_ini, x_sol) == EXIT_FAILURE) {
+        fprintf(stderr, "Unable to initialize the Newton-Raphson solver!\n");
+        return EXIT_FAILURE;
+    }
+    const unsigned int pb_size = x_sol->size;
+    const float *const v_old = parameters->specific_volume_old->data;
+    const float *const v_new = parameters->specific_volume_new->data;
+    const float *const e_old = parameters->internal_energy_old->data;
+    const float *const p_old = parameters->pressure->data;
+    const float *const phi = parameters->terms->phi;
+    const float *const einth = parameters->terms->einth;
+    const float *const gamma_per_vol = parameters->terms->gamma_per_vol;
+    if (controls == NULL)
+        controls = &default_controls;
+    const int nb_iter_max = controls->nb_iter_max;
+    const float epsilon = (float)controls->tolerances.epsilon;
+    const float precision = (float)controls->tolerances.precision;
+    float *const x = x_sol->data;
+
+    unsigned int nb_unconverged = pb_size;
+    int nb_sweeps = 0;
+    while (nb_unconverged > 0 && nb_sweeps <= nb_iter_max)
+    {
+        nb_unconverged = float_sweep(pb_size, epsilon, precision, v_old, v_new, e_old, p_old, phi, einth,
+                                     gamma_per_vol, x);
+        ++nb_sweeps;
+    }
+
+    if (report)
+    {
+        reset_newton_report(report);
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            float func;
+            int converged;
+            float_newton_step(x[i], (v_new[i] - v_old[i]) * 0.5f, e_old[i], p_old[i], phi[i], einth[i],
+                              gamma_per_vol[i], epsilon, precision, &func, &converged);
+            record_cell_in_newton_report(report, nb_sweeps, nb_unconverged == 0 || converged, func);
+        }
+    }
+
+    if (nb_unconverged > 0)
+    {
+        fprintf(stderr, "Maximum iterations number reached (%d) for %u cells!\n", nb_iter_max, nb_unconverged);
+        fprintf(stderr, "Newton-Raphson algorithm has not converged!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Sweep of the float stage of solve_internal_energy_evolution_VNR_mixed, which stops on the
+ *        stagnation of the unknown only (see float_sweep)
+ *
+ * @return unsigned int : number of unconverged cells before the sweep
+ */
+static unsigned int mixed_float_sweep(const unsigned int nb_cells, const float *restrict half_delta_v,
+                                      const float *restrict e_old, const float *restrict p_old,
+                                      const float *restrict phi, const float *restrict einth,
+                                      const float *restrict gamma_per_vol, float *restrict x)
+{
+    unsigned int nb_unconverged = 0;
+    for (unsigned int i = 0; i < nb_cells; ++i)
+    {
+        float func;
+        int converged;
+        x[i] += float_newton_step(x[i], half_delta_v[i], e_old[i], p_old[i], phi[i], einth[i], gamma_per_vol[i], 0.f,
+                                  0.f, &func, &converged);
+        nb_unconverged += 1 - converged;
+    }
+    return nb_unconverged;
+}
+
+int solve_internal_energy_evolution_VNR_mixed(const VnrParameters_s *parameters, const p_array x_ini, p_array x_sol,
+                                              bool *has_converged, float *float_buffer,
+                                              const NewtonControls_s *controls, NewtonReport_s *report)
+{
+    assert(is_valid_array(x_ini));
+    assert(is_valid_array(x_sol));
+    assert(x_ini->size == x_sol->size);
+    assert(parameters->specific_volume_old->size == x_ini->size);
+    assert(parameters->specific_volume_new->size == x_ini->size);
+    assert(parameters->internal_energy_old->size == x_ini->size);
+    assert(parameters->pressure->size == x_ini->size);
+
+    if (!parameters->miegruneisen->is_affine_in_energy)
+    {
+        fprintf(stderr, "The eos is not affine in internal energy, the mixed precision kernel cannot be used!\n");
+        return EXIT_FAILURE;
+    }
+    const unsigned int pb_size = x_ini->size;
+    float *buffer = float_buffer;
+    if (buffer == NULL)
+    {
+        buffer = (float *)malloc(VNR_MIXED_NB_FLOAT_ARRAYS * (size_t)pb_size * sizeof(float));
+        if (buffer == NULL)
+        {
+            fprintf(stderr, "The allocation of the single precision arrays of the mixed solve has failed!\n");
+            return EXIT_FAILURE;
+        }
+    }
+    float *const x = buffer;
+    float *const half_delta_v = buffer + pb_size;
+    float *const e_old = buffer + 2 * pb_size;
+    float *const p_old = buffer + 3 * pb_size;
+    float *const phi = buffer + 4 * pb_size;
+    float *const einth = buffer + 5 * pb_size;
+    float *const gamma_per_vol = buffer + 6 * pb_size;
+    const double *const v_old_d = parameters->specific_volume_old->data;
+    const double *const v_new_d = parameters->specific_volume_new->data;
+    const MieGruneisenTermsView_s terms = get_miegruneisen_terms_view(parameters->miegruneisen, pb_size);
+    // The variation of the specific volume is rounded once computed, to avoid the cancellation in float
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        x[i] = (float)x_ini->data[i];
+        half_delta_v[i] = (float)((v_new_d[i] - v_old_d[i]) * 0.5);
+        e_old[i] = (float)parameters->internal_energy_old->data[i];
+        p_old[i] = (float)parameters->pressure->data[i];
+        phi[i] = (float)terms.phi[i];
+        einth[i] = (float)terms.einth[i];
+        gamma_per_vol[i] = (float)terms.gamma_per_vol[i];
+    }
+
+    if (controls == NULL)
+        controls = &default_controls;
+    unsigned int nb_unconverged = pb_size;
+    for (int sweep = 0; sweep <= controls->nb_iter_max && nb_unconverged > 0; ++sweep)
+        nb_unconverged = mixed_float_sweep(pb_size, half_delta_v, e_old, p_old, phi, einth, gamma_per_vol, x);
+
+    // The double precision sweeps refine the float solution up to the requested tolerances
+    for (unsigned int i = 0; i < pb_size; ++i)
+        x_sol->data[i] = (double)x[i];
+    if (float_buffer == NULL)
+        free(buffer);
+    return fused_sweeps(parameters, x_sol, has_converged, controls, report);
+}
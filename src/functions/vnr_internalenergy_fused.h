@@ -0,0 +1,149 @@
+/**
+ * @file vnr_internalenergy_fused.h
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Fused Newton-Raphson kernel solving the evolution of internal energy in the VNR scheme
+ *        with the MieGruneisen equation of state
+ * @version 0.1
+ * @date 2020-05-04
+ * 
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ * 
+ */
+#ifndef VNR_INTERNALENERGY_FUSED_H
+#define VNR_INTERNALENERGY_FUSED_H
+
+#include <float.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "array.h"
+#include "array_float.h"
+#include "miegruneisen_float.h"
+#include "newton.h"
+#include "vnr_internalenergy_evolution.h"
+
+/**
+ * @brief Relative increment below which the single precision iterations have stagnated
+ *
+ */
+#define VNR_FLOAT_RESOLUTION (4.f * FLT_EPSILON)
+
+/**
+ * @brief Number of float arrays of the buffer of solve_internal_energy_evolution_VNR_mixed
+ *        (unknown, half variation of the specific volume, previous internal energy and pressure,
+ *        phi, einth and gamma_per_vol)
+ *
+ */
+#define VNR_MIXED_NB_FLOAT_ARRAYS 7
+
+/**
+ * @brief Single precision counterpart of VnrParameters_s
+ *
+ */
+typedef struct VnrParametersFloat
+{
+    const p_array_f specific_volume_old; /**< Previous specific volume */
+    const p_array_f specific_volume_new;  /**< Current specific volume */
+    const p_array_f internal_energy_old;  /**< Previous internal energy */
+    const p_array_f pressure;  /**< Previous pressure */
+    const MieGruneisenFloatTerms_s *terms;  /**< Terms of the eos at the current specific volume */
+} VnrParametersFloat_s;
+
+/**
+ * @brief Solve the equation governing the evolution of internal energy in the VNR scheme
+ *        with a Newton-Raphson algorithm where, for each cell, the evaluation of the eos, of the
+ *        function and its derivative, the classical incrementation, the update of the unknown
+ *        and the relative gap convergence test are done in a single pass.
+ * 
+ * The results are the same as the ones of solveNewton used with internal_energy_evolution_VNR,
+ * classical_incrementation and relative_gap, but there is no indirect call and no intermediate
+ * array. The pressure is computed from the terms of the eos as an affine function of the internal
+ * energy : the eos should be affine in internal energy (is_affine_in_energy).
+ *
+ * @param[in] parameters : parameters of the function (the eos should have been initialized)
+ * @param[in] x_ini : initial values of the internal energy
+ * @param[out] x_sol : solution
+ * @param[in,out] has_converged : scratch buffer for the convergence markers (at least as large as x_ini)
+ * @param[in] controls : maximum number of iterations and tolerances (NULL for the default ones)
+ * @param[out] report : report of the solve (may be NULL)
+ * @warning : the solution is modified in any cases, even in case of FAILURE!
+ * 
+ * @return EXIT_SUCCESS (0) in case of success
+ *         EXIT_FAILURE (1) if the eos is not affine in internal energy or the solve has not converged
+ */
+int solve_internal_energy_evolution_VNR_fused(const VnrParameters_s *parameters, const p_array x_ini, p_array x_sol,
+                                              bool *has_converged, const NewtonControls_s *controls,
+                                              NewtonReport_s *report);
+
+/**
+ * @brief Solve the equation governing the evolution of internal energy in the VNR scheme
+ *        cell by cell : the Newton-Raphson iterations of a cell are run until its convergence,
+ *        with the whole state of the cell kept in registers, before moving to the next cell.
+ *        Thus a cell that needs many iterations does not make the other ones iterate.
+ * 
+ * The results are the same as the ones of solve_internal_energy_evolution_VNR_fused, the eos
+ * should thus be affine in internal energy (is_affine_in_energy) too.
+ *
+ * @param[in] parameters : parameters of the function (the eos should have been initialized)
+ * @param[in] x_ini : initial values of the internal energy
+ * @param[out] x_sol : solution
+ * @param[in] controls : maximum number of iterations of each cell and tolerances (NULL for the default ones)
+ * @param[out] report : report of the solve (may be NULL)
+ * @warning : the solution is modified in any cases, even in case of FAILURE!
+ * 
+ * @return EXIT_SUCCESS (0) in case of success
+ *         EXIT_FAILURE (1) if the eos is not affine in internal energy or at least one cell has not converged
+ */
+int solve_internal_energy_evolution_VNR_cell_major(const VnrParameters_s *parameters, const p_array x_ini, p_array x_sol,
+                                                   const NewtonControls_s *controls, NewtonReport_s *report);
+
+/**
+ * @brief Same as solve_internal_energy_evolution_VNR_fused with single precision storage and arithmetic.
+ *        A cell has converged when the relative gap holds or when its increment is below
+ *        VNR_FLOAT_RESOLUTION times the magnitude of the energies : the default tolerances are
+ *        beyond the reach of float, hence the solution is accurate to a few FLT_EPSILON only.
+ *
+ * Unlike the double precision kernels, every cell is iterated until all of them have converged,
+ * the extra steps of the converged cells being below the float resolution : the sweeps then hold
+ * no convergence marker and are vectorized. The per cell tolerances of the controls are ignored.
+ * The report records every cell with the number of sweeps done.
+ *
+ * @param[in] parameters : parameters of the function (the float terms of the eos should have been computed)
+ * @param[in] x_ini : initial values of the internal energy
+ * @param[out] x_sol : solution
+ * @param[in] controls : maximum number of iterations and tolerances (NULL for the default ones)
+ * @param[out] report : report of the solve (may be NULL)
+ * @warning : the solution is modified in any cases, even in case of FAILURE!
+ *
+ * @return EXIT_SUCCESS (0) in case of success
+ *         EXIT_FAILURE (1) otherwise
+ */
+int solve_internal_energy_evolution_VNR_float(const VnrParametersFloat_s *parameters, const p_array_f x_ini,
+                                              p_array_f x_sol, const NewtonControls_s *controls,
+                                              NewtonReport_s *report);
+
+/**
+ * @brief Mixed precision solve : the iterations are run in single precision until the unknown stagnates,
+ *        then refined by the double precision sweeps of solve_internal_energy_evolution_VNR_fused
+ *        (usually one or two) up to the requested tolerances.
+ *
+ * The report holds the double precision iterations only. As for the fused kernel, the eos should be
+ * affine in internal energy (is_affine_in_energy).
+ *
+ * @param[in] parameters : parameters of the function (the eos should have been initialized)
+ * @param[in] x_ini : initial values of the internal energy
+ * @param[out] x_sol : solution
+ * @param[in,out] has_converged : scratch buffer for the convergence markers (at least as large as x_ini)
+ * @param[in,out] float_buffer : scratch buffer of VNR_MIXED_NB_FLOAT_ARRAYS times the size of x_ini floats
+ *                               (allocated at each call if NULL)
+ * @param[in] controls : maximum number of iterations and tolerances (NULL for the default ones)
+ * @param[out] report : report of the solve (may be NULL)
+ * @warning : the solution is modified in any cases, even in case of FAILURE!
+ *
+ * @return EXIT_SUCCESS (0) in case of success
+ *         EXIT_FAILURE (1) if the eos is not affine in internal energy or the solve has not converged
+ */
+int solve_internal_energy_evolution_VNR_mixed(const VnrParameters_s *parameters, const p_array x_ini, p_array x_sol,
+                                              bool *has_converged, float *float_buffer,
+                                              const NewtonControls_s *controls, NewtonReport_s *report);
+
+#endif
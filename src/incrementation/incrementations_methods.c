@@ -1,6 +1,468 @@
 #include <assert.h>
+#include <math.h>
 #include <stdlib.h>
 #include "array.h"
+#include "array_float.h"
+#include "simd_dispatch.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Coefficient of the damped incrementation
+ *
+ */
+#define DAMPING_COEFF 0.5
+
+/**
+ * @brief Bound of the relative correction of the derivative by the Halley formula (f d2f / (2 df^2)),
+ *        beyond which the classical increment is taken instead
+ *
+ */
+#define HALLEY_MAX_CORRECTION 0.5
+
+/**
+ * @brief Prototype of the kernels computing the increments on raw arrays.
+ *        The classical and damped kernels do not read x_k, which may be NULL
+ *
+ */
+typedef void (*increment_kernel_fct_ptr)(const double *x_k, const double *func, const double *dfunc,
+                                         double *delta_x, const size_t size);
+
+/**
+ * @brief The kernels chosen according to the SIMD level of the processor
+ *
+ */
+static struct
+{
+    increment_kernel_fct_ptr classical;
+    increment_kernel_fct_ptr damped;
+    increment_kernel_fct_ptr ensure_same_sign;
+} kernels;
+
+/**
+ * @brief Prototype of the single precision kernels computing the increments on raw arrays
+ *
+ */
+typedef void (*increment_kernel_f_fct_ptr)(const float *x_k, const float *func, const float *dfunc,
+                                           float *delta_x, const size_t size);
+
+/**
+ * @brief The single precision kernels chosen according to the SIMD level of the processor
+ *
+ */
+static struct
+{
+    increment_kernel_f_fct_ptr classical;
+    increment_kernel_f_fct_ptr damped;
+    increment_kernel_f_fct_ptr ensure_same_sign;
+} kernels_f;
+
+/*
+ * Scalar kernels. They also handle the remainders of the vectorized ones.
+ * The increments never overlap the other arrays, hence the restrict qualifiers.
+ */
+static void classical_kernel_scalar(__attribute__((unused)) const double *restrict x_k, const double *restrict func,
+                                    const double *restrict dfunc, double *restrict delta_x, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        delta_x[i] = -func[i] / dfunc[i];
+    }
+}
+
+static void damped_kernel_scalar(__attribute__((unused)) const double *restrict x_k, const double *restrict func,
+                                 const double *restrict dfunc, double *restrict delta_x, const size_t size)
+{
+    const double damping_coeff = DAMPING_COEFF;
+    for (size_t i = 0; i < size; ++i)
+    {
+        delta_x[i] = -damping_coeff * func[i] / dfunc[i];
+    }
+}
+
+static void ensure_same_sign_kernel_scalar(const double *restrict x_k, const double *restrict func,
+                                           const double *restrict dfunc, double *restrict delta_x, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        double min_authorized = 0.;
+        double optimal_value = -func[i] / dfunc[i];
+        double target = x_k[i] + optimal_value;
+        if (target * x_k[i] < 0)
+        {
+            delta_x[i] = (min_authorized - x_k[i]) * 0.5;
+        }
+        else
+        {
+            delta_x[i] = optimal_value;
+        }
+    }
+}
+
+/*
+ * Single precision scalar kernels
+ */
+static void classical_kernel_f_scalar(__attribute__((unused)) const float *restrict x_k, const float *restrict func,
+                                      const float *restrict dfunc, float *restrict delta_x, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        delta_x[i] = -func[i] / dfunc[i];
+    }
+}
+
+static void damped_kernel_f_scalar(__attribute__((unused)) const float *restrict x_k, const float *restrict func,
+                                   const float *restrict dfunc, float *restrict delta_x, const size_t size)
+{
+    const float damping_coeff = (float)DAMPING_COEFF;
+    for (size_t i = 0; i < size; ++i)
+    {
+        delta_x[i] = -damping_coeff * func[i] / dfunc[i];
+    }
+}
+
+static void ensure_same_sign_kernel_f_scalar(const float *restrict x_k, const float *restrict func,
+                                             const float *restrict dfunc, float *restrict delta_x, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        const float optimal_value = -func[i] / dfunc[i];
+        const float target = x_k[i] + optimal_value;
+        delta_x[i] = target * x_k[i] < 0.f ? (0.f - x_k[i]) * 0.5f : optimal_value;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/*
+ * SSE2 kernels (2 doubles per vector)
+ */
+__attribute__((target("sse2"))) static void classical_kernel_sse2(const double *x_k, const double *func, const double *dfunc,
+                                                                  double *delta_x, const size_t size)
+{
+    const __m128d sign_mask = _mm_set1_pd(-0.);
+    size_t i = 0;
+    for (; i + 2 <= size; i += 2)
+    {
+        const __m128d minus_f = _mm_xor_pd(_mm_loadu_pd(func + i), sign_mask);
+        _mm_storeu_pd(delta_x + i, _mm_div_pd(minus_f, _mm_loadu_pd(dfunc + i)));
+    }
+    classical_kernel_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("sse2"))) static void damped_kernel_sse2(const double *x_k, const double *func, const double *dfunc,
+                                                               double *delta_x, const size_t size)
+{
+    const __m128d minus_damping = _mm_set1_pd(-DAMPING_COEFF);
+    size_t i = 0;
+    for (; i + 2 <= size; i += 2)
+    {
+        const __m128d damped_f = _mm_mul_pd(minus_damping, _mm_loadu_pd(func + i));
+        _mm_storeu_pd(delta_x + i, _mm_div_pd(damped_f, _mm_loadu_pd(dfunc + i)));
+    }
+    damped_kernel_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("sse2"))) static void ensure_same_sign_kernel_sse2(const double *x_k, const double *func, const double *dfunc,
+                                                                         double *delta_x, const size_t size)
+{
+    const __m128d sign_mask = _mm_set1_pd(-0.);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d half = _mm_set1_pd(0.5);
+    size_t i = 0;
+    for (; i + 2 <= size; i += 2)
+    {
+        const __m128d x = _mm_loadu_pd(x_k + i);
+        const __m128d optimal = _mm_div_pd(_mm_xor_pd(_mm_loadu_pd(func + i), sign_mask), _mm_loadu_pd(dfunc + i));
+        const __m128d target = _mm_add_pd(x, optimal);
+        const __m128d sign_change = _mm_cmplt_pd(_mm_mul_pd(target, x), zero);
+        const __m128d limited = _mm_mul_pd(_mm_sub_pd(zero, x), half);
+        // No blend in SSE2 : select with masks
+        _mm_storeu_pd(delta_x + i, _mm_or_pd(_mm_and_pd(sign_change, limited), _mm_andnot_pd(sign_change, optimal)));
+    }
+    ensure_same_sign_kernel_scalar(x_k + i, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+/*
+ * AVX2 kernels (4 doubles per vector)
+ */
+__attribute__((target("avx2"))) static void classical_kernel_avx2(const double *x_k, const double *func, const double *dfunc,
+                                                                  double *delta_x, const size_t size)
+{
+    const __m256d sign_mask = _mm256_set1_pd(-0.);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m256d minus_f = _mm256_xor_pd(_mm256_loadu_pd(func + i), sign_mask);
+        _mm256_storeu_pd(delta_x + i, _mm256_div_pd(minus_f, _mm256_loadu_pd(dfunc + i)));
+    }
+    classical_kernel_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx2"))) static void damped_kernel_avx2(const double *x_k, const double *func, const double *dfunc,
+                                                               double *delta_x, const size_t size)
+{
+    const __m256d minus_damping = _mm256_set1_pd(-DAMPING_COEFF);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m256d damped_f = _mm256_mul_pd(minus_damping, _mm256_loadu_pd(func + i));
+        _mm256_storeu_pd(delta_x + i, _mm256_div_pd(damped_f, _mm256_loadu_pd(dfunc + i)));
+    }
+    damped_kernel_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx2"))) static void ensure_same_sign_kernel_avx2(const double *x_k, const double *func, const double *dfunc,
+                                                                         double *delta_x, const size_t size)
+{
+    const __m256d sign_mask = _mm256_set1_pd(-0.);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d half = _mm256_set1_pd(0.5);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m256d x = _mm256_loadu_pd(x_k + i);
+        const __m256d optimal = _mm256_div_pd(_mm256_xor_pd(_mm256_loadu_pd(func + i), sign_mask), _mm256_loadu_pd(dfunc + i));
+        const __m256d target = _mm256_add_pd(x, optimal);
+        const __m256d sign_change = _mm256_cmp_pd(_mm256_mul_pd(target, x), zero, _CMP_LT_OQ);
+        const __m256d limited = _mm256_mul_pd(_mm256_sub_pd(zero, x), half);
+        _mm256_storeu_pd(delta_x + i, _mm256_blendv_pd(optimal, limited, sign_change));
+    }
+    ensure_same_sign_kernel_scalar(x_k + i, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+/*
+ * AVX-512 kernels (8 doubles per vector)
+ */
+__attribute__((target("avx512f"))) static void classical_kernel_avx512(const double *x_k, const double *func, const double *dfunc,
+                                                                       double *delta_x, const size_t size)
+{
+    const __m512d minus_one = _mm512_set1_pd(-1.);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        // Multiplying by -1 is exact, as is the negation of the scalar kernel
+        const __m512d minus_f = _mm512_mul_pd(_mm512_loadu_pd(func + i), minus_one);
+        _mm512_storeu_pd(delta_x + i, _mm512_div_pd(minus_f, _mm512_loadu_pd(dfunc + i)));
+    }
+    classical_kernel_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx512f"))) static void damped_kernel_avx512(const double *x_k, const double *func, const double *dfunc,
+                                                                    double *delta_x, const size_t size)
+{
+    const __m512d minus_damping = _mm512_set1_pd(-DAMPING_COEFF);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m512d damped_f = _mm512_mul_pd(minus_damping, _mm512_loadu_pd(func + i));
+        _mm512_storeu_pd(delta_x + i, _mm512_div_pd(damped_f, _mm512_loadu_pd(dfunc + i)));
+    }
+    damped_kernel_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx512f"))) static void ensure_same_sign_kernel_avx512(const double *x_k, const double *func, const double *dfunc,
+                                                                              double *delta_x, const size_t size)
+{
+    const __m512d minus_one = _mm512_set1_pd(-1.);
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d half = _mm512_set1_pd(0.5);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m512d x = _mm512_loadu_pd(x_k + i);
+        const __m512d optimal = _mm512_div_pd(_mm512_mul_pd(_mm512_loadu_pd(func + i), minus_one), _mm512_loadu_pd(dfunc + i));
+        const __m512d target = _mm512_add_pd(x, optimal);
+        const __mmask8 sign_change = _mm512_cmp_pd_mask(_mm512_mul_pd(target, x), zero, _CMP_LT_OQ);
+        const __m512d limited = _mm512_mul_pd(_mm512_sub_pd(zero, x), half);
+        _mm512_storeu_pd(delta_x + i, _mm512_mask_blend_pd(sign_change, optimal, limited));
+    }
+    ensure_same_sign_kernel_scalar(x_k + i, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+/*
+ * Single precision kernels : twice as many values per vector as the double precision ones
+ */
+__attribute__((target("sse2"))) static void classical_kernel_f_sse2(const float *x_k, const float *func, const float *dfunc,
+                                                                    float *delta_x, const size_t size)
+{
+    const __m128 sign_mask = _mm_set1_ps(-0.f);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m128 minus_f = _mm_xor_ps(_mm_loadu_ps(func + i), sign_mask);
+        _mm_storeu_ps(delta_x + i, _mm_div_ps(minus_f, _mm_loadu_ps(dfunc + i)));
+    }
+    classical_kernel_f_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("sse2"))) static void damped_kernel_f_sse2(const float *x_k, const float *func, const float *dfunc,
+                                                                 float *delta_x, const size_t size)
+{
+    const __m128 minus_damping = _mm_set1_ps(-(float)DAMPING_COEFF);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m128 damped_f = _mm_mul_ps(minus_damping, _mm_loadu_ps(func + i));
+        _mm_storeu_ps(delta_x + i, _mm_div_ps(damped_f, _mm_loadu_ps(dfunc + i)));
+    }
+    damped_kernel_f_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("sse2"))) static void ensure_same_sign_kernel_f_sse2(const float *x_k, const float *func, const float *dfunc,
+                                                                           float *delta_x, const size_t size)
+{
+    const __m128 sign_mask = _mm_set1_ps(-0.f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(x_k + i);
+        const __m128 optimal = _mm_div_ps(_mm_xor_ps(_mm_loadu_ps(func + i), sign_mask), _mm_loadu_ps(dfunc + i));
+        const __m128 target = _mm_add_ps(x, optimal);
+        const __m128 sign_change = _mm_cmplt_ps(_mm_mul_ps(target, x), zero);
+        const __m128 limited = _mm_mul_ps(_mm_sub_ps(zero, x), half);
+        _mm_storeu_ps(delta_x + i, _mm_or_ps(_mm_and_ps(sign_change, limited), _mm_andnot_ps(sign_change, optimal)));
+    }
+    ensure_same_sign_kernel_f_scalar(x_k + i, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx2"))) static void classical_kernel_f_avx2(const float *x_k, const float *func, const float *dfunc,
+                                                                    float *delta_x, const size_t size)
+{
+    const __m256 sign_mask = _mm256_set1_ps(-0.f);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256 minus_f = _mm256_xor_ps(_mm256_loadu_ps(func + i), sign_mask);
+        _mm256_storeu_ps(delta_x + i, _mm256_div_ps(minus_f, _mm256_loadu_ps(dfunc + i)));
+    }
+    classical_kernel_f_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx2"))) static void damped_kernel_f_avx2(const float *x_k, const float *func, const float *dfunc,
+                                                                 float *delta_x, const size_t size)
+{
+    const __m256 minus_damping = _mm256_set1_ps(-(float)DAMPING_COEFF);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256 damped_f = _mm256_mul_ps(minus_damping, _mm256_loadu_ps(func + i));
+        _mm256_storeu_ps(delta_x + i, _mm256_div_ps(damped_f, _mm256_loadu_ps(dfunc + i)));
+    }
+    damped_kernel_f_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx2"))) static void ensure_same_sign_kernel_f_avx2(const float *x_k, const float *func, const float *dfunc,
+                                                                           float *delta_x, const size_t size)
+{
+    const __m256 sign_mask = _mm256_set1_ps(-0.f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(x_k + i);
+        const __m256 optimal = _mm256_div_ps(_mm256_xor_ps(_mm256_loadu_ps(func + i), sign_mask), _mm256_loadu_ps(dfunc + i));
+        const __m256 target = _mm256_add_ps(x, optimal);
+        const __m256 sign_change = _mm256_cmp_ps(_mm256_mul_ps(target, x), zero, _CMP_LT_OQ);
+        const __m256 limited = _mm256_mul_ps(_mm256_sub_ps(zero, x), half);
+        _mm256_storeu_ps(delta_x + i, _mm256_blendv_ps(optimal, limited, sign_change));
+    }
+    ensure_same_sign_kernel_f_scalar(x_k + i, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx512f"))) static void classical_kernel_f_avx512(const float *x_k, const float *func, const float *dfunc,
+                                                                         float *delta_x, const size_t size)
+{
+    const __m512 minus_one = _mm512_set1_ps(-1.f);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m512 minus_f = _mm512_mul_ps(_mm512_loadu_ps(func + i), minus_one);
+        _mm512_storeu_ps(delta_x + i, _mm512_div_ps(minus_f, _mm512_loadu_ps(dfunc + i)));
+    }
+    classical_kernel_f_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx512f"))) static void damped_kernel_f_avx512(const float *x_k, const float *func, const float *dfunc,
+                                                                      float *delta_x, const size_t size)
+{
+    const __m512 minus_damping = _mm512_set1_ps(-(float)DAMPING_COEFF);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m512 damped_f = _mm512_mul_ps(minus_damping, _mm512_loadu_ps(func + i));
+        _mm512_storeu_ps(delta_x + i, _mm512_div_ps(damped_f, _mm512_loadu_ps(dfunc + i)));
+    }
+    damped_kernel_f_scalar(x_k ? x_k + i : NULL, func + i, dfunc + i, delta_x + i, size - i);
+}
+
+__attribute__((target("avx512f"))) static void ensure_same_sign_kernel_f_avx512(const float *x_k, const float *func, const float *dfunc,
+                                                                                float *delta_x, const size_t size)
+{
+    const __m512 minus_one = _mm512_set1_ps(-1.f);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 half = _mm512_set1_ps(0.5f);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m512 x = _mm512_loadu_ps(x_k + i);
+        const __m512 optimal = _mm512_div_ps(_mm512_mul_ps(_mm512_loadu_ps(func + i), minus_one), _mm512_loadu_ps(dfunc + i));
+        const __m512 target = _mm512_add_ps(x, optimal);
+        const __mmask16 sign_change = _mm512_cmp_ps_mask(_mm512_mul_ps(target, x), zero, _CMP_LT_OQ);
+        const __m512 limited = _mm512_mul_ps(_mm512_sub_ps(zero, x), half);
+        _mm512_storeu_ps(delta_x + i, _mm512_mask_blend_ps(sign_change, optimal, limited));
+    }
+    ensure_same_sign_kernel_f_scalar(x_k + i, func + i, dfunc + i, delta_x + i, size - i);
+}
+#endif
+
+/**
+ * @brief Choose the kernels according to the SIMD level, once, when the library is loaded
+ *
+ */
+__attribute__((constructor)) static void select_kernels(void)
+{
+    kernels.classical = classical_kernel_scalar;
+    kernels.damped = damped_kernel_scalar;
+    kernels.ensure_same_sign = ensure_same_sign_kernel_scalar;
+    kernels_f.classical = classical_kernel_f_scalar;
+    kernels_f.damped = damped_kernel_f_scalar;
+    kernels_f.ensure_same_sign = ensure_same_sign_kernel_f_scalar;
+#if defined(__x86_64__) || defined(__i386__)
+    switch (get_simd_level())
+    {
+    case SIMD_AVX512:
+        kernels.classical = classical_kernel_avx512;
+        kernels.damped = damped_kernel_avx512;
+        kernels.ensure_same_sign = ensure_same_sign_kernel_avx512;
+        kernels_f.classical = classical_kernel_f_avx512;
+        kernels_f.damped = damped_kernel_f_avx512;
+        kernels_f.ensure_same_sign = ensure_same_sign_kernel_f_avx512;
+        break;
+    case SIMD_AVX2:
+        kernels.classical = classical_kernel_avx2;
+        kernels.damped = damped_kernel_avx2;
+        kernels.ensure_same_sign = ensure_same_sign_kernel_avx2;
+        kernels_f.classical = classical_kernel_f_avx2;
+        kernels_f.damped = damped_kernel_f_avx2;
+        kernels_f.ensure_same_sign = ensure_same_sign_kernel_f_avx2;
+        break;
+    case SIMD_SSE2:
+        kernels.classical = classical_kernel_sse2;
+        kernels.damped = damped_kernel_sse2;
+        kernels.ensure_same_sign = ensure_same_sign_kernel_sse2;
+        kernels_f.classical = classical_kernel_f_sse2;
+        kernels_f.damped = damped_kernel_f_sse2;
+        kernels_f.ensure_same_sign = ensure_same_sign_kernel_f_sse2;
+        break;
+    default:
+        break;
+    }
+#endif
+}
 
 void classical_incrementation(__attribute__((unused)) const p_array x_k, const  p_array func, const p_array dfunc, p_array vector_of_increments)
 {
@@ -10,10 +472,7 @@ void classical_incrementation(__attribute__((unused)) const p_array x_k, const
     assert(func->size == dfunc->size);
     assert(func->size == vector_of_increments->size);
 
-    for (size_t i = 0; i < func->size; ++i)
-    {
-        vector_of_increments->data[i] = -func->data[i] / dfunc->data[i];
-    }
+    kernels.classical(NULL, func->data, dfunc->data, vector_of_increments->data, func->size);
 }
 
 void damped_incrementation(__attribute__((unused)) const p_array x_k, const p_array func, const p_array dfunc, p_array vector_of_increments)
@@ -24,11 +483,7 @@ void damped_incrementation(__attribute__((unused)) const p_array x_k, const p_ar
     assert(func->size == dfunc->size);
     assert(func->size == vector_of_increments->size);
 
-    const double damping_coeff = 0.5;
-    for (size_t i = 0; i < func->size; ++i)
-    {
-        vector_of_increments->data[i] = -damping_coeff * func->data[i] / dfunc->data[i];
-    }
+    kernels.damped(NULL, func->data, dfunc->data, vector_of_increments->data, func->size);
 }
 
 void ensure_same_sign_incrementation(const p_array x_k, const p_array func, const p_array dfunc, p_array vector_of_increments)
@@ -41,18 +496,85 @@ void ensure_same_sign_incrementation(const p_array x_k, const p_array func, cons
     assert(func->size == dfunc->size);
     assert(func->size == vector_of_increments->size);
 
-    for (size_t i = 0; i < func->size; ++i)
+    kernels.ensure_same_sign(x_k->data, func->data, dfunc->data, vector_of_increments->data, func->size);
+}
+
+void classical_incrementation_f(__attribute__((unused)) const p_array_f x_k, const p_array_f func, const p_array_f dfunc,
+                                p_array_f vector_of_increments)
+{
+    assert(is_valid_array_f(func));
+    assert(is_valid_array_f(dfunc));
+    assert(is_valid_array_f(vector_of_increments));
+    assert(func->size == dfunc->size);
+    assert(func->size == vector_of_increments->size);
+
+    kernels_f.classical(NULL, func->data, dfunc->data, vector_of_increments->data, func->size);
+}
+
+void damped_incrementation_f(__attribute__((unused)) const p_array_f x_k, const p_array_f func, const p_array_f dfunc,
+                             p_array_f vector_of_increments)
+{
+    assert(is_valid_array_f(func));
+    assert(is_valid_array_f(dfunc));
+    assert(is_valid_array_f(vector_of_increments));
+    assert(func->size == dfunc->size);
+    assert(func->size == vector_of_increments->size);
+
+    kernels_f.damped(NULL, func->data, dfunc->data, vector_of_increments->data, func->size);
+}
+
+void ensure_same_sign_incrementation_f(const p_array_f x_k, const p_array_f func, const p_array_f dfunc,
+                                       p_array_f vector_of_increments)
+{
+    assert(is_valid_array_f(x_k));
+    assert(is_valid_array_f(func));
+    assert(is_valid_array_f(dfunc));
+    assert(is_valid_array_f(vector_of_increments));
+    assert(func->size == x_k->size);
+    assert(func->size == dfunc->size);
+    assert(func->size == vector_of_increments->size);
+
+    kernels_f.ensure_same_sign(x_k->data, func->data, dfunc->data, vector_of_increments->data, func->size);
+}
+
+/**
+ * @brief Loop of the Halley incrementation, inlined in an aligned and an unaligned version
+ *
+ */
+__attribute__((always_inline))
+static inline void halley_loop(const double *restrict func, const double *restrict dfunc,
+                               const double *restrict d2func, double *restrict delta_x, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
     {
-        double min_authorized = 0.;
-        double optimal_value = -func->data[i] / dfunc->data[i];
-        double target = x_k->data[i] + optimal_value;
-        if (target * x_k->data[i] < 0)
-        {
-            vector_of_increments->data[i] = (min_authorized - x_k->data[i]) * 0.5;
-        }
-        else
-        {
-            vector_of_increments->data[i] = optimal_value;
-        }
+        const double f = func[i];
+        const double df = dfunc[i];
+        // The denominator of the Halley formula is df (1 - correction) : it vanishes when the correction
+        // reaches 1 and then points away from the root, where the classical increment is still well defined
+        const double correction = 0.5 * f * d2func[i] / (df * df);
+        delta_x[i] = fabs(correction) < HALLEY_MAX_CORRECTION ? -f / (df * (1. - correction)) : -f / df;
+    }
+}
+
+void halley_incrementation(__attribute__((unused)) const p_array x_k, const p_array func, const p_array dfunc,
+                           const p_array d2func, p_array vector_of_increments)
+{
+    assert(is_valid_array(func));
+    assert(is_valid_array(dfunc));
+    assert(is_valid_array(d2func));
+    assert(is_valid_array(vector_of_increments));
+    assert(func->size == dfunc->size);
+    assert(func->size == d2func->size);
+    assert(func->size == vector_of_increments->size);
+
+    if (is_aligned_array(func) && is_aligned_array(dfunc) && is_aligned_array(d2func) &&
+        is_aligned_array(vector_of_increments))
+    {
+        halley_loop(ARRAY_ALIGNED_DATA(func), ARRAY_ALIGNED_DATA(dfunc), ARRAY_ALIGNED_DATA(d2func),
+                    ARRAY_ALIGNED_DATA(vector_of_increments), func->size);
+    }
+    else
+    {
+        halley_loop(func->data, dfunc->data, d2func->data, vector_of_increments->data, func->size);
     }
 }
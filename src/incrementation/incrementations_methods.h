@@ -13,6 +13,7 @@
 
 #include <stdlib.h>
 #include "array.h"
+#include "array_float.h"
 
 /**
  * @brief Computes the vector of increments according to the classic Newton's formula : 
@@ -46,10 +47,72 @@ void damped_incrementation(const p_array x_k, const p_array func, const p_array
  */
 void ensure_same_sign_incrementation(const p_array x_k, const p_array func, const p_array dfunc, p_array vector_of_increments);
 
+/**
+ * @brief Compute the vector of increments according to the Halley's formula :
+ *        \f$\Delta x = -\frac{f}{df - \frac{f d2f}{2 df}}\f$
+ *        The convergence is cubic instead of quadratic. If d2f is null the increment is exactly
+ *        the one of the classical incrementation. Where the correction \f$\frac{f d2f}{2 df^2}\f$ is
+ *        not below 0.5 in absolute value (far from the root, e.g in a strongly shocked cell), the
+ *        Halley increment is unreliable and the classical one is taken instead.
+ * 
+ * @param x_k[in] : vector of unknowns (useless here)
+ * @param func[in] : vector of the value of the function
+ * @param dfunc[in] : vector of the value of the derivative of the function
+ * @param d2func[in] : vector of the value of the second derivative of the function
+ * @param vector_of_increments[out] : vector of the value of increments
+ */
+void halley_incrementation(const p_array x_k, const p_array func, const p_array dfunc, const p_array d2func,
+                           p_array vector_of_increments);
+
+/**
+ * @brief Same as classical_incrementation in single precision
+ * 
+ * @param x_k[in] : vector of unknowns (useless here)
+ * @param func[in] : vector of the value of the function
+ * @param dfunc[in] : vector of the value of the derivative of the function
+ * @param vector_of_increments[out] : vector of the value of increments
+ */
+void classical_incrementation_f(const p_array_f x_k, const p_array_f func, const p_array_f dfunc,
+                                p_array_f vector_of_increments);
+
+/**
+ * @brief Same as damped_incrementation in single precision
+ * 
+ * @param x_k[in] : vector of unknowns (useless here)
+ * @param func[in] : vector of the value of the function
+ * @param dfunc[in] : vector of the value of the derivative of the function
+ * @param vector_of_increments[out] : vector of the value of increments
+ */
+void damped_incrementation_f(const p_array_f x_k, const p_array_f func, const p_array_f dfunc,
+                             p_array_f vector_of_increments);
+
+/**
+ * @brief Same as ensure_same_sign_incrementation in single precision
+ * 
+ * @param x_k[in] : vector of unknowns
+ * @param func[in] : vector of the value of the function
+ * @param dfunc[in] : vector of the value of the derivative of the function
+ * @param vector_of_increments[out] : vector of the value of increments
+ */
+void ensure_same_sign_incrementation_f(const p_array_f x_k, const p_array_f func, const p_array_f dfunc,
+                                       p_array_f vector_of_increments);
+
 /**
  * @brief A prototype for incrementation functions that are to be used in Newton algorithm
  * 
  */
 typedef void (*incrementation_fct_ptr)(const p_array, const p_array, const p_array, p_array);
 
+/**
+ * @brief A prototype for incrementation functions that also use the second derivative of the function
+ * 
+ */
+typedef void (*second_order_incrementation_fct_ptr)(const p_array, const p_array, const p_array, const p_array, p_array);
+
+/**
+ * @brief A prototype for the single precision incrementation functions
+ * 
+ */
+typedef void (*incrementation_f_fct_ptr)(const p_array_f, const p_array_f, const p_array_f, p_array_f);
+
 #endif
\ No newline at end of file
@@ -1,11 +1,19 @@
 #include <stdbool.h>
+#include <math.h>
 
 #include "incrementations_methods.h"
+#include "simd_dispatch.h"
 #include "test_utils.h"
 #include "array.h"
 
 #define PB_SIZE 2
 
+/**
+ * @brief Size of the arrays used to test the vectorized kernels. It is not a multiple
+ *        of any vector width so that the remainders are exercised too.
+ */
+#define LARGE_PB_SIZE 1003
+
 /**
  * @brief Test the classical incrementation method
  * 
@@ -139,6 +147,244 @@ bool test_ensure_positivity_incrementation()
     return status;
 }
 
+/**
+ * @brief Test the Halley incrementation method
+ * 
+ * @return true : success
+ * @return false : failure
+ */
+bool test_halley_incrementation()
+{
+    BUILD_ARRAY(x_k, PB_SIZE)
+    BUILD_ARRAY(f, PB_SIZE)
+    BUILD_ARRAY(df, PB_SIZE)
+    BUILD_ARRAY(d2f, PB_SIZE)
+    BUILD_ARRAY(obtained, PB_SIZE)
+    BUILD_ARRAY(expected, PB_SIZE)
+
+    p_array built_arrays[] = {x_k, f, df, d2f, obtained, expected};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return false;
+    }
+
+    x_k->data[0] = -1.;
+    x_k->data[1] = 2.;
+
+    f->data[0] = 1.;
+    f->data[1] = -987.654;
+
+    df->data[0] = -2.;
+    df->data[1] = -50.;
+
+    // With a null second derivative the increment is the classical one
+    d2f->data[0] = 3.;
+    d2f->data[1] = 0.;
+
+    // -1 / (-2 - 0.5 * 1 * 3 / -2)
+    expected->data[0] = 0.8;
+    expected->data[1] = -19.75308;
+
+    halley_incrementation(x_k, f, df, d2f, obtained);
+    bool status = assert_equal(obtained, expected);
+
+    cleanup_memory(built_arrays, nb_arrays);
+
+    return status;
+}
+
+/**
+ * @brief Test the Halley incrementation far from the root of f(x) = x^3 + 8 (root -2).
+ *        At x = 1, f = 9, df = 3 and d2f = 6 : the Halley denominator 3 - 0.5 * 9 * 6 / 3 = -6
+ *        has changed sign and its increment (+1.5) points away from the root, whereas the classical
+ *        increment (-3) reaches it. At x = 4^(1/3) the denominator vanishes.
+ * 
+ * @return true : success
+ * @return false : failure
+ */
+bool test_halley_incrementation_far_from_root()
+{
+    BUILD_ARRAY(x_k, PB_SIZE)
+    BUILD_ARRAY(f, PB_SIZE)
+    BUILD_ARRAY(df, PB_SIZE)
+    BUILD_ARRAY(d2f, PB_SIZE)
+    BUILD_ARRAY(obtained, PB_SIZE)
+    BUILD_ARRAY(expected, PB_SIZE)
+
+    p_array built_arrays[] = {x_k, f, df, d2f, obtained, expected};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return false;
+    }
+
+    x_k->data[0] = 1.;
+    x_k->data[1] = cbrt(4.);
+    for (unsigned int i = 0; i < PB_SIZE; ++i)
+    {
+        const double x = x_k->data[i];
+        f->data[i] = x * x * x + 8.;
+        df->data[i] = 3. * x * x;
+        d2f->data[i] = 6. * x;
+        expected->data[i] = -f->data[i] / df->data[i];
+    }
+
+    halley_incrementation(x_k, f, df, d2f, obtained);
+    bool status = assert_equal(obtained, expected);
+    if (x_k->data[0] + obtained->data[0] != -2.)
+    {
+        fprintf(stderr, "The increment at x = 1 should reach the root!\n");
+        status = false;
+    }
+
+    cleanup_memory(built_arrays, nb_arrays);
+
+    return status;
+}
+
+/**
+ * @brief Test the three incrementation methods on an array large enough to use the vectorized
+ *        kernels of the current SIMD level. The results are compared to a scalar computation.
+ * 
+ * @return true : success
+ * @return false : failure
+ */
+bool test_incrementations_on_large_array()
+{
+    BUILD_ARRAY(x_k, LARGE_PB_SIZE)
+    BUILD_ARRAY(f, LARGE_PB_SIZE)
+    BUILD_ARRAY(df, LARGE_PB_SIZE)
+    BUILD_ARRAY(obtained, LARGE_PB_SIZE)
+    BUILD_ARRAY(expected, LARGE_PB_SIZE)
+
+    p_array built_arrays[] = {x_k, f, df, obtained, expected};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return false;
+    }
+
+    printf("SIMD level : %s\n", get_simd_level_name(get_simd_level()));
+
+    // Values of both signs so that ensure_same_sign takes both branches
+    for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+    {
+        x_k->data[i] = (i % 3 == 0) ? -1. - i * 0.01 : 2. + i * 0.03;
+        f->data[i] = (i % 2 == 0) ? 123.456 + i : -987.654 + 0.5 * i;
+        df->data[i] = (i % 5 == 0) ? 30. + i * 0.1 : -50. - i * 0.2;
+    }
+
+    bool success = true;
+
+    for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+        expected->data[i] = -f->data[i] / df->data[i];
+    classical_incrementation(x_k, f, df, obtained);
+    success = assert_equal(obtained, expected) && success;
+
+    for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+        expected->data[i] = -0.5 * f->data[i] / df->data[i];
+    damped_incrementation(x_k, f, df, obtained);
+    success = assert_equal(obtained, expected) && success;
+
+    for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+    {
+        const double optimal_value = -f->data[i] / df->data[i];
+        const double target = x_k->data[i] + optimal_value;
+        expected->data[i] = (target * x_k->data[i] < 0) ? -x_k->data[i] * 0.5 : optimal_value;
+    }
+    ensure_same_sign_incrementation(x_k, f, df, obtained);
+    success = assert_equal(obtained, expected) && success;
+
+    cleanup_memory(built_arrays, nb_arrays);
+
+    return success;
+}
+
+/**
+ * @brief Count the values of the float array that differ from the expected ones
+ * 
+ * @param[in] obtained : values obtained
+ * @param[in] expected : values expected
+ * @return unsigned int : number of differences
+ */
+static unsigned int count_float_differences(const p_array_f obtained, const p_array_f expected)
+{
+    unsigned int nb_differences = 0;
+    for (unsigned int i = 0; i < obtained->size; ++i)
+    {
+        if (obtained->data[i] != expected->data[i])
+        {
+            if (nb_differences == 0)
+                fprintf(stderr, "%s[%u] = %.9g instead of %.9g!\n", obtained->label, i, obtained->data[i],
+                        expected->data[i]);
+            ++nb_differences;
+        }
+    }
+    return nb_differences;
+}
+
+/**
+ * @brief Test the single precision incrementation methods on an array large enough to use the vectorized
+ *        kernels of the current SIMD level. The results are compared to a scalar computation.
+ * 
+ * @return true : success
+ * @return false : failure
+ */
+bool test_float_incrementations_on_large_array()
+{
+    BUILD_ARRAY_F(x_k, LARGE_PB_SIZE)
+    BUILD_ARRAY_F(f, LARGE_PB_SIZE)
+    BUILD_ARRAY_F(df, LARGE_PB_SIZE)
+    BUILD_ARRAY_F(obtained, LARGE_PB_SIZE)
+    BUILD_ARRAY_F(expected, LARGE_PB_SIZE)
+    p_array_f built_arrays[] = {x_k, f, df, obtained, expected};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array_f);
+    bool success = true;
+    for (unsigned int j = 0; j < nb_arrays; ++j)
+        success = success && built_arrays[j] != NULL;
+
+    printf("SIMD level : %s\n", get_simd_level_name(get_simd_level()));
+
+    for (unsigned int i = 0; i < LARGE_PB_SIZE && success; ++i)
+    {
+        x_k->data[i] = (i % 3 == 0) ? -1.f - i * 0.01f : 2.f + i * 0.03f;
+        f->data[i] = (i % 2 == 0) ? 123.456f + i : -987.654f + 0.5f * i;
+        df->data[i] = (i % 5 == 0) ? 30.f + i * 0.1f : -50.f - i * 0.2f;
+    }
+
+    if (success)
+    {
+        for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+            expected->data[i] = -f->data[i] / df->data[i];
+        classical_incrementation_f(x_k, f, df, obtained);
+        success = count_float_differences(obtained, expected) == 0 && success;
+
+        for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+            expected->data[i] = -0.5f * f->data[i] / df->data[i];
+        damped_incrementation_f(x_k, f, df, obtained);
+        success = count_float_differences(obtained, expected) == 0 && success;
+
+        for (unsigned int i = 0; i < LARGE_PB_SIZE; ++i)
+        {
+            const float optimal_value = -f->data[i] / df->data[i];
+            const float target = x_k->data[i] + optimal_value;
+            expected->data[i] = (target * x_k->data[i] < 0.f) ? -x_k->data[i] * 0.5f : optimal_value;
+        }
+        ensure_same_sign_incrementation_f(x_k, f, df, obtained);
+        success = count_float_differences(obtained, expected) == 0 && success;
+    }
+
+    for (unsigned int j = 0; j < nb_arrays; ++j)
+    {
+        DELETE_ARRAY_F(built_arrays[j])
+    }
+    return success;
+}
+
 /**
  * @brief Print the usage of the program
  * 
@@ -150,6 +396,9 @@ void usage(const char *prog)
     fprintf(stderr, "   number_of_test=0 : test the classical incrementation method\n");
     fprintf(stderr, "   number_of_test=1 : test the damped incrementation method\n");
     fprintf(stderr, "   number_of_test=2 : test the ensure positivity incrementation method\n");
+    fprintf(stderr, "   number_of_test=3 : test the incrementation methods on a large array (vectorized kernels)\n");
+    fprintf(stderr, "   number_of_test=4 : test the Halley incrementation method\n");
+    fprintf(stderr, "   number_of_test=5 : test the single precision incrementation methods on a large array\n");
 }
 
 /**
@@ -180,10 +429,22 @@ int main(int argc, char *argv[])
     case 2:
         success = test_ensure_positivity_incrementation();
         break;
+    case 3:
+        success = test_incrementations_on_large_array();
+        break;
+    case 4:
+        success = test_halley_incrementation();
+        break;
+    case 5:
+        success = test_float_incrementations_on_large_array();
+        break;
+    case 6:
+        success = test_halley_incrementation_far_from_root();
+        break;
     default:
         fprintf(stderr, "ERROR while parsing arguments!\n");
         usage(argv[0]);
-        fprintf(stderr, "Only 3 methods may be tested: please enter a number in [0-2] not %d!\n", test_number);
+        fprintf(stderr, "Only 7 tests are available: please enter a number in [0-6] not %d!\n", test_number);
         return -2;
     }
 
@@ -1,91 +1,1107 @@
 #include <assert.h>
 #include <omp.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "array.h"
+#include "array_mapped.h"
+#include "eos.h"
 #include "incrementations_methods.h"
+#include "launch_vnr_resolution.h"
 #include "newton.h"
 #include "stop_criterions.h"
 #include "vnr_internalenergy_evolution.h"
+#include "vnr_internalenergy_fused.h"
 #include "miegruneisen.h"
 #include "miegruneisen_params.h"
+#include "vnr_thread_team.h"
 
-void launch_vnr_resolution(MieGruneisenParams_s const * eos_params,
-                           p_array old_specific_volume, p_array new_specific_volume,
-                           p_array pressure, p_array internal_energy,
-                           p_array solution, p_array new_p,
-                           p_array new_vson)
+/**
+ * @brief Number of arrays gathered by material by the multi-material solve : the 7 arrays of the problem,
+ *        the 2 per cell tolerances and the initial guess of the caller
+ *
+ */
+#define VNR_NB_GATHERED_ARRAYS 10
+
+/**
+ * @brief Holds the scratch memory used by one thread
+ *
+ */
+typedef struct VnrThreadState
+{
+    MieGruneisenEOS_s eos;  /**< The equation of state (its arrays are kept from one solve to the other) */
+    NewtonWorkspace_s *workspace;  /**< Scratch memory of the Newton solver */
+    double *eos_pressure;  /**< Scratch buffer for the pressure computed during Newton iterations */
+    double *eos_dpsurde;  /**< Scratch buffer for dp/de computed during Newton iterations */
+    float *float_buffer;  /**< Single precision arrays of the mixed precision kernel (allocated at its first use) */
+    NewtonReport_s report;  /**< Report of the cells solved by the thread */
+    int status;  /**< Status of the solve of these cells */
+    double busy_time;  /**< Time spent by the thread solving its cells at the last solve */
+} VnrThreadState_s;
+
+struct VnrSolver
+{
+    unsigned int capacity;  /**< Maximum size of the problems */
+    unsigned int chunk_capacity;  /**< Maximum size of the chunk handled by one thread */
+    int nb_threads;  /**< Number of threads (and thus of chunks) */
+    VnrThreadTeam_s *team;  /**< Worker threads kept from one solve to the other (NULL for the one-shot resolutions) */
+    VnrSolverOptions_s options;  /**< Options of the solver */
+    VnrThreadState_s *thread_states;  /**< Scratch memory of each thread */
+    NewtonReport_s report;  /**< Report of the last solve */
+    double *initial_guess;  /**< Initial guess of the Newton kernels */
+    double *previous_internal_energy;  /**< Internal energy given to the previous solve (VNR_EXTRAPOLATED_GUESS) */
+    double *previous_solution;  /**< Solution of the previous solve (VNR_EXTRAPOLATED_GUESS) */
+    unsigned int history_size;  /**< Size of the previous solve if it has been recorded, 0 otherwise */
+    unsigned int *invalid_cells;  /**< Cells of the mesh which squared sound speed was negative at the last solve */
+    unsigned int nb_invalid_cells;  /**< Number of such cells */
+    atomic_uint nb_listed_invalid_cells;  /**< Number of invalid cells listed by the threads during the solve */
+    double idle_fraction;  /**< Fraction of the time of the threads spent waiting for the slowest one at the last solve */
+    unsigned int *cell_indices;  /**< Cells of the mesh sorted by material (multi-material solve, allocated at its first use) */
+    double *gathered_arrays;  /**< Arrays of the multi-material solve gathered by material (VNR_NB_GATHERED_ARRAYS
+                                   arrays of capacity values, allocated with cell_indices) */
+};
+
+/**
+ * @brief Build a solver context, with or without its own team of threads
+ *
+ * @param[in] pb_size : maximum size of the problems (i.e number of cells of the mesh)
+ * @param[in] with_team : start the worker threads of the solver (otherwise each solve opens an OpenMP parallel region)
+ * @return VnrSolver_s* : pointer on the newly created solver in case of success, NULL otherwise
+ */
+static VnrSolver_s *create_vnr_solver(const size_t pb_size, const bool with_team)
+{
+    // The cells are indexed on 32 bits by the solver, as by the Newton kernels
+    if (pb_size == 0 || pb_size > NEWTON_MAX_CAPACITY)
+    {
+        fprintf(stderr, "Unable to build a VNR solver for a problem of size %zu!\n", pb_size);
+        return NULL;
+    }
+
+    VnrSolver_s *solver = (VnrSolver_s *)calloc(1, sizeof(VnrSolver_s));
+    if (solver == NULL)
+    {
+        fprintf(stderr, "The allocation of the VNR solver has failed!\n");
+        return NULL;
+    }
+
+    solver->capacity = pb_size;
+    solver->options.use_direct_solve = true;
+    solver->options.kernel = VNR_FUSED_NEWTON_KERNEL;
+    solver->options.use_active_set = false;
+    const NewtonControls_s default_controls = NEWTON_DEFAULT_CONTROLS;
+    solver->options.controls = default_controls;
+    solver->options.initial_guess = VNR_CURRENT_ENERGY_GUESS;
+    solver->options.user_initial_guess = NULL;
+    solver->options.use_eos_cache = true;
+    solver->options.use_thread_team = with_team;
+    solver->options.schedule = VNR_STATIC_SCHEDULE;
+    solver->options.schedule_block_size = VNR_DEFAULT_SCHEDULE_BLOCK_SIZE;
+    solver->nb_threads = omp_get_max_threads();
+    // The chunks of the static schedule are rounded up to a multiple of ARRAY_PADDING_SIZE cells, the last
+    // thread taking what remains, which is at most nb_threads - 1 cells above pb_size / nb_threads for
+    // any problem smaller than the capacity
+    solver->chunk_capacity = pb_size / solver->nb_threads + solver->nb_threads + ARRAY_PADDING_SIZE;
+    solver->thread_states = (VnrThreadState_s *)calloc(solver->nb_threads, sizeof(VnrThreadState_s));
+    if (solver->thread_states == NULL)
+    {
+        fprintf(stderr, "The allocation of the VNR solver thread states has failed!\n");
+        free(solver);
+        return NULL;
+    }
+    solver->initial_guess = allocate_array_data(pb_size);
+    solver->previous_internal_energy = allocate_array_data(pb_size);
+    solver->previous_solution = allocate_array_data(pb_size);
+    solver->invalid_cells = (unsigned int *)calloc(pb_size, sizeof(unsigned int));
+    if (solver->initial_guess == NULL || solver->previous_internal_energy == NULL || solver->previous_solution == NULL ||
+        solver->invalid_cells == NULL)
+    {
+        fprintf(stderr, "The allocation of the VNR solver initial guess and diagnostics has failed!\n");
+        delete_vnr_solver(solver);
+        return NULL;
+    }
+
+    for (int tid = 0; tid < solver->nb_threads; ++tid)
+    {
+        VnrThreadState_s *state = &solver->thread_states[tid];
+        MieGruneisenEOS_s eos = {
+            .is_affine_in_energy = true,
+            .get_pressure_and_derivative = compute_pressure_and_derivative,
+            .get_pressure_and_derivative_on_subset = compute_pressure_and_derivative_on_subset,
+            .get_pressure_and_derivatives = compute_pressure_and_derivatives,
+            .get_pressure_and_sound_speed = compute_pressure_and_sound_speed,
+            .init = init,
+            .finalize = finalize};
+        state->eos = eos;
+        state->workspace = build_newton_workspace(solver->chunk_capacity);
+        state->eos_pressure = allocate_array_data(solver->chunk_capacity);
+        state->eos_dpsurde = allocate_array_data(solver->chunk_capacity);
+        if (allocate_miegruneisen_arrays(&state->eos, solver->chunk_capacity) == EXIT_FAILURE ||
+            state->workspace == NULL || state->eos_pressure == NULL || state->eos_dpsurde == NULL)
+        {
+            fprintf(stderr, "Error during allocation of the scratch memory of thread %d!\n", tid);
+            delete_vnr_solver(solver);
+            return NULL;
+        }
+    }
+
+    if (with_team)
+    {
+        solver->team = build_vnr_thread_team(solver->nb_threads);
+        if (solver->team == NULL)
+        {
+            fprintf(stderr, "Unable to start the threads of the VNR solver!\n");
+            delete_vnr_solver(solver);
+            return NULL;
+        }
+    }
+    return solver;
+}
+
+VnrSolver_s *build_vnr_solver(const size_t pb_size)
+{
+    return create_vnr_solver(pb_size, true);
+}
+
+VnrSolverOptions_s *get_vnr_solver_options(VnrSolver_s *solver)
+{
+    return &solver->options;
+}
+
+int get_vnr_solver_nb_threads(const VnrSolver_s *solver)
+{
+    return solver->nb_threads;
+}
+
+const NewtonReport_s *get_vnr_solver_report(const VnrSolver_s *solver)
+{
+    return &solver->report;
+}
+
+const unsigned int *get_vnr_solver_invalid_cells(const VnrSolver_s *solver, unsigned int *nb_invalid_cells)
+{
+    *nb_invalid_cells = solver->nb_invalid_cells;
+    return solver->invalid_cells;
+}
+
+double get_vnr_solver_idle_fraction(const VnrSolver_s *solver)
+{
+    return solver->idle_fraction;
+}
+
+int pin_vnr_solver_threads(VnrSolver_s *solver, const int *cpus)
+{
+    if (solver->team == NULL)
+    {
+        fprintf(stderr, "The solver has no team of threads to pin!\n");
+        return EXIT_FAILURE;
+    }
+    return pin_vnr_thread_team(solver->team, cpus);
+}
+
+void delete_vnr_solver(VnrSolver_s *solver)
 {
-    assert(is_valid_array(old_specific_volume));
-    assert(is_valid_array(new_specific_volume));
-    assert(is_valid_array(pressure));
-    assert(is_valid_array(internal_energy));
-    assert(is_valid_array(solution));
-    assert(is_valid_array(new_p));
-    assert(is_valid_array(new_vson));
+    if (solver)
+    {
+        delete_vnr_thread_team(solver->team);
+        for (int tid = 0; tid < solver->nb_threads; ++tid)
+        {
+            VnrThreadState_s *state = &solver->thread_states[tid];
+            finalize(&state->eos);
+            delete_newton_workspace(state->workspace);
+            free_array_data(state->eos_pressure);
+            free_array_data(state->eos_dpsurde);
+            free_array_data(state->float_buffer);
+        }
+        free(solver->thread_states);
+        free_array_data(solver->initial_guess);
+        free_array_data(solver->previous_internal_energy);
+        free_array_data(solver->previous_solution);
+        free(solver->invalid_cells);
+        free(solver->cell_indices);
+        free_array_data(solver->gathered_arrays);
+        free(solver);
+    }
+}
 
+/**
+ * @brief Problem solved by the threads. Its arrays are sorted by material : the cells of the material m
+ *        are the ones in [material_offsets[m], material_offsets[m + 1][
+ *
+ */
+typedef struct VnrProblem
+{
+    unsigned int size;  /**< Number of cells */
+    const EosParams_s *materials;  /**< Parameters of the eos of each material */
+    const unsigned int *material_offsets;  /**< Index of the first cell of each material (nb_materials + 1 values) */
+    const unsigned int *cell_indices;  /**< Index in the mesh of each cell (NULL if the cells are in the order of the mesh) */
+    double *old_specific_volume;  /**< Current specific volume */
+    double *new_specific_volume;  /**< Next time step specific volume */
+    double *pressure;  /**< Current pressure */
+    double *internal_energy;  /**< Current internal energy */
+    double *solution;  /**< Internal energy at next time step */
+    double *new_p;  /**< Pressure at next time step */
+    double *new_vson;  /**< Sound speed at next time step */
+    const double *epsilon_per_cell;  /**< Per cell tolerance of the Newton kernels (may be NULL) */
+    const double *precision_per_cell;  /**< Per cell tolerance of the Newton kernels (may be NULL) */
+    const double *user_initial_guess;  /**< Initial guess of the caller (VNR_USER_GUESS) */
+} VnrProblem_s;
+
+/**
+ * @brief Return the index in the mesh of a cell of the problem
+ *
+ * @param[in] problem : the problem
+ * @param[in] cell : index of the cell in the problem
+ * @return unsigned int : index of the cell in the mesh
+ */
+static inline unsigned int get_mesh_index(const VnrProblem_s *problem, const unsigned int cell)
+{
+    return problem->cell_indices ? problem->cell_indices[cell] : cell;
+}
+
+/**
+ * @brief Compute the initial guess of the Newton kernels on a batch of cells
+ *
+ * @param[in] solver : the solver
+ * @param[in] problem : the problem
+ * @param[in] offset : index of the first cell of the batch
+ * @param[in] batch_size : number of cells of the batch
+ * @return double* : the initial guess of the batch (the current internal energy itself
+ *                   if it is the guess, the batch of the initial guess buffer of the solver otherwise)
+ */
+static double *compute_initial_guess(const VnrSolver_s *solver, const VnrProblem_s *problem, const unsigned int offset,
+                                     const unsigned int batch_size)
+{
+    double *const e_old = problem->internal_energy + offset;
+    double *const guess = solver->initial_guess + offset;
+    switch (solver->options.initial_guess)
+    {
+    case VNR_USER_GUESS:
+        memcpy(guess, problem->user_initial_guess + offset, batch_size * sizeof(double));
+        return guess;
+    case VNR_PREDICTOR_GUESS:
+        for (unsigned int i = 0; i < batch_size; ++i)
+        {
+            const double delta_v = problem->new_specific_volume[offset + i] - problem->old_specific_volume[offset + i];
+            guess[i] = e_old[i] - problem->pressure[offset + i] * delta_v;
+        }
+        return guess;
+    case VNR_EXTRAPOLATED_GUESS:
+        // Without the previous solve, falls back to the current internal energy
+        if (solver->history_size != problem->size)
+            return e_old;
+        // The history is indexed on the mesh
+        for (unsigned int i = 0; i < batch_size; ++i)
+        {
+            const unsigned int cell = get_mesh_index(problem, offset + i);
+            guess[i] = e_old[i] + (solver->previous_solution[cell] - solver->previous_internal_energy[cell]);
+        }
+        return guess;
+    default:
+        return e_old;
+    }
+}
+
+/**
+ * @brief Solve the equation on a batch of cells of the same material
+ *
+ * @param[in] solver : the solver
+ * @param[in] state : scratch memory of the thread
+ * @param[in] problem : the problem
+ * @param[in] material : parameters of the eos of the cells of the batch
+ * @param[in] offset : index of the first cell of the batch
+ * @param[in] batch_size : number of cells of the batch
+ * @param[out] report : report of the solve of the batch
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : if the eos could not be initialized, the equation could not be solved on every cell
+ *                                or the squared sound speed of some cells is negative
+ */
+static int solve_batch(VnrSolver_s *solver, VnrThreadState_s *state, const VnrProblem_s *problem,
+                       const EosParams_s *material, const unsigned int offset, const unsigned int batch_size,
+                       NewtonReport_s *report)
+{
+    const NewtonControls_s *controls = &solver->options.controls;
+    reset_newton_report(report);
+
+    // The per cell tolerances of the batch
+    NewtonControls_s batch_controls = *controls;
+    batch_controls.tolerances.epsilon_per_cell = problem->epsilon_per_cell ? problem->epsilon_per_cell + offset : NULL;
+    batch_controls.tolerances.precision_per_cell = problem->precision_per_cell ? problem->precision_per_cell + offset : NULL;
+
+    // EOS definition. The table is used for the MieGruneisen material it has been built for.
+    MieGruneisenEOS_s *mie_gruneisen_eos = &state->eos;
+    if (set_eos_params(mie_gruneisen_eos, material) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    const MieGruneisenTable_s *eos_table = solver->options.eos_table;
+    const bool use_table = material->type == MIEGRUNEISEN_EOS && eos_table &&
+                           memcmp(&eos_table->params, &material->miegruneisen, sizeof(MieGruneisenParams_s)) == 0;
+    mie_gruneisen_eos->table = use_table ? eos_table : NULL;
+    if (use_table)
+        mie_gruneisen_eos->init = init_from_table;
+
+    // Compute all terms that are parameters of the eos (i.e all that depends on specific_volume),
+    // only where the specific volume has changed if the cache is used
+    int ret_code = solver->options.use_eos_cache ?
+                   update_miegruneisen_terms(mie_gruneisen_eos, batch_size, problem->new_specific_volume + offset, NULL) :
+                   mie_gruneisen_eos->init(mie_gruneisen_eos, batch_size, problem->new_specific_volume + offset);
+    if (ret_code == EXIT_FAILURE) {
+        fprintf(stderr, "An error occured during the eos initialization!\n");
+        fprintf(stderr, "Batch size : %u\n", batch_size);
+        return EXIT_FAILURE;
+    }
+
+    s_array batch_old_spec_vol = wrap_array(problem->old_specific_volume + offset, batch_size,
+                                            "Batch old specific volume");
+    s_array batch_new_spec_vol = wrap_array(problem->new_specific_volume + offset, batch_size,
+                                            "Batch new specific volume");
+    s_array batch_internal_energy = wrap_array(problem->internal_energy + offset, batch_size, "Batch internal energy");
+    s_array batch_pressure = wrap_array(problem->pressure + offset, batch_size, "Batch pressure");
+    s_array batch_solution = wrap_array(problem->solution + offset, batch_size, "Batch solution");
+
+    VnrParameters_s VnrVars = {&batch_old_spec_vol,
+                               &batch_new_spec_vol,
+                               &batch_internal_energy,
+                               &batch_pressure,
+                               mie_gruneisen_eos,
+                               state->eos_pressure,
+                               state->eos_dpsurde};
+    const bool use_direct_solve = solver->options.use_direct_solve && mie_gruneisen_eos->is_affine_in_energy;
+    // Initial guess of the Newton kernels
+    s_array batch_initial_guess = wrap_array(use_direct_solve ? NULL :
+                                             compute_initial_guess(solver, problem, offset, batch_size),
+                                             batch_size, "Batch initial guess");
+    if (use_direct_solve)
+    {
+        ret_code = solve_internal_energy_evolution_VNR_direct(&VnrVars, &batch_solution);
+        report->nb_cells = batch_size;
+        report->nb_iterations = 1;
+        report->iterations_histogram[1] = batch_size;
+    }
+    else if (solver->options.kernel == VNR_FUSED_NEWTON_KERNEL && !controls->safeguarded &&
+             mie_gruneisen_eos->is_affine_in_energy)
+    {
+        ret_code = solve_internal_energy_evolution_VNR_fused(&VnrVars, &batch_initial_guess, &batch_solution,
+                                                             state->workspace->has_converged, &batch_controls,
+                                                             report);
+    }
+    else if (solver->options.kernel == VNR_MIXED_PRECISION_KERNEL && !controls->safeguarded &&
+             mie_gruneisen_eos->is_affine_in_energy)
+    {
+        if (state->float_buffer == NULL)
+        {
+            state->float_buffer = (float *)allocate_array_memory(VNR_MIXED_NB_FLOAT_ARRAYS *
+                                                                 (size_t)solver->chunk_capacity * sizeof(float));
+            if (state->float_buffer == NULL)
+            {
+                fprintf(stderr, "The allocation of the single precision arrays of the thread has failed!\n");
+                return EXIT_FAILURE;
+            }
+        }
+        ret_code = solve_internal_energy_evolution_VNR_mixed(&VnrVars, &batch_initial_guess, &batch_solution,
+                                                             state->workspace->has_converged, state->float_buffer,
+                                                             &batch_controls, report);
+    }
+    else if (solver->options.kernel == VNR_CELL_MAJOR_NEWTON_KERNEL && !controls->safeguarded &&
+             mie_gruneisen_eos->is_affine_in_energy)
+    {
+        ret_code = solve_internal_energy_evolution_VNR_cell_major(&VnrVars, &batch_initial_guess, &batch_solution,
+                                                                  &batch_controls, report);
+    }
+    else
+    {
+        NewtonParameters_s TheNewton = {
+            .evaluate_the_function = internal_energy_evolution_VNR,
+            .compute_increment_vector = classical_incrementation,
+            .check_convergence = relative_gap,
+            .evaluate_the_function_on_subset = solver->options.use_active_set && !controls->safeguarded ?
+                                               internal_energy_evolution_VNR_on_subset : NULL,
+            .controls = &batch_controls};
+        if (solver->options.kernel == VNR_HALLEY_KERNEL)
+        {
+            TheNewton.evaluate_the_function_on_subset = NULL;
+            TheNewton.evaluate_the_function_and_second_derivative = internal_energy_evolution_VNR_with_second_derivative;
+            TheNewton.compute_second_order_increment_vector = halley_incrementation;
+        }
+        ret_code = solveNewtonWithWorkspace(&TheNewton, &VnrVars, &batch_initial_guess, &batch_solution,
+                                            state->workspace);
+        *report = state->workspace->report;
+    }
+    if (ret_code == EXIT_FAILURE)
+        return EXIT_FAILURE;
+
+    if (solver->options.initial_guess == VNR_EXTRAPOLATED_GUESS)
+    {
+        for (unsigned int i = 0; i < batch_size; ++i)
+        {
+            const unsigned int cell = get_mesh_index(problem, offset + i);
+            solver->previous_internal_energy[cell] = problem->internal_energy[offset + i];
+            solver->previous_solution[cell] = problem->solution[offset + i];
+        }
+    }
+    // Appel de l'eos avec la solution du newton pour calculer la nouvelle
+    // pression et vitesse du son
+    const unsigned int nb_invalid = VnrVars.miegruneisen->get_pressure_and_sound_speed(
+        VnrVars.miegruneisen, batch_size, problem->new_specific_volume + offset, problem->solution + offset,
+        problem->new_p + offset, problem->new_vson + offset);
+    if (nb_invalid > 0)
+    {
+        // Cold path : the invalid cells are listed after the ones already listed by any thread
+        const unsigned int first_listed = atomic_fetch_add_explicit(&solver->nb_listed_invalid_cells, nb_invalid,
+                                                                    memory_order_relaxed);
+        unsigned int *invalid_cells = solver->invalid_cells + first_listed;
+        list_invalid_sound_speeds(VnrVars.miegruneisen, batch_size, invalid_cells);
+        for (unsigned int k = 0; k < nb_invalid; ++k)
+        {
+            const unsigned int i = offset + invalid_cells[k];
+            invalid_cells[k] = get_mesh_index(problem, i);
+            if (k < VNR_NB_PRINTED_INVALID_CELLS)
+            {
+                fprintf(stderr, "Negative squared sound speed in the cell %u : specific volume = %15.9g, "
+                        "internal energy = %15.9g, pressure = %15.9g\n", invalid_cells[k],
+                        problem->new_specific_volume[i], problem->solution[i], problem->new_p[i]);
+            }
+        }
+        if (nb_invalid > VNR_NB_PRINTED_INVALID_CELLS)
+            fprintf(stderr, "... %u cells with a negative squared sound speed!\n", nb_invalid);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Give the chunk of cells of a thread in the static schedule : pb_size / nb_threads cells rounded up
+ *        to a multiple of ARRAY_PADDING_SIZE, so that the chunks of an aligned array stay aligned,
+ *        the last thread taking the remaining cells
+ *
+ * @param[in] pb_size : number of cells
+ * @param[in] nb_threads : number of threads
+ * @param[in] tid : index of the thread
+ * @param[out] first : first cell of the chunk
+ * @param[out] end : cell following the last one of the chunk
+ */
+static void get_static_chunk(const unsigned int pb_size, const int nb_threads, const int tid, unsigned int *first,
+                             unsigned int *end)
+{
+    const unsigned int chunk_size = (pb_size / nb_threads + ARRAY_PADDING_SIZE - 1) / ARRAY_PADDING_SIZE *
+                                    ARRAY_PADDING_SIZE;
+    const unsigned long chunk_first = (unsigned long)tid * chunk_size;
+    *first = chunk_first < pb_size ? chunk_first : pb_size;
+    *end = tid == nb_threads - 1 || pb_size - *first < chunk_size ? pb_size : *first + chunk_size;
+}
+
+/**
+ * @brief Run a task on each thread of the solver : the ones of its team if it has one and it is enabled,
+ *        otherwise the ones of an OpenMP parallel region
+ *
+ * @param[in] solver : the solver
+ * @param[in] task : task to run, given the index of the thread
+ * @param[in] context : context of the task
+ */
+static void run_on_solver_threads(VnrSolver_s *solver, VnrTeamTask task, void *context)
+{
+    const int n_threads = solver->nb_threads;
+    if (solver->team != NULL && solver->options.use_thread_team)
+    {
+        run_vnr_thread_team(solver->team, task, context);
+        return;
+    }
+#pragma omp parallel num_threads(n_threads)
+    {
+        // If the runtime gives less threads than requested, each thread handles several chunks
+        for (int tid = omp_get_thread_num(); tid < n_threads; tid += omp_get_num_threads())
+        {
+            task(context, tid);
+        }
+    }
+}
+
+/**
+ * @brief Solve the cells [first, end[ of the problem, split into batches of cells of the same material
+ *
+ * @param[in] solver : the solver
+ * @param[in] state : scratch memory of the thread
+ * @param[in] problem : the problem
+ * @param[in] first_cell : first cell
+ * @param[in] end : cell following the last one
+ * @param[in] tid : index of the thread (for the messages)
+ */
+static void solve_cells(VnrSolver_s *solver, VnrThreadState_s *state, const VnrProblem_s *problem,
+                        const unsigned int first_cell, const unsigned int end, const int tid)
+{
+    unsigned int material = 0;
+    for (unsigned int first = first_cell; first < end;)
+    {
+        while (problem->material_offsets[material + 1] <= first)
+            ++material;
+        const unsigned int material_end = problem->material_offsets[material + 1];
+        const unsigned int last = material_end < end ? material_end : end;
+        NewtonReport_s batch_report;
+        if (solve_batch(solver, state, problem, &problem->materials[material], first, last - first,
+                        &batch_report) == EXIT_FAILURE)
+        {
+            fprintf(stderr, "Unable to solve the equation on the cells [%u, %u[ of thread %d(/%d) (material %u)!\n",
+                    first, last, tid, solver->nb_threads, material);
+            state->status = EXIT_FAILURE;
+        }
+        merge_newton_reports(&state->report, &batch_report);
+        first = last;
+    }
+}
+
+/**
+ * @brief Context of the task run by the threads of the solver
+ *
+ */
+typedef struct VnrChunkTask
+{
+    VnrSolver_s *solver;  /**< The solver */
+    const VnrProblem_s *problem;  /**< The problem */
+    unsigned int block_size;  /**< Number of cells of the blocks of the dynamic schedule */
+    atomic_uint next_block;  /**< Next block of the dynamic schedule to be solved */
+} VnrChunkTask_s;
+
+/**
+ * @brief Task of each thread : solve its chunk of pb_size / nb_threads cells (static schedule)
+ *        or the blocks it takes until none is left (dynamic schedule)
+ *
+ * @param[in] context : the VnrChunkTask_s
+ * @param[in] tid : index of the thread (and of the scratch memory used)
+ */
+static void solve_chunk_task(void *context, const int tid)
+{
+    VnrChunkTask_s *chunk_task = (VnrChunkTask_s *)context;
+    VnrSolver_s *solver = chunk_task->solver;
+    const VnrProblem_s *problem = chunk_task->problem;
+    const unsigned int pb_size = problem->size;
+    const int n_threads = solver->nb_threads;
+    VnrThreadState_s *state = &solver->thread_states[tid];
+    const double start = omp_get_wtime();
+    reset_newton_report(&state->report);
+    state->status = EXIT_SUCCESS;
+
+    if (solver->options.schedule == VNR_DYNAMIC_SCHEDULE)
+    {
+        const unsigned int block_size = chunk_task->block_size;
+        for (;;)
+        {
+            const size_t first = (size_t)atomic_fetch_add_explicit(&chunk_task->next_block, 1, memory_order_relaxed) *
+                                 block_size;
+            if (first >= pb_size)
+                break;
+            const unsigned int end = pb_size - first > block_size ? first + block_size : pb_size;
+            solve_cells(solver, state, problem, first, end, tid);
+        }
+    }
+    else
+    {
+        unsigned int first, end;
+        get_static_chunk(pb_size, n_threads, tid, &first, &end);
+        solve_cells(solver, state, problem, first, end, tid);
+    }
+    state->busy_time = omp_get_wtime() - start;
+}
+
+/**
+ * @brief Context of the first touch of the arrays
+ *
+ */
+typedef struct VnrFirstTouch
+{
+    const VnrSolver_s *solver;  /**< The solver */
+    p_array array;  /**< Array to touch */
+} VnrFirstTouch_s;
+
+/**
+ * @brief Zero the static chunk of the array of the thread, so that its pages are mapped on the NUMA node of the thread
+ *
+ * @param[in] context : the VnrFirstTouch_s
+ * @param[in] tid : index of the thread
+ */
+static void touch_chunk_task(void *context, const int tid)
+{
+    const VnrFirstTouch_s *first_touch = (const VnrFirstTouch_s *)context;
+    unsigned int first, end;
+    get_static_chunk(first_touch->array->size, first_touch->solver->nb_threads, tid, &first, &end);
+    memset(first_touch->array->data + first, 0, (end - first) * sizeof(double));
+}
+
+p_array build_vnr_solver_array(VnrSolver_s *solver, const size_t size, const char *label)
+{
+    if (size > solver->capacity)
+    {
+        fprintf(stderr, "The size of the array %s (%zu) is above the capacity of the solver (%u)!\n",
+                label ? label : "unnamed", size, solver->capacity);
+        return NULL;
+    }
+    p_array array = build_array_untouched(size, label);
+    if (array == NULL)
+        return NULL;
+    VnrFirstTouch_s first_touch = {solver, array};
+    run_on_solver_threads(solver, touch_chunk_task, &first_touch);
+    return array;
+}
+
+/**
+ * @brief Compare two cell indices (qsort)
+ *
+ * @return int : negative, null or positive if the first index is below, equal to or above the second one
+ */
+static int compare_cells(const void *first, const void *second)
+{
+    const unsigned int a = *(const unsigned int *)first;
+    const unsigned int b = *(const unsigned int *)second;
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Solve the problem with the schedule of the options, on the threads of the solver
+ *
+ * @param[in] solver : the solver
+ * @param[in] problem : the problem
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : if the equation could not be solved on every cell
+ */
+static int solve_problem(VnrSolver_s *solver, const VnrProblem_s *problem)
+{
+    const unsigned int pb_size = problem->size;
+    const int n_threads = solver->nb_threads;
+
+    // The blocks should fit in the scratch memory of a thread
+    const unsigned int block_size = solver->options.schedule_block_size < solver->chunk_capacity ?
+                                    solver->options.schedule_block_size : solver->chunk_capacity;
+    VnrChunkTask_s chunk_task = {.solver = solver, .problem = problem, .block_size = block_size};
+    atomic_init(&chunk_task.next_block, 0);
+    atomic_store_explicit(&solver->nb_listed_invalid_cells, 0, memory_order_relaxed);
+    run_on_solver_threads(solver, solve_chunk_task, &chunk_task);
+
+    int status = EXIT_SUCCESS;
+    reset_newton_report(&solver->report);
+    double total_busy_time = 0.;
+    double max_busy_time = 0.;
+    for (int tid = 0; tid < n_threads; ++tid)
+    {
+        const VnrThreadState_s *state = &solver->thread_states[tid];
+        merge_newton_reports(&solver->report, &state->report);
+        if (state->status == EXIT_FAILURE)
+            status = EXIT_FAILURE;
+        total_busy_time += state->busy_time;
+        max_busy_time = state->busy_time > max_busy_time ? state->busy_time : max_busy_time;
+    }
+    solver->idle_fraction = max_busy_time > 0. ? 1. - total_busy_time / (n_threads * max_busy_time) : 0.;
+    // The invalid cells are listed by the threads in any order
+    solver->nb_invalid_cells = atomic_load_explicit(&solver->nb_listed_invalid_cells, memory_order_relaxed);
+    if (solver->nb_invalid_cells > 1)
+        qsort(solver->invalid_cells, solver->nb_invalid_cells, sizeof(unsigned int), compare_cells);
+    solver->history_size = solver->options.initial_guess == VNR_EXTRAPOLATED_GUESS && status == EXIT_SUCCESS ? pb_size : 0;
+    return status;
+}
+
+/**
+ * @brief Check the solver, the arrays given to the resolution and the options of the solver
+ *
+ * @param[in] is_streamed : true if the problem is solved by blocks of the capacity of the solver, thus may be larger
+ * @return int EXIT_SUCCESS (0) : if the problem may be solved by the solver
+ *             EXIT_FAILURE (1) : otherwise
+ */
+static int check_problem(const VnrSolver_s *solver, const bool is_streamed, p_array old_specific_volume,
+                         p_array new_specific_volume, p_array pressure, p_array internal_energy, p_array solution,
+                         p_array new_p, p_array new_vson)
+{
+    if (solver == NULL) {
+        fprintf(stderr, "No solver has been given!\n");
+        return EXIT_FAILURE;
+    }
+
+    // The size of the first array is read once it is known to be valid
+    const p_array arrays[7] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution, new_p,
+                               new_vson};
+    for (unsigned int a = 0; a < 7; ++a)
+    {
+        if (!is_valid_array(arrays[a]) || arrays[a]->size != old_specific_volume->size) {
+            fprintf(stderr, "The arrays of the problem should be valid and of the same size!\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    const size_t pb_size = old_specific_volume->size;
+    if (!is_streamed && pb_size > solver->capacity) {
+        fprintf(stderr, "The size of the problem (%zu) is above the capacity of the solver (%u)!\n",
+                pb_size, solver->capacity);
+        return EXIT_FAILURE;
+    }
+
+    if (solver->options.initial_guess == VNR_USER_GUESS && solver->options.user_initial_guess == NULL) {
+        fprintf(stderr, "No initial guess has been given!\n");
+        return EXIT_FAILURE;
+    }
+
+    if (solver->options.schedule == VNR_DYNAMIC_SCHEDULE && solver->options.schedule_block_size == 0) {
+        fprintf(stderr, "The blocks of the dynamic schedule should hold at least one cell!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Check that the table of the eos of the options, if any, has been built with the parameters of the eos solved
+ *
+ * @return int EXIT_SUCCESS (0) : if the table may be used
+ *             EXIT_FAILURE (1) : otherwise
+ */
+static int check_eos_table(const VnrSolver_s *solver, MieGruneisenParams_s const *eos_params)
+{
+    const MieGruneisenTable_s *eos_table = solver->options.eos_table;
+    if (eos_table && memcmp(&eos_table->params, eos_params, sizeof(MieGruneisenParams_s)) != 0) {
+        fprintf(stderr, "The table of the eos has been built with other parameters!\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int launch_vnr_resolution(MieGruneisenParams_s const * eos_params,
+                          p_array old_specific_volume, p_array new_specific_volume,
+                          p_array pressure, p_array internal_energy,
+                          p_array solution, p_array new_p,
+                          p_array new_vson)
+{
+    // The size of the solver is read from the first array, the others are checked by check_problem
+    if (!is_valid_array(old_specific_volume))
+        return EXIT_FAILURE;
+
+    // A single solve : the OpenMP threads are already there, starting a team would cost more
+    VnrSolver_s *solver = create_vnr_solver(old_specific_volume->size, false);
+    if (solver == NULL) {
+        fprintf(stderr, "Unable to build the solver!\n");
+        return EXIT_FAILURE;
+    }
+
+    const int status = launch_vnr_resolution_with_solver(solver, eos_params, old_specific_volume, new_specific_volume,
+                                                         pressure, internal_energy, solution, new_p, new_vson);
+
+    delete_vnr_solver(solver);
+    return status;
+}
+
+int launch_vnr_resolution_with_solver(VnrSolver_s *solver, MieGruneisenParams_s const * eos_params,
+                                      p_array old_specific_volume, p_array new_specific_volume,
+                                      p_array pressure, p_array internal_energy,
+                                      p_array solution, p_array new_p,
+                                      p_array new_vson)
+{
+    if (check_problem(solver, false, old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                      new_p, new_vson) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+
+    if (check_eos_table(solver, eos_params) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+
+    // A single material, the cells being in the order of the mesh
+    const EosParams_s material = {.type = MIEGRUNEISEN_EOS, .miegruneisen = *eos_params};
+    const unsigned int material_offsets[2] = {0, old_specific_volume->size};
+    const VnrProblem_s problem = {.size = old_specific_volume->size,
+                                  .materials = &material,
+                                  .material_offsets = material_offsets,
+                                  .cell_indices = NULL,
+                                  .old_specific_volume = old_specific_volume->data,
+                                  .new_specific_volume = new_specific_volume->data,
+                                  .pressure = pressure->data,
+                                  .internal_energy = internal_energy->data,
+                                  .solution = solution->data,
+                                  .new_p = new_p->data,
+                                  .new_vson = new_vson->data,
+                                  .epsilon_per_cell = solver->options.controls.tolerances.epsilon_per_cell,
+                                  .precision_per_cell = solver->options.controls.tolerances.precision_per_cell,
+                                  .user_initial_guess = solver->options.user_initial_guess};
+    return solve_problem(solver, &problem);
+}
+
+/**
+ * @brief Give a hint on the next accesses to the cells [first, first + size[ of each array of the problem
+ *
+ * @param[in] arrays : the arrays
+ * @param[in] nb_arrays : number of arrays
+ * @param[in] first : first cell
+ * @param[in] size : number of cells
+ * @param[in] advice : the hint
+ */
+static void advise_arrays(p_array const *arrays, const unsigned int nb_arrays, const size_t first, const size_t size,
+                          const ArrayAdvice_e advice)
+{
+    for (unsigned int a = 0; a < nb_arrays; ++a)
+    {
+        // Only a hint : the solve goes on without it
+        advise_array(arrays[a], first, size, advice);
+    }
+}
+
+int launch_vnr_resolution_streamed(VnrSolver_s *solver, MieGruneisenParams_s const *eos_params,
+                                   p_array old_specific_volume, p_array new_specific_volume,
+                                   p_array pressure, p_array internal_energy,
+                                   p_array solution, p_array new_p,
+                                   p_array new_vson)
+{
+    if (check_problem(solver, true, old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                      new_p, new_vson) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if (check_eos_table(solver, eos_params) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+
+    // The inputs first, then the outputs
+    p_array arrays[7] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution, new_p,
+                         new_vson};
+    const size_t pb_size = old_specific_volume->size;
+    // Blocks of whole pages, so that the blocks of a mapped array start on a page (thus stay aligned)
+    const unsigned int page_values = sysconf(_SC_PAGESIZE) / sizeof(double);
+    const unsigned int block_size = solver->capacity >= page_values ?
+                                    solver->capacity / page_values * page_values : solver->capacity;
+    const EosParams_s material = {.type = MIEGRUNEISEN_EOS, .miegruneisen = *eos_params};
+    const ConvergenceTolerances_s *tolerances = &solver->options.controls.tolerances;
+    const double *user_initial_guess = solver->options.user_initial_guess;
+    NewtonReport_s report;
+    reset_newton_report(&report);
+    int status = EXIT_SUCCESS;
+    advise_arrays(arrays, 4, 0, pb_size < block_size ? pb_size : block_size, ARRAY_WILL_NEED);
+    for (size_t first = 0; first < pb_size && status == EXIT_SUCCESS; first += block_size)
+    {
+        const unsigned int size = pb_size - first < block_size ? pb_size - first : block_size;
+        // The inputs of the next block are read while this one is solved
+        if (first + size < pb_size)
+            advise_arrays(arrays, 4, first + size, pb_size - first - size < block_size ?
+                          pb_size - first - size : block_size, ARRAY_WILL_NEED);
+
+        const unsigned int material_offsets[2] = {0, size};
+        const VnrProblem_s problem = {.size = size,
+                                      .materials = &material,
+                                      .material_offsets = material_offsets,
+                                      .cell_indices = NULL,
+                                      .old_specific_volume = old_specific_volume->data + first,
+                                      .new_specific_volume = new_specific_volume->data + first,
+                                      .pressure = pressure->data + first,
+                                      .internal_energy = internal_energy->data + first,
+                                      .solution = solution->data + first,
+                                      .new_p = new_p->data + first,
+                                      .new_vson = new_vson->data + first,
+                                      .epsilon_per_cell = tolerances->epsilon_per_cell ?
+                                                          tolerances->epsilon_per_cell + first : NULL,
+                                      .precision_per_cell = tolerances->precision_per_cell ?
+                                                            tolerances->precision_per_cell + first : NULL,
+                                      .user_initial_guess = user_initial_guess ? user_initial_guess + first : NULL};
+        // The history of the solver would be the one of the previous block
+        solver->history_size = 0;
+        status = solve_problem(solver, &problem);
+        if (status == EXIT_FAILURE)
+            fprintf(stderr, "Unable to solve the block [%zu, %zu[ of the streamed problem!\n", first, first + size);
+        merge_newton_reports(&report, &solver->report);
+        // The pages of the block are the first ones given back if the memory is short
+        advise_arrays(arrays, 7, first, size, ARRAY_COLD);
+    }
+    solver->history_size = 0;
+    solver->report = report;
+    return status;
+}
+
+/**
+ * @brief Context of the gathering of the cells by material and of their scattering back to the mesh
+ *
+ */
+typedef struct VnrGatherTask
+{
+    const VnrSolver_s *solver;  /**< The solver */
+    unsigned int nb_cells;  /**< Number of cells */
+    const unsigned int *cell_indices;  /**< Index in the mesh of each gathered cell */
+    const double *inputs[VNR_NB_GATHERED_ARRAYS];  /**< Values of the mesh to gather (NULL if none) */
+    double *outputs[VNR_NB_GATHERED_ARRAYS];  /**< Values of the mesh to scatter to (NULL if none) */
+    double *const *gathered;  /**< Values gathered by material */
+} VnrGatherTask_s;
+
+/**
+ * @brief Gather the inputs of the static chunk of cells of the thread
+ *
+ * @param[in] context : the VnrGatherTask_s
+ * @param[in] tid : index of the thread
+ */
+static void gather_chunk_task(void *context, const int tid)
+{
+    const VnrGatherTask_s *gather_task = (const VnrGatherTask_s *)context;
+    const unsigned int *cell_indices = gather_task->cell_indices;
+    unsigned int first, end;
+    get_static_chunk(gather_task->nb_cells, gather_task->solver->nb_threads, tid, &first, &end);
+    for (int a = 0; a < VNR_NB_GATHERED_ARRAYS; ++a)
+    {
+        const double *values = gather_task->inputs[a];
+        if (values == NULL)
+            continue;
+        double *gathered = gather_task->gathered[a];
+        for (unsigned int i = first; i < end; ++i)
+        {
+            gathered[i] = values[cell_indices[i]];
+        }
+    }
+}
+
+/**
+ * @brief Scatter the outputs of the static chunk of cells of the thread
+ *
+ * @param[in] context : the VnrGatherTask_s
+ * @param[in] tid : index of the thread
+ */
+static void scatter_chunk_task(void *context, const int tid)
+{
+    const VnrGatherTask_s *gather_task = (const VnrGatherTask_s *)context;
+    const unsigned int *cell_indices = gather_task->cell_indices;
+    unsigned int first, end;
+    get_static_chunk(gather_task->nb_cells, gather_task->solver->nb_threads, tid, &first, &end);
+    for (int a = 0; a < VNR_NB_GATHERED_ARRAYS; ++a)
+    {
+        double *values = gather_task->outputs[a];
+        if (values == NULL)
+            continue;
+        const double *gathered = gather_task->gathered[a];
+        for (unsigned int i = first; i < end; ++i)
+        {
+            values[cell_indices[i]] = gathered[i];
+        }
+    }
+}
+
+int launch_multimaterial_vnr_resolution(const EosParams_s *materials, const unsigned int nb_materials,
+                                        const unsigned int *material_ids,
+                                        p_array old_specific_volume, p_array new_specific_volume,
+                                        p_array pressure, p_array internal_energy,
+                                        p_array solution, p_array new_p,
+                                        p_array new_vson)
+{
+    // The size of the solver is read from the first array, the others are checked by check_problem
+    if (!is_valid_array(old_specific_volume))
+        return EXIT_FAILURE;
+
+    // A single solve : the OpenMP threads are already there, starting a team would cost more
+    VnrSolver_s *solver = create_vnr_solver(old_specific_volume->size, false);
+    if (solver == NULL) {
+        fprintf(stderr, "Unable to build the solver!\n");
+        return EXIT_FAILURE;
+    }
+
+    const int status = launch_multimaterial_vnr_resolution_with_solver(solver, materials, nb_materials, material_ids,
+                                                                       old_specific_volume, new_specific_volume,
+                                                                       pressure, internal_energy, solution, new_p,
+                                                                       new_vson);
+
+    delete_vnr_solver(solver);
+    return status;
+}
+
+int launch_multimaterial_vnr_resolution_with_solver(VnrSolver_s *solver, const EosParams_s *materials,
+                                                    const unsigned int nb_materials, const unsigned int *material_ids,
+                                                    p_array old_specific_volume, p_array new_specific_volume,
+                                                    p_array pressure, p_array internal_energy,
+                                                    p_array solution, p_array new_p,
+                                                    p_array new_vson)
+{
+    if (check_problem(solver, false, old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                      new_p, new_vson) == EXIT_FAILURE)
+        return EXIT_FAILURE;
+    if (nb_materials == 0 || nb_materials > VNR_MAX_NB_MATERIALS) {
+        fprintf(stderr, "The number of materials (%u) should be in [1, %d]!\n", nb_materials, VNR_MAX_NB_MATERIALS);
+        return EXIT_FAILURE;
+    }
+    if (materials == NULL || material_ids == NULL) {
+        fprintf(stderr, "The materials and the material of each cell should be given!\n");
+        return EXIT_FAILURE;
+    }
+
+    // Number of cells of each material (counting sort)
     const unsigned int pb_size = old_specific_volume->size;
+    unsigned int material_offsets[VNR_MAX_NB_MATERIALS + 1] = {0};
+    bool is_sorted = true;
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        if (material_ids[i] >= nb_materials) {
+            fprintf(stderr, "The material of the cell %u (%u) is not one of the %u materials!\n", i, material_ids[i],
+                    nb_materials);
+            return EXIT_FAILURE;
+        }
+        material_offsets[material_ids[i] + 1]++;
+        if (i > 0 && material_ids[i] < material_ids[i - 1])
+            is_sorted = false;
+    }
+    for (unsigned int m = 0; m < nb_materials; ++m)
+    {
+        material_offsets[m + 1] += material_offsets[m];
+    }
+
+    const ConvergenceTolerances_s *tolerances = &solver->options.controls.tolerances;
+    VnrProblem_s problem = {.size = pb_size,
+                            .materials = materials,
+                            .material_offsets = material_offsets,
+                            .cell_indices = NULL,
+                            .old_specific_volume = old_specific_volume->data,
+                            .new_specific_volume = new_specific_volume->data,
+                            .pressure = pressure->data,
+                            .internal_energy = internal_energy->data,
+                            .solution = solution->data,
+                            .new_p = new_p->data,
+                            .new_vson = new_vson->data,
+                            .epsilon_per_cell = tolerances->epsilon_per_cell,
+                            .precision_per_cell = tolerances->precision_per_cell,
+                            .user_initial_guess = solver->options.user_initial_guess};
+    // Cells already grouped by material are solved in place
+    if (is_sorted)
+        return solve_problem(solver, &problem);
 
-    assert(pb_size == new_specific_volume->size);
-    assert(pb_size == pressure->size);
-    assert(pb_size == internal_energy->size);
-    assert(pb_size == solution->size);
-    assert(pb_size == new_p->size);
-    assert(pb_size == new_vson->size);
-
-    // Function to solve (internal energy evolution in the vNR scheme)
-#pragma omp parallel
-    {
-        /* Obtain and print thread id */
-        int tid = omp_get_thread_num();
-        int n_threads = omp_get_num_threads();
-
-        int chunk_size = pb_size / n_threads;
-        int offset = tid * chunk_size;
-        int remain_chunk_size = pb_size % n_threads;
-        if (tid == n_threads - 1) chunk_size += remain_chunk_size;
-
-        // EOS definition
-        MieGruneisenEOS_s mie_gruneisen_eos = {
-            eos_params, NULL, NULL, NULL, NULL, NULL, 
-            compute_pressure_and_derivative, compute_pressure_and_sound_speed,
-            init, finalize};
-
-        // Compute all terms that are parameters of the eos (i.e all that depends on specific_volume)
-        int ret_code = mie_gruneisen_eos.init(&mie_gruneisen_eos, chunk_size, new_specific_volume->data + offset);
-        if (ret_code == EXIT_FAILURE) {
-            fprintf(stderr, "An error occured during MieGruneisen initialization!\n");
-            fprintf(stderr, "Thread id : %d(/%d)\n", tid, n_threads);
-            fprintf(stderr, "Chunk size : %d\n", chunk_size);
-            exit(1);
-        }
-
-        s_array thread_old_spec_vol = {chunk_size, "Thread old specific volume", old_specific_volume->data + offset};
-        s_array thread_new_spec_vol = {chunk_size, "Thread new specific volume", new_specific_volume->data + offset};
-        s_array thread_internal_energy = {chunk_size, "Thread internal energy", internal_energy->data + offset};
-        s_array thread_pressure = {chunk_size, "Thread pressure", pressure->data + offset};
-        s_array thread_solution = {chunk_size, "Thread solution", solution->data + offset};
-
-        VnrParameters_s VnrVars = {&thread_old_spec_vol,
-                                   &thread_new_spec_vol,
-                                   &thread_internal_energy,
-                                   &thread_pressure,
-                                   &mie_gruneisen_eos};
-        NewtonParameters_s TheNewton = {internal_energy_evolution_VNR,
-                                        classical_incrementation, relative_gap};
-        ret_code = solveNewton(&TheNewton, &VnrVars, &thread_internal_energy, &thread_solution);
-
-        if (ret_code == EXIT_FAILURE) {
-            fprintf(stderr, "Unable to solve the equation! Aborting!\n");
-            exit(1); // A bit weird to exit inside a thread.
-        }
-        // Appel de l'eos avec la solution du newton pour calculer la nouvelle
-        // pression et vitesse du son
-        VnrVars.miegruneisen->get_pressure_and_sound_speed(VnrVars.miegruneisen, chunk_size, new_specific_volume->data + offset,
-                                                           solution->data + offset, new_p->data + offset, new_vson->data + offset);
-
-        mie_gruneisen_eos.finalize(&mie_gruneisen_eos);
+    // Otherwise the cells are gathered by material in the scratch memory of the solver
+    if (solver->cell_indices == NULL)
+    {
+        solver->cell_indices = (unsigned int *)calloc(solver->capacity, sizeof(unsigned int));
+        solver->gathered_arrays = (double *)allocate_array_memory((size_t)VNR_NB_GATHERED_ARRAYS * solver->capacity *
+                                                                  sizeof(double));
+        if (solver->cell_indices == NULL || solver->gathered_arrays == NULL)
+        {
+            fprintf(stderr, "The allocation of the VNR solver multi-material memory has failed!\n");
+            free(solver->cell_indices);
+            free_array_data(solver->gathered_arrays);
+            solver->cell_indices = NULL;
+            solver->gathered_arrays = NULL;
+            return EXIT_FAILURE;
+        }
+    }
+    unsigned int positions[VNR_MAX_NB_MATERIALS];
+    memcpy(positions, material_offsets, nb_materials * sizeof(unsigned int));
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        solver->cell_indices[positions[material_ids[i]]++] = i;
     }
+    double *gathered[VNR_NB_GATHERED_ARRAYS];
+    for (int a = 0; a < VNR_NB_GATHERED_ARRAYS; ++a)
+    {
+        gathered[a] = solver->gathered_arrays + (size_t)a * solver->capacity;
+    }
+    // The threads of the solver gather and scatter their static chunk of cells
+    VnrGatherTask_s gather_task = {.solver = solver,
+                                   .nb_cells = pb_size,
+                                   .cell_indices = solver->cell_indices,
+                                   .inputs = {old_specific_volume->data, new_specific_volume->data, pressure->data,
+                                              internal_energy->data, NULL, NULL, NULL, tolerances->epsilon_per_cell,
+                                              tolerances->precision_per_cell, solver->options.user_initial_guess},
+                                   .outputs = {NULL, NULL, NULL, NULL, solution->data, new_p->data, new_vson->data,
+                                               NULL, NULL, NULL},
+                                   .gathered = gathered};
+    run_on_solver_threads(solver, gather_chunk_task, &gather_task);
+    problem.cell_indices = solver->cell_indices;
+    problem.old_specific_volume = gathered[0];
+    problem.new_specific_volume = gathered[1];
+    problem.pressure = gathered[2];
+    problem.internal_energy = gathered[3];
+    problem.solution = gathered[4];
+    problem.new_p = gathered[5];
+    problem.new_vson = gathered[6];
+    problem.epsilon_per_cell = tolerances->epsilon_per_cell ? gathered[7] : NULL;
+    problem.precision_per_cell = tolerances->precision_per_cell ? gathered[8] : NULL;
+    problem.user_initial_guess = solver->options.user_initial_guess ? gathered[9] : NULL;
+
+    const int status = solve_problem(solver, &problem);
 
+    run_on_solver_threads(solver, scatter_chunk_task, &gather_task);
+    return status;
 }
@@ -11,9 +11,207 @@
 #ifndef LAUNCH_VNR_RESOLUTION_H
 #define LAUNCH_VNR_RESOLUTION_H
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include "array.h"
+#include "eos_params.h"
 #include "miegruneisen_params.h"
+#include "miegruneisen_table.h"
+#include "newton.h"
+
+/**
+ * @brief Maximum number of materials of a multi-material resolution
+ * 
+ */
+#define VNR_MAX_NB_MATERIALS 64
+
+/**
+ * @brief Maximum number of cells, per batch, which state is printed when their squared sound speed is negative
+ * 
+ */
+#define VNR_NB_PRINTED_INVALID_CELLS 8
+
+/**
+ * @brief Default number of cells of the blocks of the dynamic schedule
+ * 
+ */
+#define VNR_DEFAULT_SCHEDULE_BLOCK_SIZE 1024
+
+/**
+ * @brief A solver context that owns all the scratch memory (eos arrays, Newton workspaces...)
+ *        needed to solve the evolution of the internal energy, and a team of worker threads.
+ *        It is built once for a given mesh size and reused for every solve so that no heap
+ *        allocation nor thread start occurs at each cycle.
+ * 
+ */
+typedef struct VnrSolver VnrSolver_s;
+
+/**
+ * @brief Kernels available to solve the equation
+ * 
+ */
+typedef enum VnrKernel
+{
+    VNR_GENERIC_NEWTON_KERNEL,  /**< Generic Newton-Raphson solver (solveNewton) with callbacks */
+    VNR_FUSED_NEWTON_KERNEL,  /**< Newton-Raphson iterations where all the steps are fused in a single pass per cell
+                                   (eos affine in internal energy only, the generic kernel is used otherwise) */
+    VNR_CELL_MAJOR_NEWTON_KERNEL,  /**< Fused Newton-Raphson iterations run cell by cell until convergence
+                                        (eos affine in internal energy only, the generic kernel is used otherwise) */
+    VNR_HALLEY_KERNEL,  /**< Generic solver with the Halley incrementation, which uses the second derivative given by the eos */
+    VNR_MIXED_PRECISION_KERNEL  /**< Fused iterations in single precision refined by fused iterations in double precision
+                                     (eos affine in internal energy only, the generic kernel is used otherwise) */
+} VnrKernel_e;
+
+/**
+ * @brief Strategies giving the initial guess of the Newton kernels (unused by the direct solve)
+ * 
+ */
+typedef enum VnrInitialGuess
+{
+    VNR_CURRENT_ENERGY_GUESS,  /**< The current internal energy \f$e^n\f$ */
+    VNR_USER_GUESS,  /**< The values given by the caller (see VnrSolverOptions_s::user_initial_guess) */
+    VNR_PREDICTOR_GUESS,  /**< The explicit predictor \f$e^n - P^n (v^{n+1} - v^n)\f$ */
+    VNR_EXTRAPOLATED_GUESS  /**< The current internal energy plus the increment of the previous solve, which
+                                 should have been done with the same strategy on the same mesh. Otherwise, as for the
+                                 first solve, the current internal energy is used */
+} VnrInitialGuess_e;
+
+/**
+ * @brief Distribution of the cells between the threads
+ * 
+ */
+typedef enum VnrSchedule
+{
+    VNR_STATIC_SCHEDULE,  /**< Each thread solves a contiguous chunk of pb_size / nb_threads cells (the last one takes the
+                               remainder). The solve waits for the slowest chunk, e.g the one holding a shock front */
+    VNR_DYNAMIC_SCHEDULE  /**< The threads take blocks of schedule_block_size cells, in the order of the mesh, until none
+                               is left. Each block is solved on its own and stops iterating once its cells have converged */
+} VnrSchedule_e;
+
+/**
+ * @brief Options of the solver. They are initialized to their default values when the solver is built
+ *        and may be modified between two solves (see get_vnr_solver_options).
+ * 
+ */
+typedef struct VnrSolverOptions
+{
+    bool use_direct_solve;  /**< Solve the equation without iteration if the eos is affine in internal energy,
+                                 otherwise fall back to the kernel (default true) */
+    VnrKernel_e kernel;  /**< Kernel used to solve the equation (default VNR_FUSED_NEWTON_KERNEL) */
+    bool use_active_set;  /**< Only iterate on the cells that have not converged yet (generic kernel only, not Halley).
+                               Worth it when the number of iterations varies a lot between cells (default false) */
+    NewtonControls_s controls;  /**< Maximum number of iterations and tolerances of the Newton kernels (default NEWTON_DEFAULT_CONTROLS).
+                                     The per cell tolerance arrays, if any, are indexed on the whole mesh.
+                                     If safeguarded, the generic solver is used without active set whatever the kernel */
+    VnrInitialGuess_e initial_guess;  /**< Strategy giving the initial guess of the Newton kernels (default VNR_CURRENT_ENERGY_GUESS) */
+    const double *user_initial_guess;  /**< Initial guess, indexed on the whole mesh, used with VNR_USER_GUESS */
+    bool use_eos_cache;  /**< Only recompute the terms of the eos that depend on the specific volume where it has changed
+                              since the previous solve (default true). The cache of a thread is only
+                              kept if its chunk of cells holds a single material */
+    const MieGruneisenTable_s *eos_table;  /**< If not NULL, the terms of the eos that depend on the specific volume are
+                                                interpolated in this table instead of being computed (default NULL).
+                                                It must have been built with the parameters of the eos solved.
+                                                In a multi-material resolution, it is used for the MieGruneisen
+                                                materials which parameters are the ones of the table */
+    bool use_thread_team;  /**< Solve with the worker threads of the solver, which wait for the next solve
+                                instead of being joined (default true). Otherwise each solve opens an OpenMP
+                                parallel region. The solvers built internally by the one-shot resolutions
+                                (launch_vnr_resolution...) have no team */
+    VnrSchedule_e schedule;  /**< Distribution of the cells between the threads (default VNR_STATIC_SCHEDULE).
+                                  With the dynamic one, the eos cache of a thread only holds its last block */
+    unsigned int schedule_block_size;  /**< Number of cells of the blocks of the dynamic schedule, at most the size of
+                                            a chunk of the static one (default VNR_DEFAULT_SCHEDULE_BLOCK_SIZE) */
+} VnrSolverOptions_s;
+
+/**
+ * @brief Build a solver context able to handle problems which size is up to pb_size.
+ *        The number of threads used is the one given by omp_get_max_threads() at build time :
+ *        the worker threads of its team are started here and run every solve until the solver is deleted.
+ *        Once used, the solver should be deleted thanks to delete_vnr_solver.
+ * 
+ * @param[in] pb_size : maximum size of the problems (i.e number of cells of the mesh, up to NEWTON_MAX_CAPACITY)
+ * @return VnrSolver_s* : pointer on the newly created solver in case of success, NULL otherwise
+ */
+VnrSolver_s *build_vnr_solver(const size_t pb_size);
+
+/**
+ * @brief Give access to the options of the solver
+ * 
+ * @param[in] solver : the solver
+ * @return VnrSolverOptions_s* : options of the solver that may be modified before the next solve
+ */
+VnrSolverOptions_s *get_vnr_solver_options(VnrSolver_s *solver);
+
+/**
+ * @brief Give the number of threads of the solver
+ * 
+ * @param[in] solver : the solver
+ * @return int : number of threads, including the one calling the solves
+ */
+int get_vnr_solver_nb_threads(const VnrSolver_s *solver);
+
+/**
+ * @brief Give access to the report of the last solve, gathered over all the threads.
+ *        With the direct solve every cell is reported as converged after one iteration
+ *        with a null residual.
+ * 
+ * @param[in] solver : the solver
+ * @return const NewtonReport_s* : the report of the last solve
+ */
+const NewtonReport_s *get_vnr_solver_report(const VnrSolver_s *solver);
+
+/**
+ * @brief Give access to the cells which squared sound speed was negative at the last solve.
+ *        Their sound speed is NaN and the solve has returned EXIT_FAILURE.
+ * 
+ * @param[in] solver : the solver
+ * @param[out] nb_invalid_cells : number of such cells
+ * @return const unsigned int* : indices of these cells in the mesh, in increasing order
+ */
+const unsigned int *get_vnr_solver_invalid_cells(const VnrSolver_s *solver, unsigned int *nb_invalid_cells);
+
+/**
+ * @brief Give the load imbalance of the last solve : the fraction of the time of the threads spent waiting
+ *        for the slowest one, i.e \f$1 - \frac{\sum_t busy_t}{nb\_threads \max_t busy_t}\f$
+ * 
+ * @param[in] solver : the solver
+ * @return double : the idle fraction, in [0, 1[
+ */
+double get_vnr_solver_idle_fraction(const VnrSolver_s *solver);
+
+/**
+ * @brief Pin each thread of the team of the solver to a processor : the thread tid (the one calling the solves
+ *        being the thread 0) to cpus[tid] or, if cpus is NULL, to the tid-th processor (modulo their number)
+ *        allowed to the thread that has built the solver. Pinning the threads before building the arrays
+ *        of the problem with build_vnr_solver_array keeps each thread next to its memory.
+ *        The OpenMP parallel regions (use_thread_team false) are pinned by OMP_PROC_BIND and OMP_PLACES instead.
+ * 
+ * @param[in] solver : the solver
+ * @param[in] cpus : processor of each thread (as many values as threads) or NULL
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : if the solver has no team or a thread could not be pinned
+ */
+int pin_vnr_solver_threads(VnrSolver_s *solver, const int *cpus);
+
+/**
+ * @brief Build an array of the problem zeroed by the threads of the solver, each of them writing first the cells
+ *        of its chunk in the static schedule, so that on a NUMA machine the memory pages of a large array are
+ *        mapped next to the thread solving its cells. Once used, the array should be deleted thanks to DELETE_ARRAY.
+ * 
+ * @param[in] solver : the solver
+ * @param[in] size : size of the array (the number of cells of the problems that will be solved, up to the capacity
+ *                   of the solver)
+ * @param[in] label : label of the array
+ * @return p_array : pointer on the newly created array in case of success, NULL otherwise
+ */
+p_array build_vnr_solver_array(VnrSolver_s *solver, const size_t size, const char *label);
+
+/**
+ * @brief Stop the worker threads of the solver and release all the memory it holds
+ * 
+ * @param[in] solver : solver to delete (may be NULL)
+ */
+void delete_vnr_solver(VnrSolver_s *solver);
 
 /**
  * @brief Use the Newton-Raphson algorithm to solve the equation governing the evolution of the 
@@ -35,8 +233,121 @@
  * @param[out] solution : solution of the equation i.e the internal energy at next time step \f$e_i^{n+1}\f$
  * @param[out] new_p : pressure at next time step \f$P^{n+1}\f$
  * @param[out] new_vson : sound speed at next time step \f$C_s^{n+1}\f$
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : if the arrays are invalid, the solver could not be built, the equation could not be
+ *                                solved on every cell or the squared sound speed of some cells is negative (their
+ *                                sound speed is NaN and they are printed on stderr). The cells of the threads that
+ *                                succeeded are solved anyway
+ */
+int launch_vnr_resolution(MieGruneisenParams_s const *eos_params, p_array old_density, p_array new_density, p_array pressure, p_array internal_energy,
+                          p_array solution, p_array new_p, p_array new_vson);
+
+/**
+ * @brief Same as launch_vnr_resolution but uses the scratch memory of the solver context
+ *        so that no heap allocation occurs.
+ * 
+ * @param[in] solver : solver context built for a size at least equal to the size of the arrays
+ * @param[in] eos_params : parameters of the equation of state
+ * @param[in] old_density : current density \f$\rho^n\f$
+ * @param[in] new_density : next time step density \f$\rho^{n+1}\f$
+ * @param[in] pressure : current pressure \f$P^n\f$
+ * @param[in] internal_energy : current internal energy \f$e_i^n\f$
+ * @param[out] solution : solution of the equation i.e the internal energy at next time step \f$e_i^{n+1}\f$
+ * @param[out] new_p : pressure at next time step \f$P^{n+1}\f$
+ * @param[out] new_vson : sound speed at next time step \f$C_s^{n+1}\f$
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : if the problem is too large for the solver, the equation could not be solved on every cell
+ *                                (see get_vnr_solver_report) or the squared sound speed of some cells is negative
+ *                                (see get_vnr_solver_invalid_cells). The cells of the threads that succeeded are solved anyway
+ */
+int launch_vnr_resolution_with_solver(VnrSolver_s *solver, MieGruneisenParams_s const *eos_params,
+                                      p_array old_density, p_array new_density, p_array pressure, p_array internal_energy,
+                                      p_array solution, p_array new_p, p_array new_vson);
+
+/**
+ * @brief Same as launch_vnr_resolution_with_solver for arrays larger than the capacity of the solver, e.g. arrays
+ *        mapped on files larger than the memory (see array_mapped.h). The cells are streamed through the solver
+ *        by blocks of its capacity rounded down to a whole number of memory pages, so that the memory used stays
+ *        bounded by a few blocks : while a block is solved, the pages of the inputs of the next one are read
+ *        ahead, and once solved, the pages of the block are the first ones given back to the OS if the memory
+ *        is short. Inside a block, the dynamic schedule solves the cells by blocks of schedule_block_size cells,
+ *        which default size keeps the values of a block in the cache of the thread.
+ *        The per cell options are indexed on the whole mesh. The VNR_EXTRAPOLATED_GUESS strategy falls back
+ *        to the current internal energy, the history of the solver holding a single block.
+ * 
+ * @param[in] solver : solver context (its capacity is the number of cells of a block, at least a memory page
+ *                     of values is advised)
+ * @param[in] eos_params : parameters of the equation of state
+ * @param[in] old_density : current density \f$\rho^n\f$
+ * @param[in] new_density : next time step density \f$\rho^{n+1}\f$
+ * @param[in] pressure : current pressure \f$P^n\f$
+ * @param[in] internal_energy : current internal energy \f$e_i^n\f$
+ * @param[out] solution : solution of the equation i.e the internal energy at next time step \f$e_i^{n+1}\f$
+ * @param[out] new_p : pressure at next time step \f$P^{n+1}\f$
+ * @param[out] new_vson : sound speed at next time step \f$C_s^{n+1}\f$
+ * @return int EXIT_SUCCESS (0) : in case of success (see get_vnr_solver_report for the report of every block)
+ *             EXIT_FAILURE (1) : if the solver or the arrays are invalid or the equation could not be solved on every
+ *                                cell of a block. The blocks following it are not solved. The block is printed on
+ *                                stderr and its invalid cells are given by get_vnr_solver_invalid_cells, indexed in
+ *                                the block
+ */
+int launch_vnr_resolution_streamed(VnrSolver_s *solver, MieGruneisenParams_s const *eos_params,
+                                   p_array old_density, p_array new_density, p_array pressure, p_array internal_energy,
+                                   p_array solution, p_array new_p, p_array new_vson);
+
+/**
+ * @brief Same as launch_vnr_resolution for a mesh of several materials, each of them having its own
+ *        equation of state (see eos_params.h). The cells are grouped by material internally and each thread
+ *        solves its chunk as batches of cells of the same material.
+ * 
+ * @param[in] materials : parameters of the equation of state of each material
+ * @param[in] nb_materials : number of materials (at most VNR_MAX_NB_MATERIALS)
+ * @param[in] material_ids : material of each cell (index in materials)
+ * @param[in] old_density : current density \f$\rho^n\f$
+ * @param[in] new_density : next time step density \f$\rho^{n+1}\f$
+ * @param[in] pressure : current pressure \f$P^n\f$
+ * @param[in] internal_energy : current internal energy \f$e_i^n\f$
+ * @param[out] solution : solution of the equation i.e the internal energy at next time step \f$e_i^{n+1}\f$
+ * @param[out] new_p : pressure at next time step \f$P^{n+1}\f$
+ * @param[out] new_vson : sound speed at next time step \f$C_s^{n+1}\f$
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : if the arrays are invalid, the solver could not be built, a material is invalid,
+ *                                the equation could not be solved on every cell or the squared sound speed of some
+ *                                cells is negative
+ */
+int launch_multimaterial_vnr_resolution(const EosParams_s *materials, const unsigned int nb_materials,
+                                        const unsigned int *material_ids, p_array old_density, p_array new_density,
+                                        p_array pressure, p_array internal_energy, p_array solution, p_array new_p,
+                                        p_array new_vson);
+
+/**
+ * @brief Same as launch_multimaterial_vnr_resolution but uses the scratch memory of the solver context.
+ *        If the cells are already grouped by material (non decreasing material_ids), they are solved in place.
+ *        Otherwise they are gathered by material into memory of the solver allocated at the first such call
+ *        and kept for the next ones, and the results are scattered back, both by the threads of the solver.
+ *        The per cell options (tolerances and initial guess) are indexed on the mesh, as for a single material.
+ * 
+ * @param[in] solver : solver context built for a size at least equal to the size of the arrays
+ * @param[in] materials : parameters of the equation of state of each material
+ * @param[in] nb_materials : number of materials (at most VNR_MAX_NB_MATERIALS)
+ * @param[in] material_ids : material of each cell (index in materials)
+ * @param[in] old_density : current density \f$\rho^n\f$
+ * @param[in] new_density : next time step density \f$\rho^{n+1}\f$
+ * @param[in] pressure : current pressure \f$P^n\f$
+ * @param[in] internal_energy : current internal energy \f$e_i^n\f$
+ * @param[out] solution : solution of the equation i.e the internal energy at next time step \f$e_i^{n+1}\f$
+ * @param[out] new_p : pressure at next time step \f$P^{n+1}\f$
+ * @param[out] new_vson : sound speed at next time step \f$C_s^{n+1}\f$
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : if the problem is too large for the solver, the materials are missing or one of them
+ *                                is invalid, the equation could not be solved on every cell (see
+ *                                get_vnr_solver_report) or the squared sound speed of some cells is negative
+ *                                (see get_vnr_solver_invalid_cells)
  */
-void launch_vnr_resolution(MieGruneisenParams_s const *eos_params, p_array old_density, p_array new_density, p_array pressure, p_array internal_energy,
-                           p_array solution, p_array new_p, p_array new_vson);
+int launch_multimaterial_vnr_resolution_with_solver(VnrSolver_s *solver, const EosParams_s *materials,
+                                                    const unsigned int nb_materials, const unsigned int *material_ids,
+                                                    p_array old_density, p_array new_density, p_array pressure,
+                                                    p_array internal_energy, p_array solution, p_array new_p,
+                                                    p_array new_vson);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,252 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "vnr_thread_team.h"
+
+/**
+ * @brief Arguments of a worker thread
+ *
+ */
+typedef struct VnrTeamWorker
+{
+    VnrThreadTeam_s *team;  /**< The team of the worker */
+    int tid;  /**< Index of the worker in the team */
+} VnrTeamWorker_s;
+
+struct VnrThreadTeam
+{
+    int nb_threads;  /**< Number of threads, including the one running the team */
+    int nb_started;  /**< Number of workers started */
+    int spin_count;  /**< Number of checks before sleeping (0 if the threads are more than the processors) */
+    pthread_t *threads;  /**< The nb_threads - 1 workers */
+    VnrTeamWorker_s *workers;  /**< Arguments of the workers */
+    pthread_mutex_t mutex;  /**< Protects the sleep of the threads */
+    pthread_cond_t task_posted;  /**< Signaled when a task is posted */
+    pthread_cond_t task_done;  /**< Signaled when the last worker has done its task */
+    atomic_uint generation;  /**< Number of tasks posted (modified under the mutex) */
+    atomic_int nb_running;  /**< Number of workers that have not done the current task yet */
+    bool stop;  /**< The workers should exit instead of running a task */
+    VnrTeamTask task;  /**< Current task */
+    void *context;  /**< Context of the current task */
+    cpu_set_t allowed_cpus;  /**< Processors allowed to the thread that has built the team */
+    int nb_allowed_cpus;  /**< Number of such processors */
+};
+
+/**
+ * @brief Context of the task pinning the members of a team
+ *
+ */
+typedef struct VnrTeamPinning
+{
+    const VnrThreadTeam_s *team;  /**< The team */
+    const int *cpus;  /**< Processor of each member (NULL to use the processors allowed) */
+    atomic_int nb_failures;  /**< Number of members that could not be pinned */
+} VnrTeamPinning_s;
+
+/**
+ * @brief Wait for a task newer than the last one seen
+ *
+ * @param[in] team : the team
+ * @param[in] last_seen : generation of the last task run by the worker
+ * @return unsigned int : generation of the new task
+ */
+static unsigned int wait_for_task(VnrThreadTeam_s *team, const unsigned int last_seen)
+{
+    for (int spin = 0; spin < team->spin_count; ++spin)
+    {
+        const unsigned int generation = atomic_load_explicit(&team->generation, memory_order_acquire);
+        if (generation != last_seen)
+            return generation;
+    }
+    pthread_mutex_lock(&team->mutex);
+    while (atomic_load_explicit(&team->generation, memory_order_acquire) == last_seen)
+        pthread_cond_wait(&team->task_posted, &team->mutex);
+    const unsigned int generation = atomic_load_explicit(&team->generation, memory_order_acquire);
+    pthread_mutex_unlock(&team->mutex);
+    return generation;
+}
+
+/**
+ * @brief Main loop of a worker : run each task posted until the team is stopped
+ *
+ * @param[in] arg : arguments of the worker (VnrTeamWorker_s)
+ * @return void* : NULL
+ */
+static void *run_worker(void *arg)
+{
+    const VnrTeamWorker_s *worker = (const VnrTeamWorker_s *)arg;
+    VnrThreadTeam_s *team = worker->team;
+    unsigned int generation = 0;
+    for (;;)
+    {
+        generation = wait_for_task(team, generation);
+        if (team->stop)
+            break;
+        team->task(team->context, worker->tid);
+        if (atomic_fetch_sub_explicit(&team->nb_running, 1, memory_order_acq_rel) == 1)
+        {
+            pthread_mutex_lock(&team->mutex);
+            pthread_cond_signal(&team->task_done);
+            pthread_mutex_unlock(&team->mutex);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Post a task (or the stop order) to the workers
+ *
+ * @param[in] team : the team
+ * @param[in] task : task to run (NULL to stop the workers)
+ * @param[in] context : context given to the task
+ */
+static void post_task(VnrThreadTeam_s *team, VnrTeamTask task, void *context)
+{
+    team->task = task;
+    team->context = context;
+    team->stop = task == NULL;
+    atomic_store_explicit(&team->nb_running, team->nb_started, memory_order_relaxed);
+    pthread_mutex_lock(&team->mutex);
+    atomic_fetch_add_explicit(&team->generation, 1, memory_order_release);
+    pthread_cond_broadcast(&team->task_posted);
+    pthread_mutex_unlock(&team->mutex);
+}
+
+VnrThreadTeam_s *build_vnr_thread_team(const int nb_threads)
+{
+    if (nb_threads < 1)
+    {
+        fprintf(stderr, "Unable to build a team of %d threads!\n", nb_threads);
+        return NULL;
+    }
+    VnrThreadTeam_s *team = (VnrThreadTeam_s *)calloc(1, sizeof(VnrThreadTeam_s));
+    if (team == NULL)
+    {
+        fprintf(stderr, "The allocation of the thread team has failed!\n");
+        return NULL;
+    }
+    team->nb_threads = nb_threads;
+    // A spinning thread would take the processor of a working one
+    team->spin_count = nb_threads <= sysconf(_SC_NPROCESSORS_ONLN) ? VNR_TEAM_SPIN_COUNT : 0;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &team->allowed_cpus) == 0)
+        team->nb_allowed_cpus = CPU_COUNT(&team->allowed_cpus);
+    atomic_init(&team->generation, 0);
+    atomic_init(&team->nb_running, 0);
+    pthread_mutex_init(&team->mutex, NULL);
+    pthread_cond_init(&team->task_posted, NULL);
+    pthread_cond_init(&team->task_done, NULL);
+    if (nb_threads == 1)
+        return team;
+
+    team->threads = (pthread_t *)calloc(nb_threads - 1, sizeof(pthread_t));
+    team->workers = (VnrTeamWorker_s *)calloc(nb_threads - 1, sizeof(VnrTeamWorker_s));
+    if (team->threads == NULL || team->workers == NULL)
+    {
+        fprintf(stderr, "The allocation of the workers of the thread team has failed!\n");
+        delete_vnr_thread_team(team);
+        return NULL;
+    }
+    for (int tid = 1; tid < nb_threads; ++tid)
+    {
+        VnrTeamWorker_s *worker = &team->workers[tid - 1];
+        worker->team = team;
+        worker->tid = tid;
+        if (pthread_create(&team->threads[tid - 1], NULL, run_worker, worker) != 0)
+        {
+            fprintf(stderr, "Unable to start the worker %d of the thread team!\n", tid);
+            delete_vnr_thread_team(team);
+            return NULL;
+        }
+        team->nb_started++;
+    }
+    return team;
+}
+
+void run_vnr_thread_team(VnrThreadTeam_s *team, VnrTeamTask task, void *context)
+{
+    if (team->nb_started > 0)
+        post_task(team, task, context);
+    task(context, 0);
+    if (team->nb_started == 0)
+        return;
+
+    for (int spin = 0; spin < team->spin_count; ++spin)
+    {
+        if (atomic_load_explicit(&team->nb_running, memory_order_acquire) == 0)
+            return;
+    }
+    pthread_mutex_lock(&team->mutex);
+    while (atomic_load_explicit(&team->nb_running, memory_order_acquire) > 0)
+        pthread_cond_wait(&team->task_done, &team->mutex);
+    pthread_mutex_unlock(&team->mutex);
+}
+
+/**
+ * @brief Pin the member to its processor
+ *
+ * @param[in] context : the VnrTeamPinning_s
+ * @param[in] tid : index of the member in the team
+ */
+static void pin_member(void *context, const int tid)
+{
+    VnrTeamPinning_s *pinning = (VnrTeamPinning_s *)context;
+    const VnrThreadTeam_s *team = pinning->team;
+    int cpu = -1;
+    if (pinning->cpus)
+    {
+        cpu = pinning->cpus[tid];
+    }
+    else if (team->nb_allowed_cpus > 0)
+    {
+        // The (tid modulo nb_allowed_cpus)-th processor allowed
+        int rank = tid % team->nb_allowed_cpus;
+        for (cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &team->allowed_cpus) && rank-- == 0)
+                break;
+        }
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (cpu >= 0 && cpu < CPU_SETSIZE)
+        CPU_SET(cpu, &cpu_set);
+    if (cpu < 0 || cpu >= CPU_SETSIZE || pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0)
+    {
+        fprintf(stderr, "Unable to pin the thread %d of the team to the processor %d!\n", tid, cpu);
+        atomic_fetch_add_explicit(&pinning->nb_failures, 1, memory_order_relaxed);
+    }
+}
+
+int pin_vnr_thread_team(VnrThreadTeam_s *team, const int *cpus)
+{
+    VnrTeamPinning_s pinning = {.team = team, .cpus = cpus};
+    atomic_init(&pinning.nb_failures, 0);
+    run_vnr_thread_team(team, pin_member, &pinning);
+    return atomic_load(&pinning.nb_failures) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void delete_vnr_thread_team(VnrThreadTeam_s *team)
+{
+    if (team)
+    {
+        if (team->nb_started > 0)
+        {
+            post_task(team, NULL, NULL);
+            for (int tid = 0; tid < team->nb_started; ++tid)
+            {
+                pthread_join(team->threads[tid], NULL);
+            }
+        }
+        pthread_mutex_destroy(&team->mutex);
+        pthread_cond_destroy(&team->task_posted);
+        pthread_cond_destroy(&team->task_done);
+        free(team->threads);
+        free(team->workers);
+        free(team);
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * @file vnr_thread_team.h
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief A team of worker threads that lives as long as the solver owning it, so that a solve
+ *        only dispatches its task to threads that are already running
+ * @version 0.1
+ * @date 2020-05-04
+ *
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ *
+ * Between two tasks the workers spin for a short while (VNR_TEAM_SPIN_COUNT checks), so that the
+ * solves of a time loop wake them up without a system call, then sleep on a condition variable.
+ * They do not spin if the team has more threads than the processors online.
+ */
+#ifndef VNR_THREAD_TEAM_H
+#define VNR_THREAD_TEAM_H
+
+/**
+ * @brief Number of times a waiting thread checks for the next task (or for the end of the current one)
+ *        before going to sleep
+ *
+ */
+#define VNR_TEAM_SPIN_COUNT 20000
+
+/**
+ * @brief A team of threads. The thread calling run_vnr_thread_team is the member 0 of the team.
+ *
+ */
+typedef struct VnrThreadTeam VnrThreadTeam_s;
+
+/**
+ * @brief Task run by each member of the team
+ *
+ * @param[in] context : context given to run_vnr_thread_team
+ * @param[in] tid : index of the member in the team, in [0, nb_threads[
+ */
+typedef void (*VnrTeamTask)(void *context, const int tid);
+
+/**
+ * @brief Build a team of nb_threads threads, that is to say start nb_threads - 1 workers.
+ *        Once used, the team should be deleted thanks to delete_vnr_thread_team.
+ *
+ * @param[in] nb_threads : number of threads of the team (at least 1)
+ * @return VnrThreadTeam_s* : pointer on the newly created team in case of success, NULL otherwise
+ */
+VnrThreadTeam_s *build_vnr_thread_team(const int nb_threads);
+
+/**
+ * @brief Run the task on every member of the team and wait for all of them to finish it.
+ *        The team should not be run by several threads at the same time.
+ *
+ * @param[in] team : the team
+ * @param[in] task : task to run
+ * @param[in] context : context given to the task
+ */
+void run_vnr_thread_team(VnrThreadTeam_s *team, VnrTeamTask task, void *context);
+
+/**
+ * @brief Pin each member of the team to a processor : the member tid (the thread running the team being the
+ *        member 0) to cpus[tid] or, if cpus is NULL, to the tid-th processor (modulo their number) allowed
+ *        to the thread that has built the team.
+ *        The team should not be run by another thread at the same time.
+ *
+ * @param[in] team : the team
+ * @param[in] cpus : processor of each member (nb_threads values) or NULL
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : if a member could not be pinned (it keeps its previous affinity)
+ */
+int pin_vnr_thread_team(VnrThreadTeam_s *team, const int *cpus);
+
+/**
+ * @brief Stop the workers of the team and release its memory
+ *
+ * @param[in] team : team to delete (may be NULL)
+ */
+void delete_vnr_thread_team(VnrThreadTeam_s *team);
+
+#endif
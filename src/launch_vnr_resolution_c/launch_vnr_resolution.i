@@ -5,6 +5,7 @@
 #define SWIG_FILE_WITH_INIT
 #include "array.h"
 #include "miegruneisen_params.h"
+#include "eos_params.h"
 #include "launch_vnr_resolution.h"
 %}
 
@@ -20,28 +21,78 @@ import_array();
                                       (int nv_size, double* new_soundspeed)}
 
 %include "miegruneisen_params.h"
+%include "eos_params.h"
+
+// The solver owns its worker threads : it is built once by build_vnr_solver, reused by every solve
+// and should be deleted explicitly by delete_vnr_solver
+%ignore launch_vnr_resolution_with_solver;
 %include "launch_vnr_resolution.h"
 %rename (launch_vnr_resolution) wrap_launch_vnr_resolution;
+%rename (launch_vnr_resolution_with_solver) wrap_launch_vnr_resolution_with_solver;
 
-%inline %{
-  void wrap_launch_vnr_resolution(MieGruneisenParams_s const * eos_params, int od_size, double* old_specific_volume, int nd_size, double* new_specific_volume,
-                                  int p_size, double* pressure, int ie_size, double* internal_energy,
-                                  int nie_size, double* new_internal_energy, int np_size, double* new_pressure,
-                                  int nv_size, double* new_soundspeed) {
+// The errors set by the wrappers are raised as python exceptions
+%exception wrap_launch_vnr_resolution {
+  $action
+  if (PyErr_Occurred()) SWIG_fail;
+}
+%exception wrap_launch_vnr_resolution_with_solver {
+  $action
+  if (PyErr_Occurred()) SWIG_fail;
+}
+
+%{
+  /* Solve with the solver if it is not NULL, with a one-shot resolution otherwise */
+  static void wrap_resolution(VnrSolver_s *solver, MieGruneisenParams_s const * eos_params, int od_size, double* old_specific_volume,
+                              int nd_size, double* new_specific_volume, int p_size, double* pressure, int ie_size,
+                              double* internal_energy, int nie_size, double* new_internal_energy, int np_size,
+                              double* new_pressure, int nv_size, double* new_soundspeed) {
     int pb_size = od_size;
     if ((pb_size != nd_size) || (pb_size != p_size) || (pb_size != ie_size) ||
         (pb_size != nie_size) || (pb_size != np_size) || (pb_size != nv_size)) {
       PyErr_Format(PyExc_ValueError, "Arrays of lengths (%d, %d, %d, %d, %d, %d, %d) given", pb_size, nd_size, p_size,
           ie_size, nie_size, np_size, nv_size);
+      return;
+    }
+    s_array arr_old_specific_volume = wrap_array(old_specific_volume, od_size, "OldSpecificVolume");
+    s_array arr_new_specific_volume = wrap_array(new_specific_volume, nd_size, "NewSpecificVolume");
+    s_array arr_pressure = wrap_array(pressure, p_size, "Pressure");
+    s_array arr_internal_energy = wrap_array(internal_energy, ie_size, "InternalEnergy");
+    s_array arr_new_internal_energy = wrap_array(new_internal_energy, nie_size, "NewInternalEnergy");
+    s_array arr_new_pressure = wrap_array(new_pressure, np_size, "NewPressure");
+    s_array arr_new_soundspeed = wrap_array(new_soundspeed, nv_size, "NewSoundSpeed");
+    const int status = solver == NULL ?
+        launch_vnr_resolution(eos_params, &arr_old_specific_volume, &arr_new_specific_volume, &arr_pressure,
+                              &arr_internal_energy, &arr_new_internal_energy, &arr_new_pressure, &arr_new_soundspeed) :
+        launch_vnr_resolution_with_solver(solver, eos_params, &arr_old_specific_volume, &arr_new_specific_volume,
+                                          &arr_pressure, &arr_internal_energy, &arr_new_internal_energy,
+                                          &arr_new_pressure, &arr_new_soundspeed);
+    if (status == EXIT_FAILURE) {
+      PyErr_SetString(PyExc_RuntimeError, "The evolution of the internal energy could not be solved on every cell");
+    }
+  }
+%}
+
+%inline %{
+  void wrap_launch_vnr_resolution(MieGruneisenParams_s const * eos_params, int od_size, double* old_specific_volume, int nd_size, double* new_specific_volume,
+                                  int p_size, double* pressure, int ie_size, double* internal_energy,
+                                  int nie_size, double* new_internal_energy, int np_size, double* new_pressure,
+                                  int nv_size, double* new_soundspeed) {
+    wrap_resolution(NULL, eos_params, od_size, old_specific_volume, nd_size, new_specific_volume, p_size, pressure,
+                    ie_size, internal_energy, nie_size, new_internal_energy, np_size, new_pressure, nv_size,
+                    new_soundspeed);
+  }
+
+  void wrap_launch_vnr_resolution_with_solver(VnrSolver_s *solver, MieGruneisenParams_s const * eos_params, int od_size,
+                                              double* old_specific_volume, int nd_size, double* new_specific_volume,
+                                              int p_size, double* pressure, int ie_size, double* internal_energy,
+                                              int nie_size, double* new_internal_energy, int np_size, double* new_pressure,
+                                              int nv_size, double* new_soundspeed) {
+    if (solver == NULL) {
+      PyErr_SetString(PyExc_ValueError, "No solver given");
+      return;
     }
-    s_array arr_old_specific_volume = {od_size, "OldSpecificVolume", old_specific_volume};
-    s_array arr_new_specific_volume = {nd_size, "NewSpecificVolume", new_specific_volume};
-    s_array arr_pressure = {p_size, "Pressure", pressure};
-    s_array arr_internal_energy = {ie_size, "InternalEnergy", internal_energy};
-    s_array arr_new_internal_energy = {nie_size, "NewInternalEnergy", new_internal_energy};
-    s_array arr_new_pressure = {np_size, "NewPressure", new_pressure};
-    s_array arr_new_soundspeed = {nv_size, "NewSoundSpeed", new_soundspeed};
-    launch_vnr_resolution(eos_params, &arr_old_specific_volume, &arr_new_specific_volume, &arr_pressure, &arr_internal_energy,
-                          &arr_new_internal_energy, &arr_new_pressure, &arr_new_soundspeed);
+    wrap_resolution(solver, eos_params, od_size, old_specific_volume, nd_size, new_specific_volume, p_size, pressure,
+                    ie_size, internal_energy, nie_size, new_internal_energy, np_size, new_pressure, nv_size,
+                    new_soundspeed);
   }
 %}
@@ -1,7 +1,9 @@
+#include <float.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "array.h"
 #ifndef NEWTON
@@ -9,84 +11,574 @@
 #define NEWTON
 #endif
 
-int solveNewton(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_ini, p_array x_sol)
+/**
+ * @brief Number of bytes of the arena holding the buffers of a workspace
+ *
+ * @param[in] capacity : maximum size of the problems
+ * @return size_t : the number of bytes, each buffer being rounded up to ARRAY_ALIGNMENT bytes
+ */
+static size_t get_newton_workspace_footprint(const size_t capacity)
 {
-    if (x_ini->size != x_sol->size) {
-        fprintf(stderr, "Size mismatch between array x_ini (%s with size %u) and x_sol (%s with size %u)\n",
-                x_ini->label, x_ini->size, x_sol->label, x_sol->size);
-        return EXIT_FAILURE;
+    const size_t nb_doubles_buffers = 10;
+    const size_t nb_unsigned_buffers = 3;
+    const size_t doubles_buffer = ((size_t)capacity * sizeof(double) + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT;
+    const size_t unsigned_buffer = ((size_t)capacity * sizeof(unsigned int) + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT;
+    const size_t bool_buffer = ((size_t)capacity * sizeof(bool) + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT;
+    return (nb_doubles_buffers * doubles_buffer + nb_unsigned_buffers * unsigned_buffer + bool_buffer) *
+           ARRAY_ALIGNMENT;
+}
+
+NewtonWorkspace_s *build_newton_workspace(const size_t capacity)
+{
+    if (capacity == 0 || capacity > NEWTON_MAX_CAPACITY)
+    {
+        fprintf(stderr, "Unable to build a Newton workspace with a capacity of %zu!\n", capacity);
+        return NULL;
     }
 
-    int iter = 0;
-    const int NB_ITER_MAX = 40;
-    const unsigned int pb_size = x_ini->size;
+    NewtonWorkspace_s *workspace = (NewtonWorkspace_s *)calloc(1, sizeof(NewtonWorkspace_s));
+    if (workspace == NULL)
+    {
+        fprintf(stderr, "The allocation of the Newton workspace has failed!\n");
+        return NULL;
+    }
 
-    // Array of the values of the function to vanish
-    BUILD_ARRAY(F_k, pb_size)
-    // Array of the values of the derivative of the function to vanish
-    BUILD_ARRAY(dF_k, pb_size)
-    // Array of the values of incrementation
-    BUILD_ARRAY(delta_x_k, pb_size)
+    workspace->capacity = capacity;
+    // Every buffer is taken from one arena : a single allocation, each buffer being aligned and zeroed
+    workspace->arena = build_array_arena(get_newton_workspace_footprint(capacity));
+    if (workspace->arena == NULL)
+    {
+        fprintf(stderr, "Error during allocation of the Newton workspace arrays (capacity requested : %zu)!\n", capacity);
+        delete_newton_workspace(workspace);
+        return NULL;
+    }
+    ArrayArena_s *arena = workspace->arena;
+    const size_t doubles_bytes = (size_t)capacity * sizeof(double);
+    const size_t unsigned_bytes = (size_t)capacity * sizeof(unsigned int);
+    workspace->F_k = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->dF_k = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->d2F_k = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->delta_x_k = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->has_converged = (bool *)allocate_in_array_arena(arena, (size_t)capacity * sizeof(bool));
+    workspace->active_indices = (unsigned int *)allocate_in_array_arena(arena, unsigned_bytes);
+    workspace->x_active = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->epsilon_active = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->precision_active = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->nb_iterations = (unsigned int *)allocate_in_array_arena(arena, unsigned_bytes);
+    workspace->bracket_negative = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->bracket_positive = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->bracket_width = (double *)allocate_in_array_arena(arena, doubles_bytes);
+    workspace->bracket_age = (unsigned int *)allocate_in_array_arena(arena, unsigned_bytes);
 
-    p_array built_arrays[] = {F_k, dF_k, delta_x_k};
-    const size_t nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    return workspace;
+}
 
-    // Array of convergence markers
-    bool *has_converged = (bool *)calloc(pb_size, sizeof(bool));
+void delete_newton_workspace(NewtonWorkspace_s *workspace)
+{
+    if (workspace)
+    {
+        delete_array_arena(workspace->arena);
+        free(workspace);
+    }
+}
 
-    // Check that every array building has been successfull
-    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE || has_converged == NULL)
+void reset_newton_report(NewtonReport_s *report)
+{
+    memset(report, 0, sizeof(NewtonReport_s));
+}
+
+void merge_newton_reports(NewtonReport_s *total, const NewtonReport_s *part)
+{
+    total->nb_cells += part->nb_cells;
+    if (part->nb_iterations > total->nb_iterations)
+        total->nb_iterations = part->nb_iterations;
+    total->nb_unconverged += part->nb_unconverged;
+    if (part->max_residual > total->max_residual)
+        total->max_residual = part->max_residual;
+    for (int bin = 0; bin < NEWTON_REPORT_HISTOGRAM_SIZE; ++bin)
     {
-        fprintf(stderr, "Error during allocation/creation of arrays!\n");
-        cleanup_memory(built_arrays, nb_arrays);
-        return EXIT_FAILURE;
+        total->iterations_histogram[bin] += part->iterations_histogram[bin];
     }
+}
 
-    // Initialization
-    enum e_solver_status {SUCCESS, FAILURE} solver_status = SUCCESS;
-    p_array x_k = x_sol;
-    if (copy_array(x_ini, x_k) == EXIT_FAILURE) {
-        fprintf(stderr, "Unable to initialize the Newton-Raphson solver!\n");
-        cleanup_memory(built_arrays, nb_arrays);
+void print_newton_report(const NewtonReport_s *report)
+{
+    printf("Number of cells : %u\n", report->nb_cells);
+    printf("Number of iterations : %d\n", report->nb_iterations);
+    printf("Number of unconverged cells : %u\n", report->nb_unconverged);
+    printf("Maximum residual : %g\n", report->max_residual);
+    printf("Number of converged cells per number of iterations :\n");
+    for (int bin = 0; bin < NEWTON_REPORT_HISTOGRAM_SIZE; ++bin)
+    {
+        if (report->iterations_histogram[bin] > 0)
+        {
+            printf("\t%s%2d : %u\n", bin == NEWTON_REPORT_HISTOGRAM_SIZE - 1 ? ">=" : "  ", bin,
+                   report->iterations_histogram[bin]);
+        }
+    }
+}
+
+int solveNewton(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_ini, p_array x_sol)
+{
+    NewtonWorkspace_s *workspace = build_newton_workspace(x_ini->size);
+    if (workspace == NULL)
+    {
+        fprintf(stderr, "Error during allocation/creation of arrays!\n");
         return EXIT_FAILURE;
     }
 
-    while (true)
+    int status = solveNewtonWithWorkspace(newton_parameters, func_parameters, x_ini, x_sol, workspace);
+
+    delete_newton_workspace(workspace);
+    return status;
+}
+
+/**
+ * @brief Evaluate the function to vanish and compute the increments, with the second derivative
+ *        in second order mode
+ *
+ * @param[in] newton_parameters : parameters of the Newton-Raphson algorithm
+ * @param[in] func_parameters : parameters of the function to solve
+ * @param[in] x_k : unknowns
+ * @param[out] F_k : values of the function
+ * @param[out] dF_k : values of the derivative of the function
+ * @param[out] d2F_k : values of the second derivative of the function (second order mode only)
+ * @param[out] delta_x_k : increments
+ */
+static void evaluate_and_increment(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_k,
+                                   p_array F_k, p_array dF_k, p_array d2F_k, p_array delta_x_k)
+{
+    if (newton_parameters->evaluate_the_function_and_second_derivative != NULL &&
+        newton_parameters->compute_second_order_increment_vector != NULL)
+    {
+        // Compute F, dF and d2F
+        newton_parameters->evaluate_the_function_and_second_derivative(func_parameters, x_k, F_k, dF_k, d2F_k);
+        // Compute delta_x
+        newton_parameters->compute_second_order_increment_vector(x_k, F_k, dF_k, d2F_k, delta_x_k);
+    }
+    else
     {
         // Compute F and dF
         newton_parameters->evaluate_the_function(func_parameters, x_k, F_k, dF_k);
         // Compute delta_x
         newton_parameters->compute_increment_vector(x_k, F_k, dF_k, delta_x_k);
+    }
+}
+
+/**
+ * @brief Newton-Raphson iterations over the whole array of unknowns
+ *
+ * @param[in] newton_parameters : parameters of the Newton-Raphson algorithm
+ * @param[in] func_parameters : parameters of the function to solve
+ * @param[in, out] x_k : unknowns (initial values in input, solution in output)
+ * @param[in, out] workspace : scratch memory (the number of iterations of each unknown is stored in it)
+ * @param[in] controls : maximum number of iterations and tolerances
+ * @return true : if every unknown has converged
+ * @return false : otherwise
+ */
+static bool iterate_on_whole_array(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_k,
+                                   NewtonWorkspace_s *workspace, const NewtonControls_s *controls)
+{
+    const unsigned int pb_size = x_k->size;
+
+    // Array of the values of the function to vanish
+    s_array F_k = wrap_array(workspace->F_k, pb_size, "F_k");
+    // Array of the values of the derivative of the function to vanish
+    s_array dF_k = wrap_array(workspace->dF_k, pb_size, "dF_k");
+    // Array of the values of the second derivative of the function to vanish
+    s_array d2F_k = wrap_array(workspace->d2F_k, pb_size, "d2F_k");
+    // Array of the values of incrementation
+    s_array delta_x_k = wrap_array(workspace->delta_x_k, pb_size, "delta_x_k");
+    // Array of convergence markers
+    bool *has_converged = workspace->has_converged;
+    memset(has_converged, 0, pb_size * sizeof(bool));
+    unsigned int *nb_iterations = workspace->nb_iterations;
+
+    for (int iter = 0; iter <= controls->nb_iter_max; ++iter)
+    {
+        evaluate_and_increment(newton_parameters, func_parameters, x_k, &F_k, &dF_k, &d2F_k, &delta_x_k);
         // Apply increments
         for (unsigned int i = 0; i < pb_size; ++i)
         {
             if (!has_converged[i])
             {
-                x_k->data[i] += delta_x_k->data[i];
+                x_k->data[i] += delta_x_k.data[i];
+                nb_iterations[i] = iter + 1;
+            }
+        }
+        // Check the convergence
+        const bool all_converged = newton_parameters->check_convergence(&delta_x_k, &F_k, &controls->tolerances,
+                                                                        has_converged);
+        // Report the unknowns that have just converged (or will never do)
+        const bool last_iteration = iter == controls->nb_iter_max;
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            if (nb_iterations[i] == (unsigned int)iter + 1 && (has_converged[i] || last_iteration))
+            {
+                record_cell_in_newton_report(&workspace->report, iter + 1, has_converged[i], F_k.data[i]);
+            }
+        }
+        if (all_converged)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Bracket the root of each unknown. Points are probed in the direction of the Newton step
+ *        (or against the sign of the function if this step is null or infinite), the distance to the
+ *        initial value being doubled at each probe, until the function changes its sign.
+ *        The probes where the function keeps its initial sign tighten the bracket.
+ *
+ * @param[in] newton_parameters : parameters of the Newton-Raphson algorithm
+ * @param[in] func_parameters : parameters of the function to solve
+ * @param[in] x_k : initial values of the unknowns
+ * @param[in, out] workspace : scratch memory. In output, bracket_negative and bracket_positive hold
+ *                             the bounds where the function is negative and positive (NAN if not found)
+ * @return unsigned int : the number of unknowns which root could not be bracketed
+ */
+static unsigned int find_brackets(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_k,
+                                  NewtonWorkspace_s *workspace)
+{
+    const unsigned int pb_size = x_k->size;
+
+    s_array F_k = wrap_array(workspace->F_k, pb_size, "F_k");
+    s_array dF_k = wrap_array(workspace->dF_k, pb_size, "dF_k");
+    // Direction and length of the first probe
+    double *step = workspace->delta_x_k;
+    s_array probe = wrap_array(workspace->x_active, pb_size, "probe");
+    double *negative = workspace->bracket_negative;
+    double *positive = workspace->bracket_positive;
+
+    newton_parameters->evaluate_the_function(func_parameters, x_k, &F_k, &dF_k);
+    unsigned int nb_unbracketed = 0;
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        const double x = x_k->data[i];
+        const double F = F_k.data[i];
+        negative[i] = F <= 0. ? x : NAN;
+        positive[i] = F >= 0. ? x : NAN;
+        step[i] = -F / dF_k.data[i];
+        if (!isfinite(step[i]) || step[i] == 0.)
+            step[i] = -copysign(NEWTON_BRACKET_FIRST_PROBE * fmax(fabs(x), 1.), F);
+        if (isnan(negative[i]) || isnan(positive[i]))
+            nb_unbracketed++;
+    }
+
+    for (int nb_probes = 1; nb_probes <= NEWTON_BRACKET_NB_PROBES_MAX && nb_unbracketed > 0; ++nb_probes)
+    {
+        const double distance = ldexp(1., nb_probes);
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            const bool bracketed = !isnan(negative[i]) && !isnan(positive[i]);
+            probe.data[i] = bracketed ? x_k->data[i] : x_k->data[i] + distance * step[i];
+        }
+        newton_parameters->evaluate_the_function(func_parameters, &probe, &F_k, &dF_k);
+        nb_unbracketed = 0;
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            if (!isnan(negative[i]) && !isnan(positive[i]))
+                continue;
+            if (F_k.data[i] <= 0.)
+                negative[i] = probe.data[i];
+            if (F_k.data[i] >= 0.)
+                positive[i] = probe.data[i];
+            if (isnan(negative[i]) || isnan(positive[i]))
+                nb_unbracketed++;
+        }
+    }
+    return nb_unbracketed;
+}
+
+/**
+ * @brief Safeguarded Newton-Raphson iterations over the whole array of unknowns (see NewtonParameters_s)
+ *
+ * @param[in] newton_parameters : parameters of the Newton-Raphson algorithm
+ * @param[in] func_parameters : parameters of the function to solve
+ * @param[in, out] x_k : unknowns (initial values in input, solution in output)
+ * @param[in, out] workspace : scratch memory (the number of iterations of each unknown is stored in it)
+ * @param[in] controls : maximum number of iterations and tolerances
+ * @param[out] nb_iter_used : maximum number of iterations actually allowed, raised to the number of bisections
+ *                            needed to shrink the brackets under the tolerance
+ * @return true : if every unknown has converged
+ * @return false : otherwise
+ */
+static bool iterate_safeguarded(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_k,
+                                NewtonWorkspace_s *workspace, const NewtonControls_s *controls, int *nb_iter_used)
+{
+    const unsigned int pb_size = x_k->size;
+    const ConvergenceTolerances_s *tolerances = &controls->tolerances;
+
+    const unsigned int nb_unbracketed = find_brackets(newton_parameters, func_parameters, x_k, workspace);
+    if (nb_unbracketed > 0)
+    {
+        fprintf(stderr, "The root of %u unknown(s) could not be bracketed, their convergence is not guaranteed!\n",
+                nb_unbracketed);
+    }
+
+    s_array F_k = wrap_array(workspace->F_k, pb_size, "F_k");
+    s_array dF_k = wrap_array(workspace->dF_k, pb_size, "dF_k");
+    s_array d2F_k = wrap_array(workspace->d2F_k, pb_size, "d2F_k");
+    s_array delta_x_k = wrap_array(workspace->delta_x_k, pb_size, "delta_x_k");
+    double *negative = workspace->bracket_negative;
+    double *positive = workspace->bracket_positive;
+    double *halved_width = workspace->bracket_width;
+    unsigned int *age = workspace->bracket_age;
+    // Next iterates (the probes are not needed anymore)
+    double *candidate = workspace->x_active;
+    bool *has_converged = workspace->has_converged;
+    memset(has_converged, 0, pb_size * sizeof(bool));
+    unsigned int *nb_iterations = workspace->nb_iterations;
+
+    // As the bracket is at least halved every NEWTON_BRACKET_HALVING_WINDOW + 1 iterations, the number
+    // of iterations needed to shrink it under the absolute tolerance is known
+    int nb_iter_max = controls->nb_iter_max;
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        const double width = fabs(positive[i] - negative[i]);
+        halved_width[i] = width;
+        age[i] = 0;
+        const double precision = tolerances->precision_per_cell ? tolerances->precision_per_cell[i] : tolerances->precision;
+        const double resolution = fmax(precision, DBL_TRUE_MIN);
+        if (width > resolution)
+        {
+            const int nb_iter_needed = (NEWTON_BRACKET_HALVING_WINDOW + 1) * (int)ceil(log2(width / resolution)) + 2;
+            if (nb_iter_needed > nb_iter_max)
+                nb_iter_max = nb_iter_needed;
+        }
+    }
+    *nb_iter_used = nb_iter_max;
+
+    for (int iter = 0; iter <= nb_iter_max; ++iter)
+    {
+        evaluate_and_increment(newton_parameters, func_parameters, x_k, &F_k, &dF_k, &d2F_k, &delta_x_k);
+        // Shrink the brackets with the current iterates
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            if (has_converged[i])
+                continue;
+            nb_iterations[i] = iter + 1;
+            const double x = x_k->data[i];
+            if (x < fmin(negative[i], positive[i]) || x > fmax(negative[i], positive[i]))
+                continue;
+            if (F_k.data[i] <= 0.)
+                negative[i] = x;
+            if (F_k.data[i] >= 0.)
+                positive[i] = x;
+        }
+        // Safeguard the increments of the unknowns that have not converged yet. The bisection steps are
+        // hidden from the convergence criterion which would otherwise accept any large enough step
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            if (has_converged[i])
+                continue;
+            const double x = x_k->data[i];
+            candidate[i] = x + delta_x_k.data[i];
+            if (isnan(negative[i]) || isnan(positive[i]))
+                continue;
+            const double lower = fmin(negative[i], positive[i]);
+            const double upper = fmax(negative[i], positive[i]);
+            const double width = upper - lower;
+            if (width <= 0.5 * halved_width[i])
+            {
+                halved_width[i] = width;
+                age[i] = 0;
+            }
+            else
+            {
+                age[i]++;
+            }
+            if (!(candidate[i] > lower && candidate[i] < upper) || age[i] >= NEWTON_BRACKET_HALVING_WINDOW)
+            {
+                candidate[i] = lower + 0.5 * width;
+                delta_x_k.data[i] = 0.;
+            }
+            const double epsilon = tolerances->epsilon_per_cell ? tolerances->epsilon_per_cell[i] : tolerances->epsilon;
+            const double precision = tolerances->precision_per_cell ? tolerances->precision_per_cell[i] : tolerances->precision;
+            // The bracket is narrow enough or can not be split anymore
+            if (width <= epsilon * fabs(x) + precision || candidate[i] == lower || candidate[i] == upper)
+            {
+                has_converged[i] = true;
+                delta_x_k.data[i] = candidate[i] - x;
             }
         }
         // Check the convergence
-        if (newton_parameters->check_convergence(delta_x_k, F_k, has_converged))
+        newton_parameters->check_convergence(&delta_x_k, &F_k, tolerances, has_converged);
+        // Apply the increments (the converged unknowns keep the step checked by the criterion)
+        const bool last_iteration = iter == nb_iter_max;
+        bool all_converged = true;
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            if (nb_iterations[i] != (unsigned int)iter + 1)
+                continue;
+            if (has_converged[i])
+                x_k->data[i] += delta_x_k.data[i];
+            else
+                x_k->data[i] = candidate[i];
+            all_converged = all_converged && has_converged[i];
+            if (has_converged[i] || last_iteration)
+            {
+                record_cell_in_newton_report(&workspace->report, iter + 1, has_converged[i], F_k.data[i]);
+            }
+        }
+        if (all_converged)
         {
-            solver_status = SUCCESS;
-            break;
+            return true;
         }
+    }
+    return false;
+}
+
+/**
+ * @brief Newton-Raphson iterations only over the unknowns that have not converged yet.
+ *        Their indices are kept in a compacted list and the function, the increments
+ *        and the convergence are computed on dense arrays gathered on those indices.
+ *
+ * @param[in] newton_parameters : parameters of the Newton-Raphson algorithm
+ * @param[in] func_parameters : parameters of the function to solve
+ * @param[in, out] x_k : unknowns (initial values in input, solution in output)
+ * @param[in, out] workspace : scratch memory (the number of iterations of each unknown is stored in it)
+ * @param[in] controls : maximum number of iterations and tolerances
+ * @return true : if every unknown has converged
+ * @return false : otherwise
+ */
+static bool iterate_on_active_set(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_k,
+                                  NewtonWorkspace_s *workspace, const NewtonControls_s *controls)
+{
+    unsigned int *active = workspace->active_indices;
+    unsigned int nb_active = x_k->size;
+    for (unsigned int i = 0; i < nb_active; ++i)
+    {
+        active[i] = i;
+    }
+    unsigned int *nb_iterations = workspace->nb_iterations;
+    NewtonReport_s *report = &workspace->report;
+
+    // The per cell tolerances are gathered on the active indices as the other arrays
+    const ConvergenceTolerances_s *tolerances = &controls->tolerances;
+    ConvergenceTolerances_s active_tolerances = *tolerances;
+    if (tolerances->epsilon_per_cell)
+        active_tolerances.epsilon_per_cell = workspace->epsilon_active;
+    if (tolerances->precision_per_cell)
+        active_tolerances.precision_per_cell = workspace->precision_active;
 
-        if (iter == NB_ITER_MAX) {
-            solver_status = FAILURE;
-            break;
+    for (int iter = 0; iter <= controls->nb_iter_max; ++iter)
+    {
+        // Dense views on the active part of the workspace
+        s_array x_a = wrap_array(workspace->x_active, nb_active, "x_active");
+        s_array F_k = wrap_array(workspace->F_k, nb_active, "F_k");
+        s_array dF_k = wrap_array(workspace->dF_k, nb_active, "dF_k");
+        s_array delta_x_k = wrap_array(workspace->delta_x_k, nb_active, "delta_x_k");
+        bool *has_converged = workspace->has_converged;
+
+        // Compute F and dF
+        newton_parameters->evaluate_the_function_on_subset(func_parameters, active, nb_active, x_k, &F_k, &dF_k);
+        for (unsigned int j = 0; j < nb_active; ++j)
+        {
+            x_a.data[j] = x_k->data[active[j]];
+        }
+        if (tolerances->epsilon_per_cell)
+        {
+            for (unsigned int j = 0; j < nb_active; ++j)
+                workspace->epsilon_active[j] = tolerances->epsilon_per_cell[active[j]];
         }
+        if (tolerances->precision_per_cell)
+        {
+            for (unsigned int j = 0; j < nb_active; ++j)
+                workspace->precision_active[j] = tolerances->precision_per_cell[active[j]];
+        }
+        // Compute delta_x
+        newton_parameters->compute_increment_vector(&x_a, &F_k, &dF_k, &delta_x_k);
+        // Apply increments (every active unknown has not converged yet)
+        for (unsigned int j = 0; j < nb_active; ++j)
+        {
+            x_k->data[active[j]] += delta_x_k.data[j];
+        }
+        // Check the convergence
+        memset(has_converged, 0, nb_active * sizeof(bool));
+        newton_parameters->check_convergence(&delta_x_k, &F_k, &active_tolerances, has_converged);
+        // Remove the converged unknowns from the active set
+        const bool last_iteration = iter == controls->nb_iter_max;
+        unsigned int nb_still_active = 0;
+        for (unsigned int j = 0; j < nb_active; ++j)
+        {
+            if (!has_converged[j])
+            {
+                active[nb_still_active++] = active[j];
+            }
+            if (has_converged[j] || last_iteration)
+            {
+                nb_iterations[active[j]] = iter + 1;
+                record_cell_in_newton_report(report, iter + 1, has_converged[j], F_k.data[j]);
+            }
+        }
+        nb_active = nb_still_active;
+        if (nb_active == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int solveNewtonWithWorkspace(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_ini, p_array x_sol,
+                             NewtonWorkspace_s *workspace)
+{
+    if (x_ini->size != x_sol->size) {
+        fprintf(stderr, "Size mismatch between array x_ini (%s with size %zu) and x_sol (%s with size %zu)\n",
+                get_array_label(x_ini), x_ini->size, get_array_label(x_sol), x_sol->size);
+        return EXIT_FAILURE;
+    }
+    if (x_ini->size > workspace->capacity) {
+        fprintf(stderr, "The size of the problem (%zu) is above the capacity of the workspace (%u)!\n",
+                x_ini->size, workspace->capacity);
+        return EXIT_FAILURE;
+    }
 
-        ++iter;
+    static const NewtonControls_s default_controls = NEWTON_DEFAULT_CONTROLS;
+    const NewtonControls_s *controls = newton_parameters->controls ? newton_parameters->controls : &default_controls;
+    if (controls->nb_iter_max < 0) {
+        fprintf(stderr, "The maximum number of iterations (%d) should be positive!\n", controls->nb_iter_max);
+        return EXIT_FAILURE;
     }
 
-    // Clear the memory
-    cleanup_memory(built_arrays, nb_arrays);
-    free(has_converged);
+    // Initialization
+    p_array x_k = x_sol;
+    if (copy_array(x_ini, x_k) == EXIT_FAILURE) {
+        fprintf(stderr, "Unable to initialize the Newton-Raphson solver!\n");
+        return EXIT_FAILURE;
+    }
+
+    reset_newton_report(&workspace->report);
+    // Raised by the safeguarded mode
+    int nb_iter_max = controls->nb_iter_max;
+    bool all_converged;
+    if (newton_parameters->evaluate_the_function_on_subset != NULL)
+    {
+        if (newton_parameters->evaluate_the_function_and_second_derivative != NULL) {
+            fprintf(stderr, "The second order mode is not available with the active set mode!\n");
+            return EXIT_FAILURE;
+        }
+        if (controls->safeguarded) {
+            fprintf(stderr, "The safeguarded mode is not available with the active set mode!\n");
+            return EXIT_FAILURE;
+        }
+        all_converged = iterate_on_active_set(newton_parameters, func_parameters, x_k, workspace, controls);
+    }
+    else if (controls->safeguarded)
+    {
+        all_converged = iterate_safeguarded(newton_parameters, func_parameters, x_k, workspace, controls, &nb_iter_max);
+    }
+    else
+    {
+        all_converged = iterate_on_whole_array(newton_parameters, func_parameters, x_k, workspace, controls);
+    }
 
-    if (solver_status == FAILURE)
+    if (!all_converged)
     {
-        fprintf(stderr, "Maximum iterations number reached (%d)!\n", NB_ITER_MAX);
+        fprintf(stderr, "Maximum iterations number reached (%d)!\n", nb_iter_max);
         fprintf(stderr, "Newton-Raphson algorithm has not converged!\n");
         return EXIT_FAILURE;
     }
@@ -11,14 +11,136 @@
 #ifndef NEWTON_H
 #define NEWTON_H
 
+#include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include "array.h"
+#include "array_arena.h"
 #include "incrementations_methods.h"
 #include "stop_criterions.h"
 
+/**
+ * @brief Maximum number of iterations of the Newton-Raphson algorithm
+ * 
+ */
+#define NEWTON_NB_ITER_MAX 40
+
+/**
+ * @brief Maximum number of probes used to bracket the root of each unknown in safeguarded mode.
+ *        The distance of the probes to the initial value is doubled at each probe.
+ * 
+ */
+#define NEWTON_BRACKET_NB_PROBES_MAX 64
+
+/**
+ * @brief Distance, relatively to max(|x|, 1), of the first probe when the Newton step can not be used
+ *        to bracket the root (null or infinite derivative)
+ * 
+ */
+#define NEWTON_BRACKET_FIRST_PROBE 1.e-6
+
+/**
+ * @brief Number of iterations the Newton steps may take without halving the bracket
+ *        before a bisection is forced in safeguarded mode
+ * 
+ */
+#define NEWTON_BRACKET_HALVING_WINDOW 3
+
+/**
+ * @brief Number of bins of the histogram of iterations of the Newton report.
+ *        The last bin gathers the cells that needed at least NEWTON_REPORT_HISTOGRAM_SIZE - 1 iterations.
+ * 
+ */
+#define NEWTON_REPORT_HISTOGRAM_SIZE (NEWTON_NB_ITER_MAX + 2)
+
+/**
+ * @brief Maximum size of the problems solved by the Newton kernels, which index the unknowns
+ *        on 32 bits (the arrays may be larger : their chunks are solved one after the other)
+ * 
+ */
+#define NEWTON_MAX_CAPACITY 1000000000
+
+/**
+ * @brief The controls of the Newton solver
+ * 
+ */
+typedef struct NewtonControls
+{
+    int nb_iter_max;  /**< Maximum number of iterations */
+    ConvergenceTolerances_s tolerances;  /**< Tolerances given to the convergence criterion */
+    bool safeguarded;  /**< Keep a bracket of the root of each unknown and bisect it when the Newton step
+                            leaves it or does not shrink it enough (see NewtonParameters_s) */
+} NewtonControls_s;
+
+/**
+ * @brief Initializer of the default controls of the Newton solver
+ * 
+ */
+#define NEWTON_DEFAULT_CONTROLS {.nb_iter_max = NEWTON_NB_ITER_MAX, .tolerances = RELATIVE_GAP_DEFAULT_TOLERANCES, \
+                                 .safeguarded = false}
+
+/**
+ * @brief Report of a solve
+ * 
+ */
+typedef struct NewtonReport
+{
+    unsigned int nb_cells;  /**< Number of cells solved */
+    int nb_iterations;  /**< Number of iterations of the cell that needed the most of them */
+    unsigned int nb_unconverged;  /**< Number of cells that have not converged */
+    double max_residual;  /**< Maximum over the cells of |f| at the last check of their convergence */
+    unsigned int iterations_histogram[NEWTON_REPORT_HISTOGRAM_SIZE];  /**< Number of converged cells per number of iterations needed */
+} NewtonReport_s;
+
+/**
+ * @brief The prototype of the functions that evaluate the function to vanish, and its derivative,
+ *        only on a subset of the unknowns
+ *
+ * @param[in] parameters : parameters of the function
+ * @param[in] indices : indices of the unknowns where the function has to be evaluated
+ * @param[in] nb_indices : number of indices
+ * @param[in] x : whole array of unknowns
+ * @param[out] func : values of the function (func->data[j] corresponds to x->data[indices[j]])
+ * @param[out] dfunc : values of the derivative of the function (same ordering as func)
+ */
+typedef void (*subset_evaluation_fct_ptr)(void *parameters, const unsigned int *indices, const unsigned int nb_indices,
+                                          const p_array x, p_array func, p_array dfunc);
+
+/**
+ * @brief The prototype of the functions that evaluate the function to vanish, its derivative
+ *        and its second derivative
+ *
+ * @param[in] parameters : parameters of the function
+ * @param[in] x : array of unknowns
+ * @param[out] func : values of the function
+ * @param[out] dfunc : values of the derivative of the function
+ * @param[out] d2func : values of the second derivative of the function
+ */
+typedef void (*second_order_evaluation_fct_ptr)(void *parameters, const p_array x, p_array func, p_array dfunc,
+                                                p_array d2func);
+
 /**
  * @brief This structure holds the parameters of the Newton solver
+ *
+ * In second order mode (evaluate_the_function_and_second_derivative and compute_second_order_increment_vector
+ * are not NULL), the function and its first two derivatives are evaluated at each iteration and given
+ * to a higher order incrementation method (for example halley_incrementation).
+ * This mode is not available with the active set mode.
+ *
+ * In active set mode (evaluate_the_function_on_subset is not NULL), the indices of the unknowns
+ * that have not converged yet are kept in a compacted list. At each iteration the function,
+ * the increments and the convergence are only computed on those unknowns.
+ *
+ * In safeguarded mode (controls->safeguarded is true), the root of each unknown is first bracketed by probing
+ * points in the direction of the first Newton step, farther and farther, until the function changes its sign.
+ * Then each iteration shrinks the bracket with the last iterate and the Newton step is replaced by
+ * the bisection of the bracket when it leaves the bracket or when the last NEWTON_BRACKET_HALVING_WINDOW
+ * iterations have not halved it. The bracket is thus at least halved every NEWTON_BRACKET_HALVING_WINDOW + 1
+ * iterations and an unknown converges once either the convergence criterion is met or its bracket
+ * is narrower than epsilon * |x| + precision. The maximum number of iterations is raised, if needed, to
+ * (NEWTON_BRACKET_HALVING_WINDOW + 1) * ceil(log2(width / precision)) + 2 where width is the widest initial bracket,
+ * so that the solve only fails if the root of an unknown could not be bracketed.
+ * This mode is not available with the active set mode.
  * 
  */
 typedef struct NewtonParameters
@@ -26,8 +148,103 @@ typedef struct NewtonParameters
     void (*evaluate_the_function)(void *, const p_array, p_array, p_array); /**< Function to vanish */
     incrementation_fct_ptr compute_increment_vector;  /**< Function that compute the Newton increment */
     criterion_fct_ptr check_convergence;  /**< Function that determines the convergence */
+    subset_evaluation_fct_ptr evaluate_the_function_on_subset;  /**< Function to vanish evaluated only on the given indices (optional).
+                                                                     If set, the solver runs in active set mode */
+    const NewtonControls_s *controls;  /**< Maximum number of iterations and tolerances (NULL for the default ones) */
+    second_order_evaluation_fct_ptr evaluate_the_function_and_second_derivative;  /**< Function to vanish with its second derivative (optional) */
+    second_order_incrementation_fct_ptr compute_second_order_increment_vector;  /**< Incrementation using the second derivative (optional) */
 } NewtonParameters_s;
 
+/**
+ * @brief This structure holds the scratch memory used by the Newton solver.
+ *        Building it once and reusing it for every solve avoids any heap allocation
+ *        inside the solver.
+ * 
+ */
+typedef struct NewtonWorkspace
+{
+    unsigned int capacity;  /**< Maximum size of the problems that may be solved with this workspace */
+    ArrayArena_s *arena;  /**< Region holding every buffer below */
+    double *F_k;  /**< Values of the function to vanish */
+    double *dF_k;  /**< Values of the derivative of the function to vanish */
+    double *d2F_k;  /**< Values of the second derivative of the function to vanish (second order mode) */
+    double *delta_x_k;  /**< Values of incrementation */
+    bool *has_converged;  /**< Convergence markers */
+    unsigned int *active_indices;  /**< Indices of the unknowns that have not converged yet (active set mode) */
+    double *x_active;  /**< Unknowns gathered on the active indices (active set mode) */
+    double *epsilon_active;  /**< Per cell relative tolerances gathered on the active indices (active set mode) */
+    double *precision_active;  /**< Per cell absolute tolerances gathered on the active indices (active set mode) */
+    unsigned int *nb_iterations;  /**< Number of iterations of each unknown */
+    double *bracket_negative;  /**< Bound of the bracket where the function is negative (safeguarded mode) */
+    double *bracket_positive;  /**< Bound of the bracket where the function is positive (safeguarded mode) */
+    double *bracket_width;  /**< Width of the bracket when it was last halved (safeguarded mode) */
+    unsigned int *bracket_age;  /**< Number of iterations since the bracket was last halved (safeguarded mode) */
+    NewtonReport_s report;  /**< Report of the last solve */
+} NewtonWorkspace_s;
+
+/**
+ * @brief Build a workspace able to hold the scratch memory of problems which size is up to capacity.
+ *        Once used, the workspace should be deleted thanks to delete_newton_workspace.
+ * 
+ * @param[in] capacity : maximum size of the problems (at most NEWTON_MAX_CAPACITY)
+ * @return NewtonWorkspace_s* : pointer on the newly created workspace in case of success, NULL otherwise
+ */
+NewtonWorkspace_s *build_newton_workspace(const size_t capacity);
+
+/**
+ * @brief Release the memory held by the workspace
+ * 
+ * @param[in] workspace : workspace to delete (may be NULL)
+ */
+void delete_newton_workspace(NewtonWorkspace_s *workspace);
+
+/**
+ * @brief Reset the report before a new solve
+ * 
+ * @param[out] report : report to reset
+ */
+void reset_newton_report(NewtonReport_s *report);
+
+/**
+ * @brief Record the outcome of the solve of one cell into the report
+ * 
+ * @param[in,out] report : the report
+ * @param[in] nb_iterations : number of iterations of the cell
+ * @param[in] converged : true if the cell has converged
+ * @param[in] residual : value of the function at the last check of its convergence
+ */
+static inline void record_cell_in_newton_report(NewtonReport_s *report, const int nb_iterations, const bool converged,
+                                                const double residual)
+{
+    report->nb_cells++;
+    if (nb_iterations > report->nb_iterations)
+        report->nb_iterations = nb_iterations;
+    if (fabs(residual) > report->max_residual)
+        report->max_residual = fabs(residual);
+    if (!converged)
+    {
+        report->nb_unconverged++;
+        return;
+    }
+    const int bin = nb_iterations < NEWTON_REPORT_HISTOGRAM_SIZE - 1 ? nb_iterations : NEWTON_REPORT_HISTOGRAM_SIZE - 1;
+    report->iterations_histogram[bin]++;
+}
+
+/**
+ * @brief Add the report of a part of the cells to the report of the whole
+ * 
+ * @param[in,out] total : report of the whole
+ * @param[in] part : report of the part
+ */
+void merge_newton_reports(NewtonReport_s *total, const NewtonReport_s *part);
+
+/**
+ * @brief Print the report on the standard output
+ * 
+ * @param[in] report : the report
+ */
+void print_newton_report(const NewtonReport_s *report);
+
 /**
  * @brief Launch the Newton-Raphson algorithm
  * 
@@ -42,4 +259,22 @@ typedef struct NewtonParameters
  */
 int solveNewton(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_ini, p_array x_sol);
 
+/**
+ * @brief Launch the Newton-Raphson algorithm using the scratch memory of the workspace.
+ *        No memory is allocated during the run.
+ * 
+ * @param[in] newton_parameters : parameters of the Newton-Raphson algorithm
+ * @param[in] func_parameters : parameters of the function to solve
+ * @param[in] x_ini : initial values of the unknown
+ * @param[out] x_sol : solution
+ * @param[in,out] workspace : scratch memory which capacity should be at least the size of x_ini.
+ *                           Its report member holds the report of the solve.
+ * @warning : the solution is modified in any cases, even in case of FAILURE!
+ * 
+ * @return EXIT_SUCCESS (0) in case of success
+ *         EXIT_FAILURE (1) otherwise
+ */
+int solveNewtonWithWorkspace(NewtonParameters_s *newton_parameters, void *func_parameters, p_array x_ini, p_array x_sol,
+                             NewtonWorkspace_s *workspace);
+
 #endif
\ No newline at end of file
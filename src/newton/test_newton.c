@@ -0,0 +1,513 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "array.h"
+#include "cubic.h"
+#include "incrementations_methods.h"
+#include "newton.h"
+#include "stop_criterions.h"
+#include "test_utils.h"
+
+#define PB_SIZE 3
+
+typedef struct unittest {
+    const char* name;
+    int (*fun_ptr)();
+} s_unittest;
+
+/**
+ * @brief Fill the array with initial values leading to the three roots of the cubic function
+ *        when using the damped incrementation
+ *
+ * @param[out] x : array of initial values
+ */
+static void set_initial_values(p_array x)
+{
+    x->data[0] = -1;
+    x->data[1] = 0.25;
+    x->data[2] = 2.;
+}
+
+/**
+ * @brief Test that solving twice with the same workspace gives the same results as solveNewton
+ *
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_solve_with_workspace()
+{
+    NewtonParameters_s newton = {.evaluate_the_function = cubic_function,
+                                 .compute_increment_vector = damped_incrementation,
+                                 .check_convergence = relative_gap};
+
+    BUILD_ARRAY(x, PB_SIZE)
+    BUILD_ARRAY(expected, PB_SIZE)
+    BUILD_ARRAY(obtained, PB_SIZE)
+    p_array built_arrays[] = {x, expected, obtained};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    set_initial_values(x);
+
+    if (solveNewton(&newton, NULL, x, expected) == EXIT_FAILURE)
+    {
+        fprintf(stderr, "The solveNewton function has failed!\n");
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+
+    // The workspace is larger than the problem and used twice
+    NewtonWorkspace_s *workspace = build_newton_workspace(2 * PB_SIZE);
+    int status = EXIT_SUCCESS;
+    for (int run = 0; run < 2 && status == EXIT_SUCCESS; ++run)
+    {
+        fill_array(obtained, 0.);
+        if (solveNewtonWithWorkspace(&newton, NULL, x, obtained, workspace) == EXIT_FAILURE)
+        {
+            fprintf(stderr, "The solveNewtonWithWorkspace function has failed (run %d)!\n", run);
+            status = EXIT_FAILURE;
+        }
+        else if (!assert_equal(obtained, expected))
+        {
+            fprintf(stderr, "The solutions obtained with and without workspace differ (run %d)!\n", run);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    delete_newton_workspace(workspace);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Test that the solver fails if the workspace is too small for the problem
+ *
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_solve_with_too_small_workspace()
+{
+    NewtonParameters_s newton = {.evaluate_the_function = cubic_function,
+                                 .compute_increment_vector = classical_incrementation,
+                                 .check_convergence = relative_gap};
+
+    BUILD_ARRAY(x, PB_SIZE)
+    BUILD_ARRAY(sol, PB_SIZE)
+    p_array built_arrays[] = {x, sol};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    set_initial_values(x);
+
+    NewtonWorkspace_s *workspace = build_newton_workspace(PB_SIZE - 1);
+    int status = EXIT_SUCCESS;
+    if (solveNewtonWithWorkspace(&newton, NULL, x, sol, workspace) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The solveNewtonWithWorkspace function should have failed "
+                        "because the workspace is too small!\n");
+        status = EXIT_FAILURE;
+    }
+
+    delete_newton_workspace(workspace);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Test that the active set mode gives the same results as the whole array mode
+ *        when the unknowns converge at different iterations
+ *
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_solve_on_active_set()
+{
+    NewtonParameters_s newton = {.evaluate_the_function = cubic_function,
+                                 .compute_increment_vector = damped_incrementation,
+                                 .check_convergence = relative_gap};
+    NewtonParameters_s active_set_newton = newton;
+    active_set_newton.evaluate_the_function_on_subset = cubic_function_on_subset;
+
+    BUILD_ARRAY(x, PB_SIZE)
+    BUILD_ARRAY(expected, PB_SIZE)
+    BUILD_ARRAY(obtained, PB_SIZE)
+    p_array built_arrays[] = {x, expected, obtained};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    set_initial_values(x);
+
+    int status = EXIT_SUCCESS;
+    if (solveNewton(&newton, NULL, x, expected) == EXIT_FAILURE ||
+        solveNewton(&active_set_newton, NULL, x, obtained) == EXIT_FAILURE)
+    {
+        fprintf(stderr, "The solveNewton function has failed!\n");
+        status = EXIT_FAILURE;
+    }
+    else if (!assert_equal(obtained, expected))
+    {
+        fprintf(stderr, "The solutions obtained with and without active set differ!\n");
+        status = EXIT_FAILURE;
+    }
+
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Check the consistency of a report of a solve of PB_SIZE unknowns
+ *
+ * @param[in] report : the report
+ * @param[in] nb_unconverged : expected number of unconverged unknowns
+ * @return true : if the report is consistent
+ * @return false : otherwise
+ */
+static bool check_report(const NewtonReport_s *report, const unsigned int nb_unconverged)
+{
+    unsigned int nb_converged = 0;
+    for (int bin = 0; bin < NEWTON_REPORT_HISTOGRAM_SIZE; ++bin)
+    {
+        nb_converged += report->iterations_histogram[bin];
+    }
+    if (report->nb_cells != PB_SIZE || report->nb_unconverged != nb_unconverged ||
+        nb_converged + nb_unconverged != PB_SIZE || report->nb_iterations <= 0)
+    {
+        fprintf(stderr, "Inconsistent report!\n");
+        print_newton_report(report);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Test that the whole array and active set modes give the same reports
+ *
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_solve_report()
+{
+    NewtonParameters_s newton = {.evaluate_the_function = cubic_function,
+                                 .compute_increment_vector = damped_incrementation,
+                                 .check_convergence = relative_gap};
+    NewtonParameters_s active_set_newton = newton;
+    active_set_newton.evaluate_the_function_on_subset = cubic_function_on_subset;
+
+    BUILD_ARRAY(x, PB_SIZE)
+    BUILD_ARRAY(sol, PB_SIZE)
+    p_array built_arrays[] = {x, sol};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    set_initial_values(x);
+
+    NewtonWorkspace_s *workspace = build_newton_workspace(PB_SIZE);
+    int status = EXIT_SUCCESS;
+    NewtonReport_s expected;
+    if (solveNewtonWithWorkspace(&newton, NULL, x, sol, workspace) == EXIT_FAILURE ||
+        !check_report(&workspace->report, 0))
+    {
+        status = EXIT_FAILURE;
+    }
+    expected = workspace->report;
+    if (solveNewtonWithWorkspace(&active_set_newton, NULL, x, sol, workspace) == EXIT_FAILURE ||
+        !check_report(&workspace->report, 0))
+    {
+        status = EXIT_FAILURE;
+    }
+    else if (expected.nb_iterations != workspace->report.nb_iterations ||
+             expected.max_residual != workspace->report.max_residual ||
+             memcmp(expected.iterations_histogram, workspace->report.iterations_histogram,
+                    sizeof(expected.iterations_histogram)) != 0)
+    {
+        fprintf(stderr, "The reports obtained with and without active set differ!\n");
+        print_newton_report(&expected);
+        print_newton_report(&workspace->report);
+        status = EXIT_FAILURE;
+    }
+
+    delete_newton_workspace(workspace);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Test the maximum number of iterations and the per cell tolerances of the controls
+ *
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_solve_with_controls()
+{
+    NewtonControls_s controls = NEWTON_DEFAULT_CONTROLS;
+    NewtonParameters_s newton = {.evaluate_the_function = cubic_function,
+                                 .compute_increment_vector = damped_incrementation,
+                                 .check_convergence = relative_gap,
+                                 .controls = &controls};
+
+    BUILD_ARRAY(x, PB_SIZE)
+    BUILD_ARRAY(sol, PB_SIZE)
+    p_array built_arrays[] = {x, sol};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    set_initial_values(x);
+
+    NewtonWorkspace_s *workspace = build_newton_workspace(PB_SIZE);
+    int status = EXIT_SUCCESS;
+
+    // Too few iterations : every unknown is reported as unconverged
+    controls.nb_iter_max = 1;
+    if (solveNewtonWithWorkspace(&newton, NULL, x, sol, workspace) == EXIT_SUCCESS ||
+        !check_report(&workspace->report, PB_SIZE) || workspace->report.nb_iterations != 2)
+    {
+        fprintf(stderr, "The solve should have failed after 2 iterations!\n");
+        status = EXIT_FAILURE;
+    }
+
+    // The second unknown has a tolerance so loose that it converges at the first iteration
+    // and the other ones have a relative tolerance tighter than the default
+    const double epsilon_per_cell[PB_SIZE] = {1.e-10, 1.e-10, 1.e-10};
+    const double precision_per_cell[PB_SIZE] = {RELATIVE_GAP_PRECISION, 1.e+30, RELATIVE_GAP_PRECISION};
+    controls.nb_iter_max = NEWTON_NB_ITER_MAX;
+    controls.tolerances.epsilon_per_cell = epsilon_per_cell;
+    controls.tolerances.precision_per_cell = precision_per_cell;
+    // Expected value of the second unknown after one damped increment
+    const double x_1 = x->data[1];
+    const double f_1 = x_1 * x_1 * x_1 - 2. * x_1 * x_1 + 1;
+    const double df_1 = 3. * x_1 * x_1 - 4. * x_1;
+    for (int active_set = 0; active_set < 2 && status == EXIT_SUCCESS; ++active_set)
+    {
+        newton.evaluate_the_function_on_subset = active_set ? cubic_function_on_subset : NULL;
+        if (solveNewtonWithWorkspace(&newton, NULL, x, sol, workspace) == EXIT_FAILURE ||
+            !check_report(&workspace->report, 0) || workspace->report.iterations_histogram[1] != 1)
+        {
+            fprintf(stderr, "The per cell tolerances have not been taken into account (active set : %d)!\n", active_set);
+            status = EXIT_FAILURE;
+        }
+        else if (!almost_equal(sol->data[1], x_1 - 0.5 * f_1 / df_1))
+        {
+            fprintf(stderr, "The second unknown should have been incremented once (active set : %d)!\n", active_set);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    delete_newton_workspace(workspace);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Test that the Halley incrementation finds the roots of the cubic function
+ *        with less iterations than the classical one
+ *
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_solve_with_halley()
+{
+    NewtonParameters_s newton = {.evaluate_the_function = cubic_function,
+                                 .compute_increment_vector = classical_incrementation,
+                                 .check_convergence = relative_gap};
+    NewtonParameters_s halley = newton;
+    halley.evaluate_the_function_and_second_derivative = cubic_function_with_second_derivative;
+    halley.compute_second_order_increment_vector = halley_incrementation;
+
+    BUILD_ARRAY(x, PB_SIZE)
+    BUILD_ARRAY(sol, PB_SIZE)
+    p_array built_arrays[] = {x, sol};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    // Initial values close enough to the roots for the classical incrementation not to jump to another one
+    x->data[0] = -1.;
+    x->data[1] = 0.75;
+    x->data[2] = 2.;
+
+    // The roots of the cubic function closest to the initial values
+    const double roots[PB_SIZE] = {0.5 * (1. - sqrt(5.)), 1., 0.5 * (1. + sqrt(5.))};
+
+    NewtonWorkspace_s *workspace = build_newton_workspace(PB_SIZE);
+    int status = EXIT_SUCCESS;
+    int nb_iterations[2] = {0, 0};
+    NewtonParameters_s *solvers[2] = {&newton, &halley};
+    for (int s = 0; s < 2 && status == EXIT_SUCCESS; ++s)
+    {
+        if (solveNewtonWithWorkspace(solvers[s], NULL, x, sol, workspace) == EXIT_FAILURE ||
+            !check_report(&workspace->report, 0))
+        {
+            fprintf(stderr, "The solve has failed (halley : %d)!\n", s);
+            status = EXIT_FAILURE;
+        }
+        for (unsigned int i = 0; i < PB_SIZE; ++i)
+        {
+            if (fabs(sol->data[i] - roots[i]) > 1.e-09)
+            {
+                print_array_index_error("sol", i, sol->data, roots[i]);
+                status = EXIT_FAILURE;
+            }
+        }
+        nb_iterations[s] = workspace->report.nb_iterations;
+    }
+    if (status == EXIT_SUCCESS && nb_iterations[1] >= nb_iterations[0])
+    {
+        fprintf(stderr, "Halley needs %d iterations, classical Newton %d!\n", nb_iterations[1], nb_iterations[0]);
+        status = EXIT_FAILURE;
+    }
+
+    // Not available in active set mode
+    halley.evaluate_the_function_on_subset = cubic_function_on_subset;
+    if (solveNewtonWithWorkspace(&halley, NULL, x, sol, workspace) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The second order mode should fail in active set mode!\n");
+        status = EXIT_FAILURE;
+    }
+
+    delete_newton_workspace(workspace);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Test that the safeguarded mode finds a root of the cubic function from initial values
+ *        where its derivative vanishes, which make the classical Newton-Raphson algorithm fail
+ *
+ * @return int EXIT_SUCCESS (0) : in case of success
+ *             EXIT_FAILURE (1) : otherwise
+ */
+int test_solve_safeguarded()
+{
+    NewtonControls_s controls = NEWTON_DEFAULT_CONTROLS;
+    NewtonParameters_s newton = {.evaluate_the_function = cubic_function,
+                                 .compute_increment_vector = classical_incrementation,
+                                 .check_convergence = relative_gap,
+                                 .controls = &controls};
+
+    BUILD_ARRAY(x, PB_SIZE)
+    BUILD_ARRAY(sol, PB_SIZE)
+    p_array built_arrays[] = {x, sol};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return EXIT_FAILURE;
+    }
+    // The derivative of the cubic function vanishes at the first two initial values
+    x->data[0] = 0.;
+    x->data[1] = 4. / 3.;
+    x->data[2] = 2.;
+
+    // The roots reached by probing against the sign of the function
+    const double roots[PB_SIZE] = {0.5 * (1. - sqrt(5.)), 0.5 * (1. + sqrt(5.)), 0.5 * (1. + sqrt(5.))};
+
+    NewtonWorkspace_s *workspace = build_newton_workspace(PB_SIZE);
+    int status = EXIT_SUCCESS;
+    if (solveNewtonWithWorkspace(&newton, NULL, x, sol, workspace) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The classical Newton-Raphson algorithm should have failed!\n");
+        status = EXIT_FAILURE;
+    }
+
+    // Even with too few iterations allowed, the bound of the safeguarded mode is used
+    controls.safeguarded = true;
+    controls.nb_iter_max = 1;
+    if (solveNewtonWithWorkspace(&newton, NULL, x, sol, workspace) == EXIT_FAILURE ||
+        !check_report(&workspace->report, 0))
+    {
+        fprintf(stderr, "The safeguarded mode has failed!\n");
+        status = EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < PB_SIZE; ++i)
+    {
+        if (fabs(sol->data[i] - roots[i]) > 1.e-09)
+        {
+            print_array_index_error("sol", i, sol->data, roots[i]);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    // Not available in active set mode
+    newton.evaluate_the_function_on_subset = cubic_function_on_subset;
+    if (solveNewtonWithWorkspace(&newton, NULL, x, sol, workspace) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The safeguarded mode should fail in active set mode!\n");
+        status = EXIT_FAILURE;
+    }
+
+    delete_newton_workspace(workspace);
+    cleanup_memory(built_arrays, nb_arrays);
+    return status;
+}
+
+/**
+ * @brief Print usage of this program
+ *
+ * @param test_collection : the collection of unit tests
+ * @param size : size of the collection
+ */
+void usage(const s_unittest * const test_collection, const unsigned int size)
+{
+    fprintf(stderr, "This program waits for the unit test to run:\n");
+    for (unsigned int i = 0; i < size; ++i)
+    {
+        fprintf(stderr, "\t[%d] %s\n", i, test_collection[i].name);
+    }
+}
+
+#define TEST_DECLARATION(name) {#name, name}
+
+/**
+ * @brief Test the Newton solver
+ *
+ * @return int EXIT_SUCCESS (0) : in case of success
+               EXIT_FAILURE (1) : otherwise
+ */
+int main(int argc, char* argv[])
+{
+    s_unittest test_collection[] = {
+        TEST_DECLARATION(test_solve_with_workspace),
+        TEST_DECLARATION(test_solve_with_too_small_workspace),
+        TEST_DECLARATION(test_solve_on_active_set),
+        TEST_DECLARATION(test_solve_report),
+        TEST_DECLARATION(test_solve_with_controls),
+        TEST_DECLARATION(test_solve_with_halley),
+        TEST_DECLARATION(test_solve_safeguarded)
+    };
+    const int test_number = sizeof(test_collection) / sizeof(s_unittest);
+
+    if (argc != 2) {
+        fprintf(stderr, "Wrong number of arguments!\n");
+        usage(test_collection, test_number);
+        return EXIT_FAILURE;
+    }
+
+    int num_test = atoi(argv[1]);
+
+    if (num_test >= test_number || num_test < 0) {
+        fprintf(stderr, "Test doesn't exist!\n");
+        usage(test_collection, test_number);
+        return EXIT_FAILURE;
+    }
+
+    printf("Executing test %s\n", test_collection[num_test].name);
+    return test_collection[num_test].fun_ptr();
+}
@@ -0,0 +1,62 @@
+#include "simd_dispatch.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const SIMD_LEVEL_NAMES[] = {"scalar", "sse2", "avx2", "avx512"};
+
+/**
+ * @brief Return the most capable SIMD level supported by the processor
+ * 
+ * @return SimdLevel_e : the SIMD level
+ */
+static SimdLevel_e detect_simd_level(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+SimdLevel_e get_simd_level(void)
+{
+    static bool detected = false;
+    static SimdLevel_e level = SIMD_SCALAR;
+
+    if (!detected)
+    {
+        level = detect_simd_level();
+        const char *requested = getenv(SIMD_LEVEL_ENV_VAR);
+        if (requested != NULL)
+        {
+            bool known = false;
+            for (int i = SIMD_SCALAR; i <= SIMD_AVX512; ++i)
+            {
+                if (strcmp(requested, SIMD_LEVEL_NAMES[i]) == 0)
+                {
+                    known = true;
+                    if ((SimdLevel_e)i < level)
+                        level = (SimdLevel_e)i;
+                }
+            }
+            if (!known)
+            {
+                fprintf(stderr, "Unknown value for %s : %s (ignored)!\n", SIMD_LEVEL_ENV_VAR, requested);
+            }
+        }
+        detected = true;
+    }
+    return level;
+}
+
+const char *get_simd_level_name(const SimdLevel_e level)
+{
+    return SIMD_LEVEL_NAMES[level];
+}
@@ -0,0 +1,50 @@
+/**
+ * @file simd_dispatch.h
+ * @author Guillaume PEILLEX (guillaume.peillex@gmail.com)
+ * @brief Detection of the SIMD instruction sets available at runtime
+ * @version 0.1
+ * @date 2020-05-04
+ * 
+ * @copyright Copyright (c) 2020 Guillaume Peillex. Subject to GNU GPL V2.
+ * 
+ */
+#ifndef SIMD_DISPATCH_H
+#define SIMD_DISPATCH_H
+
+/**
+ * @brief Name of the environment variable that may be used to cap the SIMD level
+ *        (values : scalar, sse2, avx2, avx512)
+ * 
+ */
+#define SIMD_LEVEL_ENV_VAR "NONLINEAR_SOLVER_SIMD"
+
+/**
+ * @brief The SIMD instruction sets for which kernels are available, from the least to the most capable
+ * 
+ */
+typedef enum SimdLevel
+{
+    SIMD_SCALAR,  /**< No explicit SIMD instruction */
+    SIMD_SSE2,  /**< 128 bits vectors (2 doubles) */
+    SIMD_AVX2,  /**< 256 bits vectors (4 doubles) */
+    SIMD_AVX512  /**< 512 bits vectors (8 doubles) */
+} SimdLevel_e;
+
+/**
+ * @brief Return the most capable SIMD level supported by the processor (CPUID), capped
+ *        by the value of the SIMD_LEVEL_ENV_VAR environment variable if it is set.
+ *        The detection is done once, the following calls return the same value.
+ * 
+ * @return SimdLevel_e : the SIMD level to use
+ */
+SimdLevel_e get_simd_level(void);
+
+/**
+ * @brief Return the name of the SIMD level
+ * 
+ * @param[in] level : the SIMD level
+ * @return const char* : its name
+ */
+const char *get_simd_level_name(const SimdLevel_e level);
+
+#endif
@@ -19,7 +19,9 @@
 int main()
 {
     // First parametrize the solver
-    NewtonParameters_s newton = {cubic_function, classical_incrementation, relative_gap};
+    NewtonParameters_s newton = {.evaluate_the_function = cubic_function,
+                                 .compute_increment_vector = classical_incrementation,
+                                 .check_convergence = relative_gap};
 
     // Create the arrays of initial unknown and solution
     BUILD_ARRAY(x, 3)
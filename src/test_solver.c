@@ -1,12 +1,791 @@
+#include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "array.h"
+#include "array_float.h"
+#include "array_mapped.h"
+#include "eos_params.h"
+#include "miegruneisen_float.h"
 #include "miegruneisen_params.h"
 #include "launch_vnr_resolution.h"
 #include "test_utils.h"
+#include "vnr_internalenergy_fused.h"
+
+/**
+ * @brief Check the inputs have not been modified and the outputs are the expected ones
+ * 
+ * @return true : if every array holds the expected values
+ * @return false : otherwise
+ */
+static bool check_results(p_array old_density, p_array new_density, p_array pressure, p_array internal_energy,
+                          p_array solution, p_array new_pressure, p_array new_cson)
+{
+    bool success = true;
+    if (!check_uniform_value(old_density, 8230.))
+        success = false;
+    if (!check_uniform_value(new_density, 9500.))
+        success = false;
+    if (!check_uniform_value(pressure, 10.e+09))
+        success = false;
+    if (!check_uniform_value(internal_energy, 1.325e+04))
+        success = false;
+    if (!check_uniform_value(solution, 200765.8953965593))
+        success = false;
+    if (!check_uniform_value(new_pressure, 13088079183.59054))
+        success = false;
+    if (!check_uniform_value(new_cson, 4503.84710590959))
+        success = false;
+    return success;
+}
+
+/**
+ * @brief Check that two reports are the same
+ * 
+ * @return true : if the reports are the same
+ * @return false : otherwise
+ */
+static bool same_reports(const NewtonReport_s *report, const NewtonReport_s *reference)
+{
+    bool same = report->nb_cells == reference->nb_cells && report->nb_iterations == reference->nb_iterations &&
+                report->nb_unconverged == reference->nb_unconverged && report->max_residual == reference->max_residual;
+    for (int bin = 0; bin < NEWTON_REPORT_HISTOGRAM_SIZE; ++bin)
+    {
+        same = same && report->iterations_histogram[bin] == reference->iterations_histogram[bin];
+    }
+    return same;
+}
+
+/**
+ * @brief Check that every configuration of the solver gives the same results as the first one
+ *        on a mesh where the compression varies from one cell to the other.
+ *        The configurations that iterate should also give the same report, except the mixed precision one
+ *        which starts its double precision iterations from another value.
+ * 
+ * @param[in] solver : the solver
+ * @param[in] eos_params : parameters of the equation of state
+ * @param[in] configurations : options of the solver to compare
+ * @param[in] nb_configurations : number of configurations
+ * @return true : if all the configurations agree
+ * @return false : otherwise
+ */
+static bool check_configurations_agree(VnrSolver_s *solver, MieGruneisenParams_s const *eos_params,
+                                       const VnrSolverOptions_s *configurations, const unsigned int nb_configurations)
+{
+    const size_t pb_size = 10;
+
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(new_pressure, pb_size)
+    BUILD_ARRAY(new_cson, pb_size)
+    BUILD_ARRAY(ref_solution, pb_size)
+    BUILD_ARRAY(ref_new_pressure, pb_size)
+    BUILD_ARRAY(ref_new_cson, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                              new_pressure, new_cson, ref_solution, ref_new_pressure, ref_new_cson};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return false;
+    }
+
+    fill_array(pressure, 10.e+09);
+    fill_array(internal_energy, 1.325e+04);
+    for (size_t i = 0; i < pb_size; ++i)
+    {
+        // From expansion to strong compression
+        old_specific_volume->data[i] = 1. / 8230.;
+        new_specific_volume->data[i] = 1. / (8000. + 500. * i);
+    }
+
+    bool success = true;
+    NewtonReport_s ref_report;
+    for (unsigned int i = 0; i < nb_configurations; ++i)
+    {
+        *get_vnr_solver_options(solver) = configurations[i];
+        const int status = launch_vnr_resolution_with_solver(solver, eos_params, old_specific_volume, new_specific_volume,
+                                                             pressure, internal_energy, solution, new_pressure, new_cson);
+        const NewtonReport_s *report = get_vnr_solver_report(solver);
+        if (status == EXIT_FAILURE || report->nb_cells != pb_size || report->nb_unconverged != 0)
+        {
+            fprintf(stderr, "Wrong report with the solver configuration %u!\n", i);
+            print_newton_report(report);
+            success = false;
+        }
+        if (i == 0)
+        {
+            copy_array(solution, ref_solution);
+            copy_array(new_pressure, ref_new_pressure);
+            copy_array(new_cson, ref_new_cson);
+            ref_report = *report;
+        }
+        else if (!configurations[i].use_direct_solve && configurations[i].kernel != VNR_MIXED_PRECISION_KERNEL &&
+                 !same_reports(report, &ref_report))
+        {
+            fprintf(stderr, "The report of the solver configuration %u disagrees with the one of the configuration 0!\n", i);
+            print_newton_report(report);
+            print_newton_report(&ref_report);
+            success = false;
+        }
+        if (i > 0 && (!assert_equal(solution, ref_solution) || !assert_equal(new_pressure, ref_new_pressure) ||
+                     !assert_equal(new_cson, ref_new_cson)))
+        {
+            fprintf(stderr, "The solver configuration %u disagrees with the configuration 0!\n", i);
+            success = false;
+        }
+    }
+
+    cleanup_memory(built_arrays, nb_arrays);
+    return success;
+}
+
+/**
+ * @brief Check that a solve that can not converge within the maximum number of iterations is reported
+ *        as a failure without aborting, and that the safeguarded mode ignores this too low maximum
+ * 
+ * @param[in] solver : the solver
+ * @param[in] eos_params : parameters of the equation of state
+ * @return true : if the failure is reported and the safeguarded mode succeeds
+ * @return false : otherwise
+ */
+static bool check_failure_is_reported(VnrSolver_s *solver, MieGruneisenParams_s const *eos_params)
+{
+    const size_t pb_size = 10;
+
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(new_pressure, pb_size)
+    BUILD_ARRAY(new_cson, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                              new_pressure, new_cson};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return false;
+    }
+
+    fill_array(old_specific_volume, 1. / 8230.);
+    fill_array(new_specific_volume, 1. / 9500.);
+    fill_array(pressure, 10.e+09);
+    fill_array(internal_energy, 1.325e+04);
+
+    bool success = true;
+    VnrSolverOptions_s *options = get_vnr_solver_options(solver);
+    const VnrSolverOptions_s default_options = *options;
+    options->use_direct_solve = false;
+    options->kernel = VNR_FUSED_NEWTON_KERNEL;
+    options->controls.nb_iter_max = 0;
+    options->controls.safeguarded = false;
+    if (launch_vnr_resolution_with_solver(solver, eos_params, old_specific_volume, new_specific_volume, pressure,
+                                          internal_energy, solution, new_pressure, new_cson) == EXIT_SUCCESS ||
+        get_vnr_solver_report(solver)->nb_unconverged != pb_size)
+    {
+        fprintf(stderr, "The solve should have failed on every cell!\n");
+        success = false;
+    }
+
+    options->controls.safeguarded = true;
+    if (launch_vnr_resolution_with_solver(solver, eos_params, old_specific_volume, new_specific_volume, pressure,
+                                          internal_energy, solution, new_pressure, new_cson) == EXIT_FAILURE ||
+        get_vnr_solver_report(solver)->nb_unconverged != 0 || !check_uniform_value(solution, 200765.8953965593))
+    {
+        fprintf(stderr, "The safeguarded solve should have succeeded!\n");
+        success = false;
+    }
+
+    *options = default_options;
+    cleanup_memory(built_arrays, nb_arrays);
+    return success;
+}
+
+/**
+ * @brief Check that every initial guess strategy gives the expected results and that
+ *        the exact solution given by the caller converges at the first iteration
+ * 
+ * @return true : if every strategy gives the expected results
+ * @return false : otherwise
+ */
+static bool check_initial_guesses(VnrSolver_s *solver, MieGruneisenParams_s const *eos_params, p_array old_density,
+                                  p_array new_density, p_array old_specific_volume, p_array new_specific_volume,
+                                  p_array pressure, p_array internal_energy, p_array solution, p_array new_pressure,
+                                  p_array new_cson)
+{
+    const VnrInitialGuess_e strategies[] = {VNR_CURRENT_ENERGY_GUESS, VNR_USER_GUESS, VNR_PREDICTOR_GUESS,
+                                            VNR_EXTRAPOLATED_GUESS};
+    const unsigned int nb_strategies = sizeof(strategies) / sizeof(VnrInitialGuess_e);
+    BUILD_ARRAY(exact_solution, solution->size)
+    if (exact_solution == NULL)
+        return false;
+    fill_array(exact_solution, 200765.8953965593);
+
+    bool success = true;
+    VnrSolverOptions_s *options = get_vnr_solver_options(solver);
+    const VnrSolverOptions_s default_options = *options;
+    options->use_direct_solve = false;
+    options->kernel = VNR_GENERIC_NEWTON_KERNEL;
+    options->use_active_set = false;
+    options->user_initial_guess = exact_solution->data;
+    for (unsigned int s = 0; s < nb_strategies; ++s)
+    {
+        options->initial_guess = strategies[s];
+        // The second solve of the extrapolation uses the first one
+        for (int cycle = 0; cycle < 2; ++cycle)
+        {
+            fill_array(solution, 0.);
+            if (launch_vnr_resolution_with_solver(solver, eos_params, old_specific_volume, new_specific_volume, pressure,
+                                                  internal_energy, solution, new_pressure, new_cson) == EXIT_FAILURE ||
+                !check_results(old_density, new_density, pressure, internal_energy, solution, new_pressure, new_cson))
+            {
+                fprintf(stderr, "Wrong results with the initial guess strategy %d (cycle %d)!\n", strategies[s], cycle);
+                success = false;
+            }
+        }
+        const bool exact_guess = strategies[s] == VNR_USER_GUESS || strategies[s] == VNR_EXTRAPOLATED_GUESS;
+        if (exact_guess && get_vnr_solver_report(solver)->nb_iterations != 1)
+        {
+            fprintf(stderr, "The exact initial guess of the strategy %d should converge at once!\n", strategies[s]);
+            success = false;
+        }
+    }
+    // The guess given by the caller is mandatory
+    options->user_initial_guess = NULL;
+    options->initial_guess = VNR_USER_GUESS;
+    if (launch_vnr_resolution_with_solver(solver, eos_params, old_specific_volume, new_specific_volume, pressure,
+                                          internal_energy, solution, new_pressure, new_cson) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The solve should fail without the initial guess of the caller!\n");
+        success = false;
+    }
+
+    *options = default_options;
+    DELETE_ARRAY(exact_solution)
+    return success;
+}
+
+/**
+ * @brief Check that the single precision kernel is close to the solver in double precision on a mesh where
+ *        the compression varies from one cell to the other
+ *
+ * @param[in] solver : the solver
+ * @param[in] eos_params : parameters of the equation of state
+ * @return true : if the float solution is close enough to the double precision one
+ * @return false : otherwise
+ */
+static bool check_float_kernel(VnrSolver_s *solver, MieGruneisenParams_s const *eos_params)
+{
+    const unsigned int pb_size = 10;
+    const double tolerance = 1.e-5;
+
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(new_pressure, pb_size)
+    BUILD_ARRAY(new_cson, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                              new_pressure, new_cson};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    BUILD_ARRAY_F(old_specific_volume_f, pb_size)
+    BUILD_ARRAY_F(new_specific_volume_f, pb_size)
+    BUILD_ARRAY_F(pressure_f, pb_size)
+    BUILD_ARRAY_F(internal_energy_f, pb_size)
+    BUILD_ARRAY_F(solution_f, pb_size)
+    p_array_f float_arrays[] = {old_specific_volume_f, new_specific_volume_f, pressure_f, internal_energy_f,
+                                solution_f};
+    const unsigned int nb_float_arrays = sizeof(float_arrays) / sizeof(p_array_f);
+    MieGruneisenFloatTerms_s *terms = build_miegruneisen_float_terms(pb_size);
+    VnrSolverOptions_s *options = get_vnr_solver_options(solver);
+    const VnrSolverOptions_s default_options = *options;
+
+    bool success = check_arrays_building(built_arrays, nb_arrays) == EXIT_SUCCESS && terms != NULL;
+    for (unsigned int i = 0; i < nb_float_arrays; ++i)
+        success = success && float_arrays[i] != NULL;
+    if (success)
+    {
+        fill_array(pressure, 10.e+09);
+        fill_array(internal_energy, 1.325e+04);
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            // From expansion to strong compression
+            old_specific_volume->data[i] = 1. / 8230.;
+            new_specific_volume->data[i] = 1. / (8000. + 500. * i);
+        }
+        options->use_direct_solve = true;
+        success = launch_vnr_resolution_with_solver(solver, eos_params, old_specific_volume, new_specific_volume,
+                                                    pressure, internal_energy, solution, new_pressure,
+                                                    new_cson) == EXIT_SUCCESS;
+    }
+    if (success)
+    {
+        convert_array_to_float(old_specific_volume, old_specific_volume_f);
+        convert_array_to_float(new_specific_volume, new_specific_volume_f);
+        convert_array_to_float(pressure, pressure_f);
+        convert_array_to_float(internal_energy, internal_energy_f);
+        compute_miegruneisen_float_terms(eos_params, pb_size, new_specific_volume_f->data, terms);
+        VnrParametersFloat_s parameters = {old_specific_volume_f, new_specific_volume_f, internal_energy_f, pressure_f,
+                                           terms};
+        NewtonReport_s report;
+        if (solve_internal_energy_evolution_VNR_float(&parameters, internal_energy_f, solution_f, NULL,
+                                                      &report) == EXIT_FAILURE ||
+            report.nb_cells != pb_size || report.nb_unconverged != 0)
+        {
+            fprintf(stderr, "The single precision kernel has failed!\n");
+            success = false;
+        }
+        for (unsigned int i = 0; i < pb_size; ++i)
+        {
+            if (fabs(solution_f->data[i] - solution->data[i]) > tolerance * fabs(solution->data[i]))
+            {
+                fprintf(stderr, "Float solution[%u] = %.9g instead of %.9g!\n", i, solution_f->data[i],
+                        solution->data[i]);
+                success = false;
+            }
+        }
+    }
+
+    *options = default_options;
+    delete_miegruneisen_float_terms(terms);
+    for (unsigned int i = 0; i < nb_float_arrays; ++i)
+    {
+        DELETE_ARRAY_F(float_arrays[i])
+    }
+    cleanup_memory(built_arrays, nb_arrays);
+    return success;
+}
+
+/**
+ * @brief Check that the solve with the tabulated eos is close to the analytic one on a mesh where
+ *        the compression varies from one cell to the other, and that a table built with other parameters
+ *        is rejected
+ * 
+ * @param[in] solver : the solver
+ * @param[in] eos_params : parameters of the equation of state
+ * @return true : if the tabulated solve is close enough to the analytic one
+ * @return false : otherwise
+ */
+static bool check_eos_table(VnrSolver_s *solver, MieGruneisenParams_s const *eos_params)
+{
+    const size_t pb_size = 10;
+    const double tolerance = 1.e-6;
+
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(new_pressure, pb_size)
+    BUILD_ARRAY(new_cson, pb_size)
+    BUILD_ARRAY(ref_solution, pb_size)
+    BUILD_ARRAY(ref_new_pressure, pb_size)
+    BUILD_ARRAY(ref_new_cson, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                              new_pressure, new_cson, ref_solution, ref_new_pressure, ref_new_cson};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    const MieGruneisenTableSettings_s settings = {.v_min = 1. / 13000., .v_max = 1. / 7000., .nb_points = 17,
+                                                  .tolerance = tolerance, .nb_points_max = 1 << 16};
+    MieGruneisenTable_s *table = build_miegruneisen_table(eos_params, &settings);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE || table == NULL)
+    {
+        delete_miegruneisen_table(table);
+        cleanup_memory(built_arrays, nb_arrays);
+        return false;
+    }
+
+    fill_array(pressure, 10.e+09);
+    fill_array(internal_energy, 1.325e+04);
+    for (size_t i = 0; i < pb_size; ++i)
+    {
+        // From expansion to strong compression
+        old_specific_volume->data[i] = 1. / 8230.;
+        new_specific_volume->data[i] = 1. / (8000. + 500. * i);
+    }
+
+    bool success = true;
+    VnrSolverOptions_s *options = get_vnr_solver_options(solver);
+    const VnrSolverOptions_s default_options = *options;
+    if (launch_vnr_resolution_with_solver(solver, eos_params, old_specific_volume, new_specific_volume, pressure,
+                                          internal_energy, ref_solution, ref_new_pressure, ref_new_cson) == EXIT_FAILURE)
+        success = false;
+    options->eos_table = table;
+    if (launch_vnr_resolution_with_solver(solver, eos_params, old_specific_volume, new_specific_volume, pressure,
+                                          internal_energy, solution, new_pressure, new_cson) == EXIT_FAILURE)
+        success = false;
+    for (size_t i = 0; i < pb_size; ++i)
+    {
+        // The interpolation error of each term is relative to its largest value over the table
+        if (fabs(solution->data[i] - ref_solution->data[i]) > 10. * tolerance * fabs(ref_solution->data[i]) ||
+            fabs(new_pressure->data[i] - ref_new_pressure->data[i]) > 10. * tolerance * fabs(pressure->data[i]) ||
+            fabs(new_cson->data[i] - ref_new_cson->data[i]) > 10. * tolerance * fabs(ref_new_cson->data[i]))
+        {
+            fprintf(stderr, "The tabulated solve of the cell %zu is too far from the analytic one!\n", i);
+            success = false;
+        }
+    }
+
+    // The table should have been built with the parameters of the eos solved
+    MieGruneisenParams_s other_params = *eos_params;
+    other_params.rho_zero *= 1.01;
+    if (launch_vnr_resolution_with_solver(solver, &other_params, old_specific_volume, new_specific_volume, pressure,
+                                          internal_energy, solution, new_pressure, new_cson) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The table built with other parameters should have been rejected!\n");
+        success = false;
+    }
+
+    *options = default_options;
+    delete_miegruneisen_table(table);
+    cleanup_memory(built_arrays, nb_arrays);
+    return success;
+}
+
+/**
+ * @brief Check that a mesh of several materials, each of them with its own eos, is solved as if each
+ *        material was solved alone, whether its cells are interleaved or grouped by material
+ * 
+ * @param[in] solver : the solver
+ * @param[in] copper_params : parameters of the MieGruneisen eos of the copper
+ * @return true : if every cell is solved as the cells of its material alone
+ * @return false : otherwise
+ */
+static bool check_multimaterial(VnrSolver_s *solver, MieGruneisenParams_s const *copper_params)
+{
+    const size_t pb_size = 10;
+    const unsigned int nb_materials = 3;
+    const EosParams_s materials[3] = {{.type = MIEGRUNEISEN_EOS, .miegruneisen = *copper_params},
+                                      {.type = IDEAL_GAS_EOS, .gas = {1.4, 0.}},
+                                      {.type = STIFFENED_GAS_EOS, .gas = {4.4, 6.e+08}}};
+    // Initial state and compression of each material
+    const double densities[3] = {8230., 1.2, 1000.};
+    const double pressures[3] = {10.e+09, 1.e+05, 1.e+05};
+    const double energies[3] = {1.325e+04, 1.e+05 / (0.4 * 1.2), (1.e+05 + 4.4 * 6.e+08) / (3.4 * 1000.)};
+    const double compressions[3] = {9500. / 8230., 1.1, 1.01};
+
+    BUILD_ARRAY(old_specific_volume, pb_size)
+    BUILD_ARRAY(new_specific_volume, pb_size)
+    BUILD_ARRAY(pressure, pb_size)
+    BUILD_ARRAY(internal_energy, pb_size)
+    BUILD_ARRAY(solution, pb_size)
+    BUILD_ARRAY(new_pressure, pb_size)
+    BUILD_ARRAY(new_cson, pb_size)
+    BUILD_ARRAY(ref_solution, pb_size)
+    BUILD_ARRAY(ref_new_pressure, pb_size)
+    BUILD_ARRAY(ref_new_cson, pb_size)
+    p_array built_arrays[] = {old_specific_volume, new_specific_volume, pressure, internal_energy, solution,
+                              new_pressure, new_cson, ref_solution, ref_new_pressure, ref_new_cson};
+    const unsigned int nb_arrays = sizeof(built_arrays) / sizeof(p_array);
+    if (check_arrays_building(built_arrays, nb_arrays) == EXIT_FAILURE)
+    {
+        cleanup_memory(built_arrays, nb_arrays);
+        return false;
+    }
+
+    bool success = true;
+    VnrSolverOptions_s *options = get_vnr_solver_options(solver);
+    const VnrSolverOptions_s default_options = *options;
+    unsigned int material_ids[10];
+    const unsigned int single_material_ids[10] = {0};
+    // Interleaved then grouped materials, solved directly then with the Newton kernels, then in blocks of 2 cells
+    for (int configuration = 0; configuration < 6; ++configuration)
+    {
+        const bool grouped = configuration % 2 == 1;
+        options->use_direct_solve = configuration < 2;
+        options->schedule = configuration < 4 ? VNR_STATIC_SCHEDULE : VNR_DYNAMIC_SCHEDULE;
+        options->schedule_block_size = 2;
+        for (size_t i = 0; i < pb_size; ++i)
+        {
+            const unsigned int m = grouped ? i * nb_materials / pb_size : i % nb_materials;
+            material_ids[i] = m;
+            // The compression varies from one cell to the other
+            const double density = densities[m] * (1. + 0.01 * i);
+            old_specific_volume->data[i] = 1. / density;
+            new_specific_volume->data[i] = 1. / (density * compressions[m]);
+            pressure->data[i] = pressures[m];
+            internal_energy->data[i] = energies[m];
+        }
+        // Reference : the cells of each material solved alone, one at a time
+        for (size_t i = 0; i < pb_size && success; ++i)
+        {
+            // Arrays of the cell alone, sharing the values of the mesh
+            s_array cell_arrays[7] = {get_sub_array(old_specific_volume, i, 1),
+                                      get_sub_array(new_specific_volume, i, 1),
+                                      get_sub_array(pressure, i, 1),
+                                      get_sub_array(internal_energy, i, 1),
+                                      get_sub_array(ref_solution, i, 1),
+                                      get_sub_array(ref_new_pressure, i, 1),
+                                      get_sub_array(ref_new_cson, i, 1)};
+            if (launch_multimaterial_vnr_resolution_with_solver(solver, &materials[material_ids[i]], 1,
+                                                                single_material_ids, &cell_arrays[0], &cell_arrays[1],
+                                                                &cell_arrays[2], &cell_arrays[3], &cell_arrays[4],
+                                                                &cell_arrays[5], &cell_arrays[6]) == EXIT_FAILURE)
+            {
+                fprintf(stderr, "Unable to solve the cell %zu alone!\n", i);
+                success = false;
+            }
+        }
+        if (launch_multimaterial_vnr_resolution_with_solver(solver, materials, nb_materials, material_ids,
+                                                            old_specific_volume, new_specific_volume, pressure,
+                                                            internal_energy, solution, new_pressure,
+                                                            new_cson) == EXIT_FAILURE ||
+            get_vnr_solver_report(solver)->nb_cells != pb_size || !assert_equal(solution, ref_solution) ||
+            !assert_equal(new_pressure, ref_new_pressure) || !assert_equal(new_cson, ref_new_cson))
+        {
+            fprintf(stderr, "Wrong multi-material results with the configuration %d!\n", configuration);
+            success = false;
+        }
+    }
+    // The copper cells of the single material test
+    fill_array(old_specific_volume, 1. / 8230.);
+    fill_array(new_specific_volume, 1. / 9500.);
+    fill_array(pressure, 10.e+09);
+    fill_array(internal_energy, 1.325e+04);
+    if (launch_multimaterial_vnr_resolution(materials, 1, single_material_ids, old_specific_volume, new_specific_volume,
+                                            pressure, internal_energy, solution, new_pressure, new_cson) == EXIT_FAILURE ||
+        !check_uniform_value(solution, 200765.8953965593) || !check_uniform_value(new_cson, 4503.84710590959))
+    {
+        fprintf(stderr, "Wrong results of the single material resolution!\n");
+        success = false;
+    }
+
+    // Water without internal energy is below its stiffening pressure : its sound speed is reported as invalid,
+    // the cells being listed in the order of the mesh whatever the schedule
+    options->schedule = VNR_DYNAMIC_SCHEDULE;
+    const unsigned int expected_invalid_cells[3] = {2, 5, 8};
+    for (size_t i = 0; i < pb_size; ++i)
+    {
+        const unsigned int m = i % nb_materials;
+        material_ids[i] = m;
+        old_specific_volume->data[i] = 1. / densities[m];
+        new_specific_volume->data[i] = 1. / (densities[m] * compressions[m]);
+        pressure->data[i] = pressures[m];
+        internal_energy->data[i] = m == 2 ? 0. : energies[m];
+    }
+    unsigned int nb_invalid_cells = 0;
+    const int status = launch_multimaterial_vnr_resolution_with_solver(
+        solver, materials, nb_materials, material_ids, old_specific_volume, new_specific_volume, pressure,
+        internal_energy, solution, new_pressure, new_cson);
+    const unsigned int *invalid_cells = get_vnr_solver_invalid_cells(solver, &nb_invalid_cells);
+    bool right_invalid_cells = status == EXIT_FAILURE && nb_invalid_cells == 3;
+    for (unsigned int k = 0; k < 3 && right_invalid_cells; ++k)
+        right_invalid_cells = invalid_cells[k] == expected_invalid_cells[k];
+    for (size_t i = 0; i < pb_size && right_invalid_cells; ++i)
+        right_invalid_cells = isnan(new_cson->data[i]) == (material_ids[i] == 2);
+    if (!right_invalid_cells)
+    {
+        fprintf(stderr, "The water cells should have been reported as invalid!\n");
+        success = false;
+    }
+
+    // Unknown material
+    material_ids[pb_size - 1] = nb_materials;
+    if (launch_multimaterial_vnr_resolution_with_solver(solver, materials, nb_materials, material_ids,
+                                                        old_specific_volume, new_specific_volume, pressure,
+                                                        internal_energy, solution, new_pressure,
+                                                        new_cson) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The unknown material should have been rejected!\n");
+        success = false;
+    }
+    // No material given for the cells
+    if (launch_multimaterial_vnr_resolution_with_solver(solver, materials, nb_materials, NULL, old_specific_volume,
+                                                        new_specific_volume, pressure, internal_energy, solution,
+                                                        new_pressure, new_cson) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "The missing materials of the cells should have been rejected!\n");
+        success = false;
+    }
+
+    *options = default_options;
+    cleanup_memory(built_arrays, nb_arrays);
+    return success;
+}
+
+/**
+ * @brief Check that the arrays built by the threads of a pinned solver are zeroed and give the expected results
+ *        of the single material test, and that an invalid processor is rejected
+ * 
+ * @param[in] eos_params : parameters of the equation of state
+ * @return true : if the arrays and the pinning behave as expected
+ * @return false : otherwise
+ */
+static bool check_first_touch_and_pinning(MieGruneisenParams_s const *eos_params)
+{
+    const unsigned int pb_size = 10;
+    VnrSolver_s *solver = build_vnr_solver(pb_size);
+    if (solver == NULL)
+        return false;
+    bool success = pin_vnr_solver_threads(solver, NULL) == EXIT_SUCCESS;
+    if (!success)
+        fprintf(stderr, "Unable to pin the threads of the solver!\n");
+
+    const char *labels[9] = {"old_density", "new_density", "old_specific_volume", "new_specific_volume", "pressure",
+                             "internal_energy", "solution", "new_pressure", "new_cson"};
+    p_array arrays[9];
+    for (unsigned int a = 0; a < 9; ++a)
+    {
+        arrays[a] = build_vnr_solver_array(solver, pb_size, labels[a]);
+    }
+    if (check_arrays_building(arrays, 9) == EXIT_FAILURE)
+    {
+        cleanup_memory(arrays, 9);
+        delete_vnr_solver(solver);
+        return false;
+    }
+    bool zeroed = true;
+    for (unsigned int i = 0; i < pb_size; ++i)
+        zeroed = zeroed && arrays[6]->data[i] == 0.;
+    if (!zeroed)
+    {
+        fprintf(stderr, "The arrays built by the threads of the solver should be zeroed!\n");
+        success = false;
+    }
+    fill_array(arrays[0], 8230.);
+    fill_array(arrays[1], 9500.);
+    fill_array(arrays[4], 10.e+09);
+    fill_array(arrays[5], 1.325e+04);
+    for (unsigned int i = 0; i < pb_size; ++i)
+    {
+        arrays[2]->data[i] = 1. / arrays[0]->data[i];
+        arrays[3]->data[i] = 1. / arrays[1]->data[i];
+    }
+    if (launch_vnr_resolution_with_solver(solver, eos_params, arrays[2], arrays[3], arrays[4], arrays[5], arrays[6],
+                                          arrays[7], arrays[8]) == EXIT_FAILURE ||
+        !check_results(arrays[0], arrays[1], arrays[4], arrays[5], arrays[6], arrays[7], arrays[8]))
+    {
+        fprintf(stderr, "Wrong results with the arrays built by the threads of the solver!\n");
+        success = false;
+    }
+
+    const int nb_threads = get_vnr_solver_nb_threads(solver);
+    int *invalid_cpus = (int *)malloc(nb_threads * sizeof(int));
+    for (int tid = 0; invalid_cpus && tid < nb_threads; ++tid)
+        invalid_cpus[tid] = tid == nb_threads - 1 ? -1 : 0;
+    if (invalid_cpus == NULL || pin_vnr_solver_threads(solver, invalid_cpus) == EXIT_SUCCESS)
+    {
+        fprintf(stderr, "Pinning a thread to an invalid processor should have failed!\n");
+        success = false;
+    }
+    free(invalid_cpus);
+
+    cleanup_memory(arrays, 9);
+    delete_vnr_solver(solver);
+    return success;
+}
+
+/**
+ * @brief Check that a mesh larger than the capacity of a solver, mapped on files, is streamed through it
+ *        by blocks and gives the same results as the resolution of the whole mesh in memory
+ * 
+ * @param[in] eos_params : parameters of the equation of state
+ * @return true : if the streamed resolution agrees with the one in memory
+ * @return false : otherwise
+ */
+static bool check_streamed_resolution(MieGruneisenParams_s const *eos_params)
+{
+    // Several blocks of a page of values (or more), the last one being partial
+    const size_t pb_size = 5000;
+    const unsigned int nb_arrays = 7;
+    const char *labels[7] = {"old_specific_volume", "new_specific_volume", "pressure", "internal_energy", "solution",
+                             "new_pressure", "new_cson"};
+    // The tests may run at the same time : the files are named after the process
+    char paths[7][64];
+    p_array mapped[7];
+    p_array in_memory[7];
+    for (unsigned int a = 0; a < nb_arrays; ++a)
+    {
+        snprintf(paths[a], sizeof(paths[a]), "test_solver_%d_%s.bin", (int)getpid(), labels[a]);
+        mapped[a] = build_array_in_file(paths[a], pb_size, labels[a]);
+        in_memory[a] = build_array(pb_size, labels[a]);
+    }
+    VnrSolver_s *solver = build_vnr_solver(pb_size / 3);
+    bool success = solver != NULL && check_arrays_building(in_memory, nb_arrays) == EXIT_SUCCESS;
+    for (unsigned int a = 0; a < nb_arrays; ++a)
+        success = success && mapped[a] != NULL;
+
+    if (success)
+    {
+        fill_array(in_memory[2], 10.e+09);
+        fill_array(in_memory[3], 1.325e+04);
+        for (size_t i = 0; i < pb_size; ++i)
+        {
+            in_memory[0]->data[i] = 1. / 8230.;
+            in_memory[1]->data[i] = 1. / (8000. + 0.3 * i);
+        }
+        // The inputs are written in their files then mapped read only
+        for (unsigned int a = 0; a < 4; ++a)
+        {
+            copy_array(in_memory[a], mapped[a]);
+            delete_mapped_array(mapped[a]);
+            mapped[a] = build_array_from_file(paths[a], labels[a]);
+            success = success && mapped[a] != NULL;
+        }
+    }
+    if (success)
+    {
+        get_vnr_solver_options(solver)->use_direct_solve = false;
+        if (launch_vnr_resolution_with_solver(solver, eos_params, mapped[0], mapped[1], mapped[2], mapped[3],
+                                              mapped[4], mapped[5], mapped[6]) == EXIT_SUCCESS)
+        {
+            fprintf(stderr, "A mesh larger than the capacity of the solver should have been rejected!\n");
+            success = false;
+        }
+        if (launch_vnr_resolution_streamed(NULL, eos_params, mapped[0], mapped[1], mapped[2], mapped[3],
+                                           mapped[4], mapped[5], mapped[6]) == EXIT_SUCCESS ||
+            launch_vnr_resolution_streamed(solver, eos_params, NULL, mapped[1], mapped[2], mapped[3],
+                                           mapped[4], mapped[5], mapped[6]) == EXIT_SUCCESS)
+        {
+            fprintf(stderr, "A missing solver or array should have been rejected!\n");
+            success = false;
+        }
+        if (launch_vnr_resolution(eos_params, NULL, mapped[1], mapped[2], mapped[3], mapped[4], mapped[5],
+                                  mapped[6]) == EXIT_SUCCESS)
+        {
+            fprintf(stderr, "A missing array should have been rejected by the one-shot resolution!\n");
+            success = false;
+        }
+        if (launch_vnr_resolution_streamed(solver, eos_params, mapped[0], mapped[1], mapped[2], mapped[3],
+                                           mapped[4], mapped[5], mapped[6]) == EXIT_FAILURE ||
+            get_vnr_solver_report(solver)->nb_cells != pb_size)
+        {
+            fprintf(stderr, "Unable to stream the mesh through the solver!\n");
+            success = false;
+        }
+        // Same options for the whole mesh in memory
+        VnrSolver_s *whole_solver = build_vnr_solver(pb_size);
+        if (whole_solver)
+            *get_vnr_solver_options(whole_solver) = *get_vnr_solver_options(solver);
+        if (whole_solver == NULL ||
+            launch_vnr_resolution_with_solver(whole_solver, eos_params, in_memory[0], in_memory[1], in_memory[2],
+                                              in_memory[3], in_memory[4], in_memory[5], in_memory[6]) == EXIT_FAILURE ||
+            !assert_equal(mapped[4], in_memory[4]) || !assert_equal(mapped[5], in_memory[5]) ||
+            !assert_equal(mapped[6], in_memory[6]))
+        {
+            fprintf(stderr, "The streamed resolution disagrees with the resolution in memory!\n");
+            success = false;
+        }
+        delete_vnr_solver(whole_solver);
+    }
+
+    for (unsigned int a = 0; a < nb_arrays; ++a)
+    {
+        delete_mapped_array(mapped[a]);
+        remove(paths[a]);
+    }
+    cleanup_memory(in_memory, nb_arrays);
+    delete_vnr_solver(solver);
+    return success;
+}
 
 /**
  * @brief Launch the test of the nonlinear solver
@@ -40,24 +819,75 @@ int main()
     }
 
     MieGruneisenParams_s const copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
-    launch_vnr_resolution(&copper_mat, old_specific_volume, new_specific_volume, pressure, internal_energy,
-                          solution, new_pressure, new_cson);
-
-    bool success = true;
-    if (!check_uniform_value(old_density, 8230.))
-        success = false;
-    if (!check_uniform_value(new_density, 9500.))
-        success = false;
-    if (!check_uniform_value(pressure, 10.e+09))
-        success = false;
-    if (!check_uniform_value(internal_energy, 1.325e+04))
-        success = false;
-    if (!check_uniform_value(solution, 200765.8953965593))
-        success = false;
-    if (!check_uniform_value(new_pressure, 13088079183.59054))
+    bool success = launch_vnr_resolution(&copper_mat, old_specific_volume, new_specific_volume, pressure, internal_energy,
+                                         solution, new_pressure, new_cson) == EXIT_SUCCESS;
+    if (!check_results(old_density, new_density, pressure, internal_energy, solution, new_pressure, new_cson))
         success = false;
-    if (!check_uniform_value(new_cson, 4503.84710590959))
+
+    // Same resolution through a solver context, for different options
+    VnrSolver_s *solver = build_vnr_solver(pb_size);
+    if (solver == NULL)
+    {
+        fprintf(stderr, "Unable to build the solver!\n");
         success = false;
+    }
+    else
+    {
+        VnrSolverOptions_s configurations[11];
+        const unsigned int nb_configurations = sizeof(configurations) / sizeof(VnrSolverOptions_s);
+        for (unsigned int i = 0; i < nb_configurations; ++i)
+        {
+            configurations[i] = *get_vnr_solver_options(solver);
+            configurations[i].use_direct_solve = false;
+        }
+        configurations[0].kernel = VNR_GENERIC_NEWTON_KERNEL;
+        configurations[0].use_active_set = true;
+        configurations[1].kernel = VNR_GENERIC_NEWTON_KERNEL;
+        configurations[1].use_active_set = false;
+        configurations[2].kernel = VNR_FUSED_NEWTON_KERNEL;
+        configurations[3].kernel = VNR_CELL_MAJOR_NEWTON_KERNEL;
+        configurations[4].use_direct_solve = true;
+        configurations[5].kernel = VNR_HALLEY_KERNEL;
+        configurations[6].controls.safeguarded = true;
+        configurations[7].use_eos_cache = false;
+        configurations[8].kernel = VNR_MIXED_PRECISION_KERNEL;
+        configurations[9].use_thread_team = false;
+        configurations[10].schedule = VNR_DYNAMIC_SCHEDULE;
+        configurations[10].schedule_block_size = 3;
+
+        for (unsigned int i = 0; i < nb_configurations; ++i)
+        {
+            *get_vnr_solver_options(solver) = configurations[i];
+            fill_array(solution, 0.);
+            fill_array(new_pressure, 0.);
+            fill_array(new_cson, 0.);
+            if (launch_vnr_resolution_with_solver(solver, &copper_mat, old_specific_volume, new_specific_volume, pressure,
+                                                  internal_energy, solution, new_pressure, new_cson) == EXIT_FAILURE ||
+                !check_results(old_density, new_density, pressure, internal_energy, solution, new_pressure, new_cson))
+            {
+                fprintf(stderr, "Wrong results with the solver configuration %u!\n", i);
+                success = false;
+            }
+        }
+        if (!check_configurations_agree(solver, &copper_mat, configurations, nb_configurations))
+            success = false;
+        if (!check_failure_is_reported(solver, &copper_mat))
+            success = false;
+        if (!check_initial_guesses(solver, &copper_mat, old_density, new_density, old_specific_volume, new_specific_volume,
+                                   pressure, internal_energy, solution, new_pressure, new_cson))
+            success = false;
+        if (!check_eos_table(solver, &copper_mat))
+            success = false;
+        if (!check_float_kernel(solver, &copper_mat))
+            success = false;
+        if (!check_multimaterial(solver, &copper_mat))
+            success = false;
+        if (!check_first_touch_and_pinning(&copper_mat))
+            success = false;
+        if (!check_streamed_resolution(&copper_mat))
+            success = false;
+        delete_vnr_solver(solver);
+    }
 
     DELETE_ARRAY(old_density)
     DELETE_ARRAY(old_specific_volume);
@@ -42,13 +42,22 @@ int main()
         old_specific_volume->data[i] = 1. / old_density->data[i];
         new_specific_volume->data[i] = 1. / new_density->data[i];
     }
+    // The solver context is built once and reused at each cycle
+    VnrSolver_s *solver = build_vnr_solver(pb_size);
+    if (solver == NULL)
+    {
+        fprintf(stderr, "Unable to build the solver!\n");
+        return EXIT_FAILURE;
+    }
     //
     start = clock();
     MieGruneisenParams_s const copper_mat = {3940., 1.489, 0., 0., 8930., 2.02, 0.47, 0.};
+    bool all_solved = true;
     for (int cycle = 0; cycle < nbr_of_cycles; ++cycle)
     {
-        launch_vnr_resolution(&copper_mat, old_specific_volume, new_specific_volume, pressure, internal_energy,
-                              solution, new_pressure, new_cson);
+        if (launch_vnr_resolution_with_solver(solver, &copper_mat, old_specific_volume, new_specific_volume, pressure, internal_energy,
+                                              solution, new_pressure, new_cson) == EXIT_FAILURE)
+            all_solved = false;
         if (cycle % 1000 == 0)
         {
             srand48(time(NULL));
@@ -58,9 +67,12 @@ int main()
         };
     }
     end = clock();
+    delete_vnr_solver(solver);
     double cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
 
-    bool success = true;
+    bool success = all_solved;
+    if (!all_solved)
+        fprintf(stderr, "The resolution has failed during at least one cycle!\n");
     if (!check_uniform_value(old_density, 8230.))
         success = false;
     if (!check_uniform_value(new_density, 9500.))